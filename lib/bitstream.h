@@ -146,6 +146,10 @@ MEM_STATIC void BIT_flushBitsFast(BIT_CStream_t* bitC);
 MEM_STATIC size_t BIT_readBitsFast(BIT_DStream_t* bitD, unsigned nbBits);
 /* faster, but works only if nbBits >= 1 */
 
+MEM_STATIC size_t BIT_nbFastReloads(const BIT_DStream_t* bitD, unsigned maxBitsPerReload);
+MEM_STATIC void   BIT_reloadDStreamFast(BIT_DStream_t* bitD);
+/* unchecked refill; only valid for the nb of reloads given by BIT_nbFastReloads() */
+
 
 
 /*-**************************************************************
@@ -399,6 +403,30 @@ MEM_STATIC BIT_DStream_status BIT_reloadDStream(BIT_DStream_t* bitD)
     }
 }
 
+/*! BIT_nbFastReloads() :
+*   @return : nb of successive BIT_reloadDStreamFast() which are guaranteed to stay within src buffer,
+*             provided that at most `maxBitsPerReload` bits are consumed before each one.
+*   Reloads are exact, so `ptr` can move back down to `start`, leaving 7 bits unconsumed at most.
+*   note : `maxBitsPerReload` must be >= 1, and <= sizeof(bitD->bitContainer)*8 - 7 */
+MEM_STATIC size_t BIT_nbFastReloads(const BIT_DStream_t* bitD, unsigned maxBitsPerReload)
+{
+    size_t const nbBitsAvailable = (size_t)(bitD->ptr - bitD->start) * 8 + 7;
+    if (bitD->bitsConsumed > nbBitsAvailable) return 0;
+    return (nbBitsAvailable - bitD->bitsConsumed) / maxBitsPerReload;
+}
+
+/*! BIT_reloadDStreamFast() :
+*   Same as BIT_reloadDStream() far from the beginning of src buffer, but without any check nor status :
+*   a single unaligned load, whatever the nb of consumed bits.
+*   Only valid for as many reloads as BIT_nbFastReloads() allows;
+*   BIT_reloadDStream() must handle the remaining ones. */
+MEM_STATIC void BIT_reloadDStreamFast(BIT_DStream_t* bitD)
+{
+    bitD->ptr -= bitD->bitsConsumed >> 3;
+    bitD->bitsConsumed &= 7;
+    bitD->bitContainer = MEM_readLEST(bitD->ptr);
+}
+
 /*! BIT_endOfDStream() :
 *   @return Tells if DStream has exactly reached its end (all bits consumed).
 */
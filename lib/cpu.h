@@ -0,0 +1,117 @@
+/* ******************************************************************
+   cpu.h
+   runtime detection of x86 instruction set extensions
+   Copyright (C) 2013-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    You can contact the author at :
+    - FSE source repository : https://github.com/Cyan4973/FiniteStateEntropy
+****************************************************************** */
+#ifndef CPU_H_MODULE_FSE
+#define CPU_H_MODULE_FSE
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/*-****************************************
+*  Dependencies
+******************************************/
+#include <string.h>  /* memset */
+#include "mem.h"     /* MEM_STATIC, U32 */
+
+
+/*-****************************************
+*  Compiler specifics
+******************************************/
+/* CPU_TARGET_ATTRIBUTE() :
+ * allows a single function to use instructions beyond the compilation target.
+ * Such function must only be invoked after checking cpu support at runtime.
+ * CPU_TARGET_SUPPORT tells if this capability is available (requires gcc >= 4.9 or clang).
+ * Visual has no equivalent attribute : it only uses generic code */
+#if defined(CPU_DISABLE_DISPATCH)   /* can be defined externally, to only use generic code */
+#  define CPU_TARGET_SUPPORT 0
+#elif (defined(__x86_64__) || defined(__i386__)) && \
+      (defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+#  define CPU_TARGET_SUPPORT 1
+#  define CPU_TARGET_ATTRIBUTE(isa) __attribute__((target(isa)))
+#else
+#  define CPU_TARGET_SUPPORT 0
+#endif
+
+#if CPU_TARGET_SUPPORT
+#  include <cpuid.h>   /* __get_cpuid, __cpuid_count */
+#endif
+
+
+/*-****************************************
+*  Feature detection
+******************************************/
+typedef struct {
+    U32 f7b;     /* cpuid leaf 7, register ebx */
+} CPU_features_t;
+
+MEM_STATIC CPU_features_t CPU_getFeatures(void)
+{
+    CPU_features_t f;
+    memset(&f, 0, sizeof(f));
+#if CPU_TARGET_SUPPORT
+    if (__get_cpuid_max(0, NULL) >= 7) {
+        unsigned a, b, c, d;
+        __cpuid_count(7, 0, a, b, c, d);
+        f.f7b = b;
+    }
+#endif
+    return f;
+}
+
+MEM_STATIC unsigned CPU_hasBMI2(CPU_features_t f) { return (f.f7b >> 8) & 1; }
+
+/* CPU_bmi2() :
+ * BMI2 support, detected once per translation unit, for dispatching hot loops.
+ * Concurrent first calls all store the same value; accesses are atomic, so they do not race. */
+MEM_STATIC unsigned CPU_bmi2(void)
+{
+#if CPU_TARGET_SUPPORT
+    static int bmi2 = -1;
+    int detected = __atomic_load_n(&bmi2, __ATOMIC_RELAXED);
+    if (detected < 0) {
+        detected = (int)CPU_hasBMI2(CPU_getFeatures());
+        __atomic_store_n(&bmi2, detected, __ATOMIC_RELAXED);
+    }
+    return (unsigned)detected;
+#else
+    return 0;
+#endif
+}
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* CPU_H_MODULE_FSE */
@@ -98,6 +98,7 @@ ERR_STATIC const char* ERR_getErrorString(ERR_enum code)
     case PREFIX(tableLog_tooLarge): return "tableLog requires too much memory : unsupported";
     case PREFIX(maxSymbolValue_tooLarge): return "Unsupported max Symbol Value : too large";
     case PREFIX(maxSymbolValue_tooSmall): return "Specified maxSymbolValue is too small";
+    case PREFIX(workSpace_tooSmall): return "Provided workSpace is too small";
     case PREFIX(maxCode):
     default: return notErrorCode;
     }
@@ -51,6 +51,7 @@ typedef enum {
   FSE_original_error_tableLog_tooLarge,
   FSE_original_error_maxSymbolValue_tooLarge,
   FSE_original_error_maxSymbolValue_tooSmall,
+  FSE_original_error_workSpace_tooSmall,
   FSE_original_error_maxCode
 } FSE_original_ErrorCode;
 
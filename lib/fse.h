@@ -290,6 +290,14 @@ If there is an error, the function will return an error code, which can be teste
 #define FSE_original_CTABLE_SIZE_U32(maxTableLog, maxSymbolValue)   (1 + (1<<(maxTableLog-1)) + ((maxSymbolValue+1)*2))
 #define FSE_original_DTABLE_SIZE_U32(maxTableLog)                   (1 + (1<<maxTableLog))
 
+/* Scratch memory, as a table of unsigned, for the *_wksp() functions */
+#define FSE_original_COUNT_WKSP_SIZE_U32  (8 * (256+16))   /* histogram tables of FSE_original_count_wksp() */
+#define FSE_original_BUILD_CTABLE_WKSP_SIZE_U32(maxTableLog, maxSymbolValue) \
+        (FSE_original_CTABLE_SIZE_U32(maxTableLog, maxSymbolValue) + (1<<((maxTableLog)-2)))   /* CTable + symbol spreading */
+#define FSE_original_WKSP_SIZE_U32(maxTableLog, maxSymbolValue)   ( ((FSE_original_MAX_SYMBOL_VALUE+1)*3/2) /* count + norm */ + \
+        ( FSE_original_BUILD_CTABLE_WKSP_SIZE_U32(maxTableLog, maxSymbolValue) > FSE_original_COUNT_WKSP_SIZE_U32 ? \
+          FSE_original_BUILD_CTABLE_WKSP_SIZE_U32(maxTableLog, maxSymbolValue) : FSE_original_COUNT_WKSP_SIZE_U32 ) )
+
 
 /* *****************************************
 *  FSE advanced API
@@ -297,9 +305,42 @@ If there is an error, the function will return an error code, which can be teste
 size_t FSE_original_countFast(unsigned* count, unsigned* maxSymbolValuePtr, const void* src, size_t srcSize);
 /**< same as FSE_original_count(), but blindly trusts that all byte values within src are <= *maxSymbolValuePtr  */
 
+size_t FSE_original_count_wksp(unsigned* count, unsigned* maxSymbolValuePtr, const void* src, size_t srcSize, unsigned* workSpace);
+/**< same as FSE_original_count(), but using an externally provided scratch buffer.
+     `workSpace` must be a table of at least FSE_original_COUNT_WKSP_SIZE_U32 unsigned */
+
+size_t FSE_original_countFast_wksp(unsigned* count, unsigned* maxSymbolValuePtr, const void* src, size_t srcSize, unsigned* workSpace);
+/**< same as FSE_original_countFast(), but using an externally provided scratch buffer. */
+
+size_t FSE_original_count_mt(unsigned* count, unsigned* maxSymbolValuePtr, const void* src, size_t srcSize, unsigned nbThreads);
+/**< same as FSE_original_count(), but splits large inputs into segments counted in parallel by up to `nbThreads` threads.
+     Result is always identical to FSE_original_count().
+     Threads are only used when library is compiled with FSE_original_MULTITHREAD (see threading.h),
+     and when each thread has at least 256 KB to count. Otherwise, it's the same as FSE_original_count(). */
+
 unsigned FSE_original_optimalTableLog_internal(unsigned maxTableLog, size_t srcSize, unsigned maxSymbolValue, unsigned minus);
 /**< same as FSE_original_optimalTableLog(), which used `minus==2` */
 
+size_t FSE_original_buildCTable_wksp(FSE_original_CTable* ct, const short* normalizedCounter, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize);
+/**< same as FSE_original_buildCTable(), but using an externally provided scratch buffer.
+     `wkspSize` must be >= `(1<<tableLog)` bytes */
+
+size_t FSE_original_estimateCompressedSize(const short* norm, const unsigned* count, unsigned maxSymbolValue, unsigned tableLog);
+/**< estimate size of bitstream produced by FSE_original_compress_usingCTable() for a block of histogram `count`,
+     using a CTable built from `norm`, without encoding anything.
+     Result is typically within 1% of actual size.
+     It doesn't include table header (see FSE_original_writeNCount()).
+     For the 4-streams format, add 6 bytes of jump table, plus 3 * (2*tableLog+1) bits of additional final states.
+     @return : estimated size in bytes, or an errorCode if `norm` can't represent a symbol present in `count` */
+
+size_t FSE_original_findBlockSplit(const void* src, size_t srcSize, unsigned tableLog, unsigned fast);
+/**< find where statistics of byte stream `src` change enough to justify a new table (for FSE or HUF compression).
+     Histograms of successive 1 KB chunks are compared with the block accumulated so far,
+     and a split is selected when a new table is expected to save more than its header cost (estimated for `tableLog`, 0 means default).
+     `fast` mode uses 4 KB chunks and samples 1 byte out of 4, for a cost of a few % of compression time.
+     Typical usage : compress first `result` bytes as a block, then call again on the remainder.
+     @return : size of first block (<= `srcSize`), `srcSize` if no split is worthwhile, or an errorCode */
+
 size_t FSE_original_buildCTable_raw (FSE_original_CTable* ct, unsigned nbBits);
 /**< build a fake FSE_original_CTable, designed to not compress an input, where each symbol uses nbBits */
 
@@ -313,6 +354,128 @@ size_t FSE_original_buildDTable_rle (FSE_original_DTable* dt, unsigned char symb
 /**< build a fake FSE_original_DTable, designed to always generate the same symbolValue */
 
 
+/* *****************************************
+*  FSE 4-streams API
+*******************************************/
+/*!
+   The 4-streams format splits input into 4 segments of (srcSize+3)/4 bytes (last one is smaller),
+   each one compressed as an independent FSE bitstream using the same CTable.
+   Compressed block starts with a jump table, storing the compressed sizes of the first 3 streams (little-endian),
+   on 16 bits (6 bytes), or on 32 bits (12 bytes) for blocks larger than 128 KB.
+   Since the exact regenerated size is known, decoders infer the field width from it.
+   The decoder processes all 4 streams within a single loop, which exposes more instruction-level parallelism.
+   Since decoding is driven by segment sizes, the exact regenerated size must be provided to the decoder.
+*/
+#define FSE_original_4X_JUMPTABLE_ENTRY_SIZE(blockSize) (((blockSize) > (128 << 10)) ? 4 : 2)   /* bytes per jump table field */
+
+size_t FSE_original_compress4X (void* dst, size_t dstCapacity, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+/**< same as FSE_original_compress2(), but using 4 interleaved streams.
+     Compressed data must be decoded using FSE_original_decompress4X() */
+
+size_t FSE_original_decompress4X (void* dst, size_t originalSize, const void* cSrc, size_t cSrcSize);
+/**< `originalSize` must be the exact size of regenerated data */
+
+size_t FSE_original_compress4X_usingCTable (void* dst, size_t dstCapacity, const void* src, size_t srcSize, const FSE_original_CTable* ct);
+/**< same as FSE_original_compress_usingCTable(), but using 4 interleaved streams.
+     @return : size of compressed data (<= `dstCapacity`),
+               or 0 if compressed data could not fit into `dst`, or if `srcSize` is too small (< 32),
+               or an errorCode, which can be tested using FSE_original_isError() */
+
+size_t FSE_original_decompress4X_usingDTable (void* dst, size_t originalSize, const void* cSrc, size_t cSrcSize, const FSE_original_DTable* dt);
+/**< decode a block generated by FSE_original_compress4X_usingCTable().
+     `originalSize` must be the exact size of regenerated data.
+     @return : `originalSize`, or an errorCode, which can be tested using FSE_original_isError() */
+
+/* *** Padded destination *** */
+#define FSE_original_DECODE_PADDING 8   /* bytes which may be written beyond the end of `dst` by *_withPadding() variants */
+
+size_t FSE_original_decompress_usingDTable_withPadding (void* dst, size_t dstCapacity, const void* cSrc, size_t cSrcSize, const FSE_original_DTable* dt);
+size_t FSE_original_decompress4X_usingDTable_withPadding (void* dst, size_t originalSize, const void* cSrc, size_t cSrcSize, const FSE_original_DTable* dt);
+/**< same as FSE_original_decompress_usingDTable() and FSE_original_decompress4X_usingDTable(),
+     but `dst` must be writable up to `dstCapacity + FSE_original_DECODE_PADDING` (resp. `originalSize + ...`) bytes.
+     Main loops then run up to the end of `dst` instead of stopping early to finish with the careful tail loops.
+     Content of padding bytes is undefined after the call. */
+
+
+/* *****************************************
+*  FSE compression context and workspace
+*******************************************/
+/*!
+   FSE_original_compress2() allocates its tables on stack, which requires ~20 KB of stack space.
+   Below variants take all their scratch memory from a workspace, or from a context, provided by the caller.
+   It avoids stack usage (useful with small stacks, such as fibers or coroutines),
+   and touching new memory pages for each call : a context can be re-used for any number of compressions.
+   Compressed data is the same as FSE_original_compress2() and FSE_original_compress4X().
+*/
+size_t FSE_original_compress_wksp (void* dst, size_t dstCapacity, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize);
+size_t FSE_original_compress4X_wksp (void* dst, size_t dstCapacity, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize);
+/**< `workSpace` must be aligned on 4-bytes boundaries, and its size must be >= FSE_original_WKSP_SIZE_U32(tableLog, maxSymbolValue) * sizeof(unsigned).
+     Note : a `tableLog` too small to represent all symbols is automatically increased.
+            A workspace of FSE_original_WKSP_SIZE_U32(FSE_original_MAX_TABLELOG, maxSymbolValue) is always large enough.
+     @return : same as FSE_original_compress2(), or FSE_original_error_workSpace_tooSmall */
+
+typedef struct FSE_original_CCtx_s FSE_original_CCtx;   /* incomplete type */
+FSE_original_CCtx* FSE_original_createCCtx(void);
+void      FSE_original_freeCCtx(FSE_original_CCtx* cctx);
+
+size_t FSE_original_compressCCtx (FSE_original_CCtx* cctx, void* dst, size_t dstCapacity, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+size_t FSE_original_compress4X_CCtx (FSE_original_CCtx* cctx, void* dst, size_t dstCapacity, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+/**< same as FSE_original_compress2() and FSE_original_compress4X(), using memory from `cctx`.
+     A context can be re-used for successive compressions, but must not be shared by concurrent threads. */
+
+
+/* *****************************************
+*  FSE table repeat mode
+*******************************************/
+/*!
+   Successive blocks of a same stream often have similar statistics.
+   In repeat mode, compressor may re-use the table of previous compressed block,
+   when it estimates it's cheaper than building and sending a new one.
+   Such block starts with the single byte FSE_original_REPEAT_HEADER instead of a normalized counter header,
+   and the decoder re-uses its previous table too, skipping table construction.
+
+   `cctx` remembers the table of the last block it compressed (result > 1).
+   `dctx` remembers the table of the last block it decoded.
+   Hence, all compressed blocks must be decoded, in the same order, using the same `dctx`.
+   If a compressed block is not sent (for example, stored uncompressed instead), or when starting a new stream,
+   use FSE_original_resetCCtx(), so that next block does not depend on a table the decoder doesn't know.
+   FSE_original_decompress() and FSE_original_decompress4X() reject blocks which re-use previous table.
+*/
+#define FSE_original_REPEAT_HEADER 0x0F   /* invalid as normalized counter header (tableLog too large) */
+
+size_t FSE_original_compressCCtx_repeat (FSE_original_CCtx* cctx, void* dst, size_t dstCapacity, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+size_t FSE_original_compress4X_CCtx_repeat (FSE_original_CCtx* cctx, void* dst, size_t dstCapacity, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+/**< same as FSE_original_compressCCtx() and FSE_original_compress4X_CCtx(), but may re-use table of previous block */
+
+void   FSE_original_resetCCtx(FSE_original_CCtx* cctx);   /**< forget previous table : next block will not re-use it */
+
+typedef struct FSE_original_DCtx_s FSE_original_DCtx;   /* incomplete type */
+FSE_original_DCtx* FSE_original_createDCtx(void);
+void      FSE_original_freeDCtx(FSE_original_DCtx* dctx);
+void      FSE_original_resetDCtx(FSE_original_DCtx* dctx);   /**< forget previous tables */
+
+size_t FSE_original_decompressDCtx (FSE_original_DCtx* dctx, void* dst, size_t dstCapacity, const void* cSrc, size_t cSrcSize);
+size_t FSE_original_decompress4X_DCtx (FSE_original_DCtx* dctx, void* dst, size_t originalSize, const void* cSrc, size_t cSrcSize);
+/**< same as FSE_original_decompress() and FSE_original_decompress4X(), using decoding table stored into `dctx`.
+     Also decodes blocks which re-use previous table. */
+
+
+/* *****************************************
+*  FSE decoding table cache
+*******************************************/
+/*!
+   Streams of small blocks with stable statistics often repeat the exact same table header.
+   A `dctx` keeps the decoding tables of the last `nbTables` different headers it decoded, identified by a hash of raw header bytes.
+   When a block header matches one of them (bytes are compared too), its table is re-used, and FSE_original_buildDTable() is skipped.
+   Otherwise, the least recently used table is replaced.
+   FSE_original_createDCtx() caches a single table; each table costs ~16 KB (FSE_original_DTABLE_SIZE_U32(FSE_original_MAX_TABLELOG)).
+   FSE_original_resetDCtx() also empties the cache and its statistics.
+*/
+FSE_original_DCtx* FSE_original_createDCtx_advanced(unsigned nbTables);   /**< `nbTables` : from 1 to 64 */
+void FSE_original_getDCtxCacheStats(const FSE_original_DCtx* dctx, unsigned long long* hits, unsigned long long* misses);
+/**< nb of headers found within cache (hits), and nb of tables built (misses), since creation or last reset */
+
+
 /* *****************************************
 *  FSE symbol compression API
 *******************************************/
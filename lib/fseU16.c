@@ -89,6 +89,7 @@ typedef struct {
 
 #define FSE_original_count_generic FSE_original_count_genericU16
 #define FSE_original_buildCTable   FSE_original_buildCTableU16
+#define FSE_original_buildCTable_wksp FSE_original_buildCTableU16_wksp
 
 #define FSE_original_DECODE_TYPE   FSE_original_decode_tU16
 #define FSE_original_createDTable  FSE_original_createDTableU16
@@ -57,6 +57,8 @@
 #include <string.h>     /* memcpy, memset */
 #include <stdio.h>      /* printf (debug) */
 #include "bitstream.h"
+#include "cpu.h"
+#include "threading.h"
 #define FSE_original_STATIC_LINKING_ONLY
 #include "fse.h"
 
@@ -97,7 +99,8 @@ typedef U32 CTable_max_t[FSE_original_CTABLE_SIZE_U32(FSE_original_MAX_TABLELOG,
 
 
 /* Function templates */
-size_t FSE_original_buildCTable(FSE_original_CTable* ct, const short* normalizedCounter, unsigned maxSymbolValue, unsigned tableLog)
+size_t FSE_original_buildCTable_wksp(FSE_original_CTable* ct, const short* normalizedCounter, unsigned maxSymbolValue, unsigned tableLog,
+                            void* workSpace, size_t wkspSize)
 {
     U32 const tableSize = 1 << tableLog;
     U32 const tableMask = tableSize - 1;
@@ -108,9 +111,11 @@ size_t FSE_original_buildCTable(FSE_original_CTable* ct, const short* normalized
     U32 const step = FSE_original_TABLESTEP(tableSize);
     U32 cumul[FSE_original_MAX_SYMBOL_VALUE+2];
 
-    FSE_original_FUNCTION_TYPE tableSymbol[FSE_original_MAX_TABLESIZE]; /* memset() is not necessary, even if static analyzer complain about it */
+    FSE_original_FUNCTION_TYPE* const tableSymbol = (FSE_original_FUNCTION_TYPE*)workSpace; /* memset() is not necessary, even if static analyzer complain about it */
     U32 highThreshold = tableSize-1;
 
+    if (((size_t)tableSize * sizeof(FSE_original_FUNCTION_TYPE)) > wkspSize) return ERROR(workSpace_tooSmall);
+
     /* CTable header */
     tableU16[-2] = (U16) tableLog;
     tableU16[-1] = (U16) maxSymbolValue;
@@ -132,7 +137,34 @@ size_t FSE_original_buildCTable(FSE_original_CTable* ct, const short* normalized
     }
 
     /* Spread symbols */
-    {   U32 position = 0;
+    if ((sizeof(FSE_original_FUNCTION_TYPE)==1) && (highThreshold==tableSize-1) && (tableSize>=8)) {
+        /* Fast path : no low proba symbol, so every position is visited.
+         * Symbols are first laid down sequentially, 8 at a time, then scattered with `step`.
+         * tableU16 is not built yet : its 2*tableSize bytes are used as spread buffer. */
+        BYTE* const spread = (BYTE*)(void*)tableU16;
+        {   U64 const add = 0x0101010101010101ULL;
+            U64 sv = 0;
+            size_t pos = 0;
+            U32 s;
+            for (s=0; s<=maxSymbolValue; s++, sv += add) {
+                int const n = normalizedCounter[s];
+                int i;
+                if ((n < 0) || (pos + (size_t)n > tableSize)) return ERROR(GENERIC);
+                MEM_write64(spread + pos, sv);
+                for (i=8; i<n; i+=8) MEM_write64(spread + pos + i, sv);
+                pos += n;
+            }
+            if (pos!=tableSize) return ERROR(GENERIC);   /* Must fill all positions */
+        }
+        {   U32 position = 0;
+            U32 s;
+            for (s=0; s<tableSize; s+=2) {   /* tableSize is a multiple of 2 */
+                tableSymbol[position] = (FSE_original_FUNCTION_TYPE)spread[s];
+                tableSymbol[(position + step) & tableMask] = (FSE_original_FUNCTION_TYPE)spread[s+1];
+                position = (position + 2*step) & tableMask;
+        }   }
+    } else {
+        U32 position = 0;
         U32 symbol;
         for (symbol=0; symbol<=maxSymbolValue; symbol++) {
             int nbOccurences;
@@ -177,6 +209,13 @@ size_t FSE_original_buildCTable(FSE_original_CTable* ct, const short* normalized
     return 0;
 }
 
+size_t FSE_original_buildCTable(FSE_original_CTable* ct, const short* normalizedCounter, unsigned maxSymbolValue, unsigned tableLog)
+{
+    FSE_original_FUNCTION_TYPE tableSymbol[FSE_original_MAX_TABLESIZE];   /* memset() is not necessary, even if static analyzer complain about it */
+    if (tableLog > FSE_original_MAX_TABLELOG) return ERROR(tableLog_tooLarge);
+    return FSE_original_buildCTable_wksp(ct, normalizedCounter, maxSymbolValue, tableLog, tableSymbol, sizeof(tableSymbol));
+}
+
 
 
 #ifndef FSE_original_COMMONDEFS_ONLY
@@ -326,20 +365,60 @@ static size_t FSE_original_count_simple(unsigned* count, unsigned* maxSymbolValu
 }
 
 
-static size_t FSE_original_count_parallel(unsigned* count, unsigned* maxSymbolValuePtr,
+#define FSE_original_COUNT_NBTABLES 8   /* separate tables reduce dependency chains on repeated symbols */
+#define FSE_original_COUNT_TABLESIZE (256+16)   /* padding avoids tables aliasing each other in L1 (4K aliasing) */
+
+typedef U32 FSE_original_countTables_t[FSE_original_COUNT_NBTABLES][FSE_original_COUNT_TABLESIZE];
+
+/* FSE_original_countStripes() :
+   count bytes from `ip` by stripes of 16 bytes, into `counting`.
+   Successive 32-bits words alternate between tables 0-3 and 4-7.
+   @return : position of first byte not counted yet */
+static const BYTE* FSE_original_countStripes(FSE_original_countTables_t counting,
+                                             const BYTE* ip, const BYTE* const iend)
+{
+    if (iend-ip < 20) return ip;
+    {   U32 cached = MEM_read32(ip); ip += 4;
+        while (ip < iend-15) {
+            U32 c = cached; cached = MEM_read32(ip); ip += 4;
+            counting[0][(BYTE) c     ]++;
+            counting[1][(BYTE)(c>>8) ]++;
+            counting[2][(BYTE)(c>>16)]++;
+            counting[3][       c>>24 ]++;
+            c = cached; cached = MEM_read32(ip); ip += 4;
+            counting[4][(BYTE) c     ]++;
+            counting[5][(BYTE)(c>>8) ]++;
+            counting[6][(BYTE)(c>>16)]++;
+            counting[7][       c>>24 ]++;
+            c = cached; cached = MEM_read32(ip); ip += 4;
+            counting[0][(BYTE) c     ]++;
+            counting[1][(BYTE)(c>>8) ]++;
+            counting[2][(BYTE)(c>>16)]++;
+            counting[3][       c>>24 ]++;
+            c = cached; cached = MEM_read32(ip); ip += 4;
+            counting[4][(BYTE) c     ]++;
+            counting[5][(BYTE)(c>>8) ]++;
+            counting[6][(BYTE)(c>>16)]++;
+            counting[7][       c>>24 ]++;
+        }
+        ip-=4;
+    }
+    return ip;
+}
+
+/* FSE_original_count_parallel_wksp() :
+   `workSpace` must be a table of FSE_original_COUNT_WKSP_SIZE_U32 unsigned, used as FSE_original_countTables_t */
+static size_t FSE_original_count_parallel_wksp(unsigned* count, unsigned* maxSymbolValuePtr,
                                 const void* source, size_t sourceSize,
-                                unsigned checkMax)
+                                unsigned checkMax, unsigned* const workSpace)
 {
     const BYTE* ip = (const BYTE*)source;
     const BYTE* const iend = ip+sourceSize;
     unsigned maxSymbolValue = *maxSymbolValuePtr;
     unsigned max=0;
 
-
-    U32 Counting1[256] = { 0 };
-    U32 Counting2[256] = { 0 };
-    U32 Counting3[256] = { 0 };
-    U32 Counting4[256] = { 0 };
+    U32 (* const counting)[FSE_original_COUNT_TABLESIZE] = (U32 (*)[FSE_original_COUNT_TABLESIZE])workSpace;
+    FSE_original_STATIC_ASSERT(sizeof(FSE_original_countTables_t) == FSE_original_COUNT_WKSP_SIZE_U32 * sizeof(unsigned));   /* A compilation error here means FSE_original_COUNT_WKSP_SIZE_U32 is not correct */
 
     /* safety checks */
     if (!sourceSize) {
@@ -348,45 +427,25 @@ static size_t FSE_original_count_parallel(unsigned* count, unsigned* maxSymbolVa
         return 0;
     }
     if (!maxSymbolValue) maxSymbolValue = 255;            /* 0 == default */
+    memset(counting, 0, sizeof(FSE_original_countTables_t));
 
     /* by stripes of 16 bytes */
-    {   U32 cached = MEM_read32(ip); ip += 4;
-        while (ip < iend-15) {
-            U32 c = cached; cached = MEM_read32(ip); ip += 4;
-            Counting1[(BYTE) c     ]++;
-            Counting2[(BYTE)(c>>8) ]++;
-            Counting3[(BYTE)(c>>16)]++;
-            Counting4[       c>>24 ]++;
-            c = cached; cached = MEM_read32(ip); ip += 4;
-            Counting1[(BYTE) c     ]++;
-            Counting2[(BYTE)(c>>8) ]++;
-            Counting3[(BYTE)(c>>16)]++;
-            Counting4[       c>>24 ]++;
-            c = cached; cached = MEM_read32(ip); ip += 4;
-            Counting1[(BYTE) c     ]++;
-            Counting2[(BYTE)(c>>8) ]++;
-            Counting3[(BYTE)(c>>16)]++;
-            Counting4[       c>>24 ]++;
-            c = cached; cached = MEM_read32(ip); ip += 4;
-            Counting1[(BYTE) c     ]++;
-            Counting2[(BYTE)(c>>8) ]++;
-            Counting3[(BYTE)(c>>16)]++;
-            Counting4[       c>>24 ]++;
-        }
-        ip-=4;
-    }
+    ip = FSE_original_countStripes(counting, ip, iend);
 
     /* finish last symbols */
-    while (ip<iend) Counting1[*ip++]++;
+    while (ip<iend) counting[0][*ip++]++;
+
+    {   U32 s; for (s=0; s<256; s++) {
+            U32 t; for (t=1; t<FSE_original_COUNT_NBTABLES; t++) counting[0][s] += counting[t][s];
+    }   }
 
     if (checkMax) {   /* verify stats will fit into destination table */
         U32 s; for (s=255; s>maxSymbolValue; s--) {
-            Counting1[s] += Counting2[s] + Counting3[s] + Counting4[s];
-            if (Counting1[s]) return ERROR(maxSymbolValue_tooSmall);
+            if (counting[0][s]) return ERROR(maxSymbolValue_tooSmall);
     }   }
 
     { U32 s; for (s=0; s<=maxSymbolValue; s++) {
-        count[s] = Counting1[s] + Counting2[s] + Counting3[s] + Counting4[s];
+        count[s] = counting[0][s];
         if (count[s] > max) max = count[s];
     }}
 
@@ -396,20 +455,115 @@ static size_t FSE_original_count_parallel(unsigned* count, unsigned* maxSymbolVa
 }
 
 /* fast variant (unsafe : won't check if src contains values beyond count[] limit) */
+size_t FSE_original_countFast_wksp(unsigned* count, unsigned* maxSymbolValuePtr,
+                          const void* source, size_t sourceSize, unsigned* workSpace)
+{
+    if (sourceSize < 1500) return FSE_original_count_simple(count, maxSymbolValuePtr, source, sourceSize);
+    return FSE_original_count_parallel_wksp(count, maxSymbolValuePtr, source, sourceSize, 0, workSpace);
+}
+
 size_t FSE_original_countFast(unsigned* count, unsigned* maxSymbolValuePtr,
                      const void* source, size_t sourceSize)
 {
-    if (sourceSize < 1500) return FSE_original_count_simple(count, maxSymbolValuePtr, source, sourceSize);
-    return FSE_original_count_parallel(count, maxSymbolValuePtr, source, sourceSize, 0);
+    unsigned tmpCounters[FSE_original_COUNT_WKSP_SIZE_U32];
+    return FSE_original_countFast_wksp(count, maxSymbolValuePtr, source, sourceSize, tmpCounters);
 }
 
-size_t FSE_original_count(unsigned* count, unsigned* maxSymbolValuePtr,
-                 const void* source, size_t sourceSize)
+size_t FSE_original_count_wksp(unsigned* count, unsigned* maxSymbolValuePtr,
+                      const void* source, size_t sourceSize, unsigned* workSpace)
 {
     if (*maxSymbolValuePtr <255)
-        return FSE_original_count_parallel(count, maxSymbolValuePtr, source, sourceSize, 1);
+        return FSE_original_count_parallel_wksp(count, maxSymbolValuePtr, source, sourceSize, 1, workSpace);
     *maxSymbolValuePtr = 255;
-    return FSE_original_countFast(count, maxSymbolValuePtr, source, sourceSize);
+    return FSE_original_countFast_wksp(count, maxSymbolValuePtr, source, sourceSize, workSpace);
+}
+
+size_t FSE_original_count(unsigned* count, unsigned* maxSymbolValuePtr,
+                 const void* source, size_t sourceSize)
+{
+    unsigned tmpCounters[FSE_original_COUNT_WKSP_SIZE_U32];
+    return FSE_original_count_wksp(count, maxSymbolValuePtr, source, sourceSize, tmpCounters);
+}
+
+
+#define FSE_original_COUNT_MT_MINSIZE (256 << 10)   /* below this size per thread, threads cost more than they save */
+#define FSE_original_COUNT_MT_MAXTHREADS 64
+
+typedef struct {
+    const BYTE* src;
+    size_t srcSize;
+    unsigned count[256];
+} FSE_original_countJob_t;
+
+static void* FSE_original_countJob(void* opaque)
+{
+    FSE_original_countJob_t* const job = (FSE_original_countJob_t*)opaque;
+    unsigned maxSymbolValue = 255;
+    unsigned tmpCounters[FSE_original_COUNT_WKSP_SIZE_U32];
+    FSE_original_count_parallel_wksp(job->count, &maxSymbolValue, job->src, job->srcSize, 0, tmpCounters);   /* fills all 256 cells */
+    return NULL;
+}
+
+size_t FSE_original_count_mt(unsigned* count, unsigned* maxSymbolValuePtr,
+                    const void* source, size_t sourceSize, unsigned nbThreads)
+{
+    FSE_original_countJob_t* jobs;
+    size_t const maxNbJobs = sourceSize / FSE_original_COUNT_MT_MINSIZE;
+    unsigned nbJobs = nbThreads;
+
+    if (nbJobs > FSE_original_COUNT_MT_MAXTHREADS) nbJobs = FSE_original_COUNT_MT_MAXTHREADS;
+    if (nbJobs > maxNbJobs) nbJobs = (unsigned)maxNbJobs;
+    if (!THREAD_SUPPORT || (nbJobs <= 1))
+        return FSE_original_count(count, maxSymbolValuePtr, source, sourceSize);
+    jobs = (FSE_original_countJob_t*)malloc(nbJobs * sizeof(*jobs));
+    if (jobs == NULL)
+        return FSE_original_count(count, maxSymbolValuePtr, source, sourceSize);
+
+    /* split input, count each segment */
+    {   const BYTE* ip = (const BYTE*)source;
+        size_t const segmentSize = sourceSize / nbJobs;
+        unsigned u;
+        for (u=0; u<nbJobs; u++) {
+            jobs[u].src = ip;
+            jobs[u].srcSize = (u==nbJobs-1) ? sourceSize - (size_t)(ip - (const BYTE*)source) : segmentSize;
+            ip += segmentSize;
+        }
+#if THREAD_SUPPORT
+        {   THREAD_t threads[FSE_original_COUNT_MT_MAXTHREADS];
+            unsigned started[FSE_original_COUNT_MT_MAXTHREADS];
+            for (u=1; u<nbJobs; u++)
+                started[u] = !THREAD_create(&threads[u], FSE_original_countJob, jobs+u);
+            FSE_original_countJob(jobs);   /* first segment is counted by calling thread */
+            for (u=1; u<nbJobs; u++) {
+                if (started[u]) THREAD_join(&threads[u]);
+                else FSE_original_countJob(jobs+u);   /* could not start thread : count it here */
+        }   }
+#else
+        for (u=0; u<nbJobs; u++) FSE_original_countJob(jobs+u);   /* not reachable : no split without threads */
+#endif
+    }
+
+    /* merge, then finalize exactly as FSE_original_count() */
+    {   unsigned maxSymbolValue = *maxSymbolValuePtr;
+        unsigned const checkMax = (maxSymbolValue < 255);
+        unsigned max = 0;
+        unsigned s, u;
+        if (!maxSymbolValue || (maxSymbolValue > 255)) maxSymbolValue = 255;
+        for (u=1; u<nbJobs; u++)
+            for (s=0; s<256; s++) jobs[0].count[s] += jobs[u].count[s];
+        if (checkMax) {   /* verify stats will fit into destination table */
+            for (s=255; s>maxSymbolValue; s--) {
+                if (jobs[0].count[s]) { free(jobs); return ERROR(maxSymbolValue_tooSmall); }
+        }   }
+        for (s=0; s<=maxSymbolValue; s++) {
+            count[s] = jobs[0].count[s];
+            if (count[s] > max) max = count[s];
+        }
+        free(jobs);
+        while (!count[maxSymbolValue]) maxSymbolValue--;
+        *maxSymbolValuePtr = maxSymbolValue;
+        return (size_t)max;
+    }
 }
 
 
@@ -615,6 +769,175 @@ size_t FSE_original_normalizeCount (short* normalizedCounter, unsigned tableLog,
 }
 
 
+/*-**************************************************************
+*  Compressed size estimation
+****************************************************************/
+/* FSE_original_log2_8() :
+   @return : log2(v), with 8 bits of fractional precision. `v` must be >= 1 */
+static U32 FSE_original_log2_8(U32 v)
+{
+    static const U16 log2Frac[17] = { 0, 22, 44, 63, 82, 100, 118, 134, 150, 165, 179, 193, 207, 220, 232, 244, 256 };   /* log2(1+n/16) * 256 */
+    U32 const hb = BIT_highbit32(v);
+    U32 const mantissa = ((hb >= 8) ? (v >> (hb-8)) : (v << (8-hb))) & 255;
+    U32 const idx = mantissa >> 4;
+    return (hb << 8) + log2Frac[idx] + (((log2Frac[idx+1] - log2Frac[idx]) * (mantissa & 15)) >> 4);
+}
+
+/* FSE_original_estimateBits() :
+   estimated nb of bits (with 8 bits of fractional precision) to encode histogram `count` using distribution `norm`.
+   All symbols present in `count` must have a non-zero probability in `norm` */
+static U64 FSE_original_estimateBits(const short* norm, const unsigned* count, unsigned maxSymbolValue, unsigned tableLog)
+{
+    U64 bits = 0;
+    unsigned s;
+    for (s=0; s<=maxSymbolValue; s++) {
+        U32 const proba = (norm[s] == -1) ? 1 : (U32)norm[s];
+        if (!count[s]) continue;
+        bits += (U64)count[s] * ((tableLog << 8) - FSE_original_log2_8(proba));
+    }
+    return bits;
+}
+
+size_t FSE_original_estimateCompressedSize(const short* norm, const unsigned* count, unsigned maxSymbolValue, unsigned tableLog)
+{
+    unsigned s;
+    if (tableLog > FSE_original_MAX_TABLELOG) return ERROR(tableLog_tooLarge);
+    if (maxSymbolValue > FSE_original_MAX_SYMBOL_VALUE) return ERROR(maxSymbolValue_tooLarge);
+    for (s=0; s<=maxSymbolValue; s++)
+        if (count[s] && !norm[s]) return ERROR(GENERIC);   /* symbol can't be represented */
+    {   U64 const nbBits = (FSE_original_estimateBits(norm, count, maxSymbolValue, tableLog) >> 8) + 2*tableLog + 1;   /* + 2 final states + end mark */
+        return (size_t)((nbBits+7) >> 3);
+    }
+}
+
+
+
+/*-**************************************************************
+*  Block splitting
+****************************************************************/
+#define FSE_original_SPLIT_CHUNKLOG   10   /* granularity of split positions : 1 KB (4 KB in fast mode) */
+#define FSE_original_SPLIT_LOOKAHEAD   4   /* nb of chunks compared with current block */
+#define FSE_original_SPLIT_SCANMAX   (1U << 30)   /* keeps all products of counts within 64 bits */
+
+/* FSE_original_log2_16() :
+   @return : log2(v), with 16 bits of fractional precision. `v` must be >= 1.
+   Contrary to FSE_original_log2_8(), all bits of `v` contribute, so that logs of close values can be subtracted */
+static U32 FSE_original_log2_16(U64 v)
+{
+    static const U32 log2Frac[17] = { 0, 5732, 11136, 16248, 21098, 25711, 30109, 34312, 38336,
+                                      42196, 45904, 49472, 52911, 56229, 59434, 62534, 65536 };   /* log2(1+n/16) * 65536 */
+    U32 const hb = (v >> 32) ? 32 + BIT_highbit32((U32)(v >> 32)) : BIT_highbit32((U32)v);
+    U64 const mantissa = (hb >= 31) ? (v >> (hb-31)) : (v << (31-hb));   /* 1.31 fixed point */
+    U32 const idx = (U32)(mantissa >> 27) & 15;
+    U64 const rest = mantissa & ((1U<<27)-1);
+    return (hb << 16) + log2Frac[idx] + (U32)(((log2Frac[idx+1] - log2Frac[idx]) * rest) >> 27);
+}
+
+/* FSE_original_splitGain() :
+   nb of bits saved (16 bits of fractional precision) by coding `c1` and `c2` with their own distributions
+   rather than with the distribution of `c1` + `c2`.
+   Each symbol contributes c1*log2(p1/p) + c2*log2(p2/p), computed from logs of close values to preserve precision */
+static U64 FSE_original_splitGain(const unsigned* c1, U32 total1, const unsigned* c2, U32 total2)
+{
+    U64 const total = (U64)total1 + total2;
+    S64 gain = 0;
+    unsigned s;
+    if ((total1==0) || (total2==0)) return 0;
+    for (s=0; s<256; s++) {
+        U64 const c = (U64)c1[s] + c2[s];
+        if (c1[s]) gain += (S64)c1[s] * ((S64)FSE_original_log2_16(c1[s] * total) - (S64)FSE_original_log2_16(c * total1));
+        if (c2[s]) gain += (S64)c2[s] * ((S64)FSE_original_log2_16(c2[s] * total) - (S64)FSE_original_log2_16(c * total2));
+    }
+    return (gain > 0) ? (U64)gain : 0;   /* log2 approximation can make it slightly negative */
+}
+
+static U32 FSE_original_splitCount(unsigned* count, const BYTE* src, size_t srcSize, unsigned step)
+{
+    size_t i;
+    for (i=0; i<srcSize; i+=step) count[src[i]]++;
+    return (U32)((srcSize + step - 1) / step);
+}
+
+static void FSE_original_splitMove(unsigned* dstCount, unsigned* srcCount, const unsigned* count)
+{
+    unsigned s;
+    for (s=0; s<256; s++) { dstCount[s] += count[s]; srcCount[s] -= count[s]; }
+}
+
+size_t FSE_original_findBlockSplit(const void* src, size_t srcSize, unsigned tableLog, unsigned fast)
+{
+    const BYTE* const istart = (const BYTE*)src;
+    unsigned const step = fast ? 4 : 1;   /* fast mode samples 1 byte out of 4 */
+    size_t const chunkSize = (size_t)1 << (FSE_original_SPLIT_CHUNKLOG + (fast ? 2 : 0));
+    size_t const scanSize = (srcSize > FSE_original_SPLIT_SCANMAX) ? FSE_original_SPLIT_SCANMAX : srcSize;
+    size_t const nbChunks = scanSize / chunkSize;   /* last incomplete chunk always belongs to last block */
+    unsigned blockCount[256];
+    unsigned windowCount[256];
+    unsigned chunkCount[FSE_original_SPLIT_LOOKAHEAD][256];   /* chunk `c` is stored into chunkCount[c % FSE_original_SPLIT_LOOKAHEAD] */
+    U32 chunkTotal[FSE_original_SPLIT_LOOKAHEAD];
+    U32 blockTotal, windowTotal = 0;
+    size_t c;
+
+    if (nbChunks < 2) return srcSize;
+    if (tableLog==0) tableLog = FSE_original_DEFAULT_TABLELOG;
+    if (tableLog > FSE_original_MAX_TABLELOG) return ERROR(tableLog_tooLarge);
+
+    memset(blockCount, 0, sizeof(blockCount));
+    memset(windowCount, 0, sizeof(windowCount));
+    memset(chunkCount, 0, sizeof(chunkCount));
+    blockTotal = FSE_original_splitCount(blockCount, istart, chunkSize, step);
+
+    /* window : chunks following current block */
+    for (c=1; (c<=FSE_original_SPLIT_LOOKAHEAD) && (c<nbChunks); c++) {
+        unsigned* const cc = chunkCount[c % FSE_original_SPLIT_LOOKAHEAD];
+        unsigned s;
+        chunkTotal[c % FSE_original_SPLIT_LOOKAHEAD] = FSE_original_splitCount(cc, istart + c*chunkSize, chunkSize, step);
+        windowTotal += chunkTotal[c % FSE_original_SPLIT_LOOKAHEAD];
+        for (s=0; s<256; s++) windowCount[s] += cc[s];
+    }
+
+    for (c=1; c<nbChunks; c++) {
+        size_t const windowEnd = (c + FSE_original_SPLIT_LOOKAHEAD < nbChunks) ? c + FSE_original_SPLIT_LOOKAHEAD : nbChunks;
+
+        /* split within window if coding it with its own table saves more than the new table header */
+        {   U32 nbSymbols = 0;
+            unsigned s;
+            for (s=0; s<256; s++) nbSymbols += (windowCount[s]!=0);
+            {   U64 const headerCost = ((U64)nbSymbols * (tableLog/2 + 1) + 32) << 16;   /* rough NCount size, + block header */
+                if (FSE_original_splitGain(blockCount, blockTotal, windowCount, windowTotal) * step > headerCost) {
+                    /* window is heterogeneous : select best split position inside it */
+                    U64 bestGain = 0;
+                    size_t bestPos = c, j;
+                    for (j=c; j<windowEnd; j++) {
+                        U64 const gain = FSE_original_splitGain(blockCount, blockTotal, windowCount, windowTotal);
+                        if (gain > bestGain) { bestGain = gain; bestPos = j; }
+                        FSE_original_splitMove(blockCount, windowCount, chunkCount[j % FSE_original_SPLIT_LOOKAHEAD]);
+                        blockTotal += chunkTotal[j % FSE_original_SPLIT_LOOKAHEAD];
+                        windowTotal -= chunkTotal[j % FSE_original_SPLIT_LOOKAHEAD];
+                    }
+                    return bestPos * chunkSize;
+        }   }   }
+
+        /* move chunk `c` from window into current block */
+        FSE_original_splitMove(blockCount, windowCount, chunkCount[c % FSE_original_SPLIT_LOOKAHEAD]);
+        blockTotal += chunkTotal[c % FSE_original_SPLIT_LOOKAHEAD];
+        windowTotal -= chunkTotal[c % FSE_original_SPLIT_LOOKAHEAD];
+
+        /* append next chunk to window, re-using slot of chunk `c` */
+        if (c + FSE_original_SPLIT_LOOKAHEAD < nbChunks) {
+            unsigned* const cc = chunkCount[c % FSE_original_SPLIT_LOOKAHEAD];
+            unsigned s;
+            memset(cc, 0, 256 * sizeof(*cc));
+            chunkTotal[c % FSE_original_SPLIT_LOOKAHEAD] = FSE_original_splitCount(cc, istart + (c + FSE_original_SPLIT_LOOKAHEAD)*chunkSize, chunkSize, step);
+            windowTotal += chunkTotal[c % FSE_original_SPLIT_LOOKAHEAD];
+            for (s=0; s<256; s++) windowCount[s] += cc[s];
+        }
+    }
+
+    return srcSize;   /* no split */
+}
+
+
 /* fake FSE_original_CTable, for raw (uncompressed) input */
 size_t FSE_original_buildCTable_raw (FSE_original_CTable* ct, unsigned nbBits)
 {
@@ -674,7 +997,7 @@ size_t FSE_original_buildCTable_rle (FSE_original_CTable* ct, BYTE symbolValue)
 }
 
 
-static size_t FSE_original_compress_usingCTable_generic (void* dst, size_t dstSize,
+FORCE_INLINE size_t FSE_original_compress_usingCTable_generic (void* dst, size_t dstSize,
                            const void* src, size_t srcSize,
                            const FSE_original_CTable* ct, const unsigned fast)
 {
@@ -734,22 +1057,131 @@ static size_t FSE_original_compress_usingCTable_generic (void* dst, size_t dstSi
     return BIT_closeCStream(&bitC);
 }
 
-size_t FSE_original_compress_usingCTable (void* dst, size_t dstSize,
+static size_t FSE_original_compress_usingCTable_default (void* dst, size_t dstSize,
                            const void* src, size_t srcSize,
-                           const FSE_original_CTable* ct)
+                           const FSE_original_CTable* ct, const unsigned fast)
 {
-    const unsigned fast = (dstSize >= FSE_original_BLOCKBOUND(srcSize));
+    if (fast)
+        return FSE_original_compress_usingCTable_generic(dst, dstSize, src, srcSize, ct, 1);
+    else
+        return FSE_original_compress_usingCTable_generic(dst, dstSize, src, srcSize, ct, 0);
+}
 
+#if CPU_TARGET_SUPPORT
+/* same loop, compiled with BMI2 shifts (shlx/shrx) */
+CPU_TARGET_ATTRIBUTE("bmi2")
+static size_t FSE_original_compress_usingCTable_bmi2 (void* dst, size_t dstSize,
+                           const void* src, size_t srcSize,
+                           const FSE_original_CTable* ct, const unsigned fast)
+{
     if (fast)
         return FSE_original_compress_usingCTable_generic(dst, dstSize, src, srcSize, ct, 1);
     else
         return FSE_original_compress_usingCTable_generic(dst, dstSize, src, srcSize, ct, 0);
 }
+#endif
+
+size_t FSE_original_compress_usingCTable (void* dst, size_t dstSize,
+                           const void* src, size_t srcSize,
+                           const FSE_original_CTable* ct)
+{
+    const unsigned fast = (dstSize >= FSE_original_BLOCKBOUND(srcSize));
+
+#if CPU_TARGET_SUPPORT
+    if (CPU_bmi2())
+        return FSE_original_compress_usingCTable_bmi2(dst, dstSize, src, srcSize, ct, fast);
+#endif
+    return FSE_original_compress_usingCTable_default(dst, dstSize, src, srcSize, ct, fast);
+}
+
+
+#define FSE_original_4X_SRCSIZE_MIN 32   /* ensures each segment is large enough to be compressed */
+
+/* FSE_original_writeJumpEntry() :
+   jump table fields are 16 bits, or 32 bits for blocks larger than 128 KB */
+static void FSE_original_writeJumpEntry(void* p, size_t value, size_t entrySize)
+{
+    if (entrySize==4) MEM_writeLE32(p, (U32)value);
+    else MEM_writeLE16(p, (U16)value);
+}
+
+size_t FSE_original_compress4X_usingCTable (void* dst, size_t dstSize,
+                             const void* src, size_t srcSize,
+                             const FSE_original_CTable* ct)
+{
+    size_t const segmentSize = (srcSize+3)/4;   /* first 3 segments */
+    size_t const entrySize = FSE_original_4X_JUMPTABLE_ENTRY_SIZE(srcSize);
+    const BYTE* ip = (const BYTE*) src;
+    const BYTE* const iend = ip + srcSize;
+    BYTE* const ostart = (BYTE*) dst;
+    BYTE* const oend = ostart + dstSize;
+    BYTE* op = ostart;
+    unsigned u;
+
+    if (srcSize < FSE_original_4X_SRCSIZE_MIN) return 0;   /* too small */
+    if (dstSize < 3*entrySize + 4*(sizeof(size_t)+1)) return 0;   /* minimum space to compress successfully */
+    op += 3*entrySize;   /* jumpTable */
+
+    for (u=0; u<3; u++) {
+        size_t const cSize = FSE_original_compress_usingCTable(op, oend-op, ip, segmentSize, ct);
+        if (FSE_original_isError(cSize)) return cSize;
+        if (cSize==0) return 0;
+        if ((entrySize==2) && (cSize > 0xFFFF)) return 0;   /* can't happen with tableLog <= 15 : 32 KB segment x 15 bits */
+        FSE_original_writeJumpEntry(ostart + u*entrySize, cSize, entrySize);
+        op += cSize;
+        ip += segmentSize;
+    }
+
+    {   size_t const cSize = FSE_original_compress_usingCTable(op, oend-op, ip, iend-ip, ct);
+        if (FSE_original_isError(cSize)) return cSize;
+        if (cSize==0) return 0;
+        op += cSize;
+    }
+
+    return op-ostart;
+}
 
 
 size_t FSE_original_compressBound(size_t size) { return FSE_original_COMPRESSBOUND(size); }
 
-size_t FSE_original_compress2 (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog)
+/* FSE_original_repeat_t :
+   table of the last compressed block, which can be re-used by the next block (see FSE_original_compressCCtx_repeat()) */
+typedef struct {
+    U32 CTable[FSE_original_CTABLE_SIZE_U32(FSE_original_MAX_TABLELOG, FSE_original_MAX_SYMBOL_VALUE)];
+    S16 norm[FSE_original_MAX_SYMBOL_VALUE+1];
+    U32 maxSymbolValue;
+    U32 tableLog;
+    U32 valid;
+} FSE_original_repeat_t;
+
+/* FSE_original_repeatIsCheaper() :
+   compares cost of re-using previous table (1 byte header) with cost of new table (`hSize` bytes header).
+   Note : previous table is only usable if it provides a probability to every present symbol */
+static int FSE_original_repeatIsCheaper(const FSE_original_repeat_t* repeat, const unsigned* count, unsigned maxSymbolValue,
+                               const short* norm, unsigned tableLog, size_t hSize)
+{
+    if (maxSymbolValue > repeat->maxSymbolValue) return 0;
+    {   unsigned s;
+        for (s=0; s<=maxSymbolValue; s++)
+            if (count[s] && !repeat->norm[s]) return 0;
+    }
+    {   U64 const repeatBits = FSE_original_estimateBits(repeat->norm, count, maxSymbolValue, repeat->tableLog);
+        U64 const newBits = FSE_original_estimateBits(norm, count, maxSymbolValue, tableLog);
+        return 1 + ((repeatBits >> 8) >> 3) <= hSize + ((newBits >> 8) >> 3);
+    }
+}
+
+/* FSE_original_compress_internal() :
+   workSpace layout : count[] | norm[] | scratch area.
+   Scratch area is used by counting tables first, then by CTable and symbol spreading table.
+   When `repeat` is provided, it's updated with the table of each compressed block,
+   and previous table is re-used instead of the new one if `allowRepeat` and it's cheaper. */
+static size_t FSE_original_compress_internal (void* dst, size_t dstSize,
+                                        const void* src, size_t srcSize,
+                                        unsigned maxSymbolValue, unsigned tableLog,
+                                        unsigned fourStreams,
+                                        void* workSpace, size_t wkspSize,
+                                        FSE_original_repeat_t* repeat, unsigned allowRepeat)
 {
     const BYTE* const istart = (const BYTE*) src;
     const BYTE* ip = istart;
@@ -758,18 +1190,22 @@ size_t FSE_original_compress2 (void* dst, size_t dstSize, const void* src, size_
     BYTE* op = ostart;
     BYTE* const oend = ostart + dstSize;
 
-    U32   count[FSE_original_MAX_SYMBOL_VALUE+1];
-    S16   norm[FSE_original_MAX_SYMBOL_VALUE+1];
-    CTable_max_t ct;
+    U32* const count = (U32*)workSpace;
+    S16* const norm = (S16*)(void*)(count + (FSE_original_MAX_SYMBOL_VALUE+1));
+    U32* const scratch = count + ((FSE_original_MAX_SYMBOL_VALUE+1)*3/2);
+    size_t const scratchSize = wkspSize - ((FSE_original_MAX_SYMBOL_VALUE+1)*3/2) * sizeof(U32);
+    FSE_original_CTable* ct = scratch;
     size_t errorCode;
 
     /* init conditions */
+    if (((size_t)workSpace & 3) != 0) return ERROR(GENERIC);   /* must be aligned on 4-bytes boundaries */
+    if (wkspSize < FSE_original_WKSP_SIZE_U32(FSE_original_MIN_TABLELOG, 0) * sizeof(U32)) return ERROR(workSpace_tooSmall);
     if (srcSize <= 1) return 0;  /* Uncompressible */
     if (!maxSymbolValue) maxSymbolValue = FSE_original_MAX_SYMBOL_VALUE;
     if (!tableLog) tableLog = FSE_original_DEFAULT_TABLELOG;
 
     /* Scan input and build symbol stats */
-    errorCode = FSE_original_count (count, &maxSymbolValue, ip, srcSize);
+    errorCode = FSE_original_count_wksp (count, &maxSymbolValue, ip, srcSize, scratch);
     if (FSE_original_isError(errorCode)) return errorCode;
     if (errorCode == srcSize) return 1;
     //if (errorCode == 1) return 0;   /* each symbol only present once */
@@ -782,15 +1218,37 @@ size_t FSE_original_compress2 (void* dst, size_t dstSize, const void* src, size_
     /* Write table description header */
     errorCode = FSE_original_writeNCount (op, oend-op, norm, maxSymbolValue, tableLog);
     if (FSE_original_isError(errorCode)) return errorCode;
-    op += errorCode;
+
+    if (allowRepeat && repeat->valid
+      && FSE_original_repeatIsCheaper(repeat, count, maxSymbolValue, norm, tableLog, errorCode) ) {
+        /* re-use previous table : no new table to build */
+        *op++ = FSE_original_REPEAT_HEADER;
+        ct = repeat->CTable;
+        repeat = NULL;   /* nothing to save */
+    } else {
+        size_t const ctSize = FSE_original_CTABLE_SIZE_U32(tableLog, maxSymbolValue) * sizeof(U32);
+        op += errorCode;
+        if (ctSize > scratchSize) return ERROR(workSpace_tooSmall);
+        errorCode = FSE_original_buildCTable_wksp (ct, norm, maxSymbolValue, tableLog, (BYTE*)scratch + ctSize, scratchSize - ctSize);
+        if (FSE_original_isError(errorCode)) return errorCode;
+    }
 
     /* Compress */
-    errorCode = FSE_original_buildCTable (ct, norm, maxSymbolValue, tableLog);
+    errorCode = fourStreams ? FSE_original_compress4X_usingCTable(op, oend - op, ip, srcSize, ct) :
+                              FSE_original_compress_usingCTable(op, oend - op, ip, srcSize, ct);
     if (FSE_original_isError(errorCode)) return errorCode;
-    errorCode = FSE_original_compress_usingCTable(op, oend - op, ip, srcSize, ct);
     if (errorCode == 0) return 0;   /* not enough space for compressed data */
     op += errorCode;
 
+    /* save new table for next block */
+    if (repeat) {
+        memcpy(repeat->CTable, ct, FSE_original_CTABLE_SIZE_U32(tableLog, maxSymbolValue) * sizeof(U32));
+        memcpy(repeat->norm, norm, (maxSymbolValue+1) * sizeof(*norm));
+        repeat->maxSymbolValue = maxSymbolValue;
+        repeat->tableLog = tableLog;
+        repeat->valid = 1;
+    }
+
     /* check compressibility */
     /*if ( (size_t)(op-ostart) >= srcSize-1 )
         return 0;
@@ -798,10 +1256,77 @@ size_t FSE_original_compress2 (void* dst, size_t dstSize, const void* src, size_
     */return op-ostart;
 }
 
+size_t FSE_original_compress_wksp (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize)
+{
+    return FSE_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, 0, workSpace, wkspSize, NULL, 0);
+}
+
+size_t FSE_original_compress4X_wksp (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize)
+{
+    return FSE_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, 1, workSpace, wkspSize, NULL, 0);
+}
+
+size_t FSE_original_compress2 (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog)
+{
+    U32 workSpace[FSE_original_WKSP_SIZE_U32(FSE_original_MAX_TABLELOG, FSE_original_MAX_SYMBOL_VALUE)];
+    return FSE_original_compress_wksp(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, workSpace, sizeof(workSpace));
+}
+
+size_t FSE_original_compress4X (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog)
+{
+    U32 workSpace[FSE_original_WKSP_SIZE_U32(FSE_original_MAX_TABLELOG, FSE_original_MAX_SYMBOL_VALUE)];
+    return FSE_original_compress4X_wksp(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, workSpace, sizeof(workSpace));
+}
+
 size_t FSE_original_compress (void* dst, size_t dstSize, const void* src, size_t srcSize)
 {
     return FSE_original_compress2(dst, dstSize, src, (U32)srcSize, FSE_original_MAX_SYMBOL_VALUE, FSE_original_DEFAULT_TABLELOG);
 }
 
 
+
+/*-**************************************************************
+*  FSE Compression Context
+****************************************************************/
+struct FSE_original_CCtx_s {
+    U32 workSpace[FSE_original_WKSP_SIZE_U32(FSE_original_MAX_TABLELOG, FSE_original_MAX_SYMBOL_VALUE)];
+    FSE_original_repeat_t repeat;
+};
+
+FSE_original_CCtx* FSE_original_createCCtx(void)
+{
+    FSE_original_CCtx* const cctx = (FSE_original_CCtx*)malloc(sizeof(FSE_original_CCtx));
+    if (cctx) FSE_original_resetCCtx(cctx);
+    return cctx;
+}
+
+void FSE_original_freeCCtx(FSE_original_CCtx* cctx) { free(cctx); }
+
+void FSE_original_resetCCtx(FSE_original_CCtx* cctx) { cctx->repeat.valid = 0; }
+
+size_t FSE_original_compressCCtx (FSE_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog)
+{
+    return FSE_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, 0,
+                                 cctx->workSpace, sizeof(cctx->workSpace), &cctx->repeat, 0);
+}
+
+size_t FSE_original_compress4X_CCtx (FSE_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog)
+{
+    return FSE_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, 1,
+                                 cctx->workSpace, sizeof(cctx->workSpace), &cctx->repeat, 0);
+}
+
+size_t FSE_original_compressCCtx_repeat (FSE_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog)
+{
+    return FSE_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, 0,
+                                 cctx->workSpace, sizeof(cctx->workSpace), &cctx->repeat, 1);
+}
+
+size_t FSE_original_compress4X_CCtx_repeat (FSE_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog)
+{
+    return FSE_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, tableLog, 1,
+                                 cctx->workSpace, sizeof(cctx->workSpace), &cctx->repeat, 1);
+}
+
+
 #endif   /* FSE_original_COMMONDEFS_ONLY */
@@ -58,6 +58,7 @@
 #include <string.h>     /* memcpy, memset */
 #include <stdio.h>      /* printf (debug) */
 #include "bitstream.h"
+#include "cpu.h"        /* CPU_TARGET_ATTRIBUTE, CPU_bmi2 */
 #define FSE_original_STATIC_LINKING_ONLY
 #include "fse.h"
 
@@ -69,6 +70,37 @@
 #define FSE_original_STATIC_ASSERT(c) { enum { FSE_original_static_assert = 1/(int)(!!(c)) }; }   /* use only *after* variable declarations */
 
 
+/* **************************************************************
+*  Runtime dispatch
+****************************************************************/
+/* FSE_original_DGEN() :
+   generates fn##_internal() from FORCE_INLINE fn##_generic(), with one variant compiled for generic target,
+   and one for BMI2, selected at runtime. Each variant is specialized for `fast` and `padded`. */
+#define FSE_original_DGEN_ARGS void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize, const FSE_original_DTable* dt, unsigned padded
+#define FSE_original_DGEN_BODY(fn)                                                            \
+    {   const void* const ptr = dt;                                                           \
+        unsigned const fastMode = ((const FSE_original_DTableHeader*)ptr)->fastMode;           \
+        if (fastMode) {                                                                        \
+            if (padded) return fn##_generic(dst, dstSize, cSrc, cSrcSize, dt, 1, 1);           \
+            return fn##_generic(dst, dstSize, cSrc, cSrcSize, dt, 1, 0);                       \
+        }                                                                                      \
+        if (padded) return fn##_generic(dst, dstSize, cSrc, cSrcSize, dt, 0, 1);               \
+        return fn##_generic(dst, dstSize, cSrc, cSrcSize, dt, 0, 0); }
+
+#if CPU_TARGET_SUPPORT
+#  define FSE_original_DGEN(fn)                                                      \
+    static size_t fn##_default(FSE_original_DGEN_ARGS) FSE_original_DGEN_BODY(fn)    \
+    CPU_TARGET_ATTRIBUTE("bmi2")                                                     \
+    static size_t fn##_bmi2(FSE_original_DGEN_ARGS) FSE_original_DGEN_BODY(fn)       \
+    static size_t fn##_internal(FSE_original_DGEN_ARGS)                              \
+    {   if (CPU_bmi2()) return fn##_bmi2(dst, dstSize, cSrc, cSrcSize, dt, padded);  \
+        return fn##_default(dst, dstSize, cSrc, cSrcSize, dt, padded); }
+#else
+#  define FSE_original_DGEN(fn) \
+    static size_t fn##_internal(FSE_original_DGEN_ARGS) FSE_original_DGEN_BODY(fn)
+#endif
+
+
 /* **************************************************************
 *  Complex types
 ****************************************************************/
@@ -142,7 +174,35 @@ size_t FSE_original_buildDTable(FSE_original_DTable* dt, const short* normalized
     }
 
     /* Spread symbols */
-    {   U32 const tableMask = tableSize-1;
+    if ((sizeof(FSE_original_FUNCTION_TYPE)==1) && (highThreshold==tableSize-1) && (tableSize>=8)) {
+        /* Fast path : no lowprob symbol, so every position is visited.
+         * Symbols are first laid down sequentially, 8 at a time, then scattered with `step`. */
+        U32 const tableMask = tableSize-1;
+        U32 const step = FSE_original_TABLESTEP(tableSize);
+        BYTE spread[FSE_original_MAX_TABLESIZE + 8];
+        {   U64 const add = 0x0101010101010101ULL;
+            U64 sv = 0;
+            size_t pos = 0;
+            U32 s;
+            for (s=0; s<maxSV1; s++, sv += add) {
+                int const n = normalizedCounter[s];
+                int i;
+                if ((n < 0) || (pos + (size_t)n > tableSize)) return ERROR(GENERIC);
+                MEM_write64(spread + pos, sv);
+                for (i=8; i<n; i+=8) MEM_write64(spread + pos + i, sv);
+                pos += n;
+            }
+            if (pos!=tableSize) return ERROR(GENERIC);   /* normalizedCounter is incorrect */
+        }
+        {   U32 position = 0;
+            U32 s;
+            for (s=0; s<tableSize; s+=2) {   /* tableSize is a multiple of 2 */
+                tableDecode[position].symbol = (FSE_original_FUNCTION_TYPE)spread[s];
+                tableDecode[(position + step) & tableMask].symbol = (FSE_original_FUNCTION_TYPE)spread[s+1];
+                position = (position + 2*step) & tableMask;
+        }   }
+    } else {
+        U32 const tableMask = tableSize-1;
         U32 const step = FSE_original_TABLESTEP(tableSize);
         U32 s, position = 0;
         for (s=0; s<maxSV1; s++) {
@@ -219,15 +279,38 @@ size_t FSE_original_buildDTable_raw (FSE_original_DTable* dt, unsigned nbBits)
     return 0;
 }
 
+/* Fast loops run a nb of rounds determined upfront, from the distance to the beginning of the bitstream
+   and to the end of output, so that they can reload with BIT_reloadDStreamFast(), without status nor branch.
+   They require 4 symbols to always fit into bitContainer (static condition), and leave the end to checked loops. */
+#define FSE_original_FAST_ROUNDS(bitD) (FSE_original_MAX_TABLELOG*4+7 <= sizeof((bitD).bitContainer)*8)
+#define FSE_original_MIN(a,b) ((a)<(b) ? (a) : (b))
+
+/* FSE_original_nbFastReloads() :
+   nb of rounds `bitD` can run using BIT_reloadDStreamFast(), a round decoding 4 symbols of at most `tableLog` bits each */
+FORCE_INLINE size_t FSE_original_nbFastReloads(const BIT_DStream_t* bitD, U32 tableLog)
+{
+    if (tableLog==0) return (size_t)-1;   /* rle : no bit consumed */
+    return BIT_nbFastReloads(bitD, 4*tableLog);
+}
+
+/* FSE_original_nbFastRounds() :
+   same, while `op`, advancing by 4 per round, also stays < `olimit` at the beginning of each round */
+FORCE_INLINE size_t FSE_original_nbFastRounds(const BIT_DStream_t* bitD, U32 tableLog, const BYTE* op, const BYTE* olimit)
+{
+    size_t const nbReloads = FSE_original_nbFastReloads(bitD, tableLog);
+    size_t const nbWrites = (op < olimit) ? (size_t)(olimit - op + 3) / 4 : 0;
+    return FSE_original_MIN(nbReloads, nbWrites);
+}
+
 FORCE_INLINE size_t FSE_original_decompress_usingDTable_generic(
           void* dst, size_t maxDstSize,
     const void* cSrc, size_t cSrcSize,
-    const FSE_original_DTable* dt, const unsigned fast)
+    const FSE_original_DTable* dt, const unsigned fast, const unsigned padded)
 {
     BYTE* const ostart = (BYTE*) dst;
     BYTE* op = ostart;
     BYTE* const omax = op + maxDstSize;
-    BYTE* const olimit = omax-3;
+    BYTE* const olimit = padded ? omax : omax-3;   /* padded : last 4-symbols round may write up to 3 bytes beyond omax */
 
     BIT_DStream_t bitD;
     FSE_original_DState_t state1;
@@ -242,6 +325,22 @@ FORCE_INLINE size_t FSE_original_decompress_usingDTable_generic(
 
 #define FSE_original_GETSYMBOL(statePtr) fast ? FSE_original_decodeSymbolFast(statePtr, &bitD) : FSE_original_decodeSymbol(statePtr, &bitD)
 
+    /* fast loop : nb of rounds is determined upfront, so that reloads need no check */
+    if (FSE_original_FAST_ROUNDS(bitD) && (BIT_reloadDStream(&bitD)==BIT_DStream_unfinished)) {
+        const void* const ptr = dt;
+        U32 const tableLog = ((const FSE_original_DTableHeader*)ptr)->tableLog;
+        size_t nbRounds;
+        while ((nbRounds = FSE_original_nbFastRounds(&bitD, tableLog, op, olimit)) > 0) {
+            do {
+                op[0] = FSE_original_GETSYMBOL(&state1);
+                op[1] = FSE_original_GETSYMBOL(&state2);
+                op[2] = FSE_original_GETSYMBOL(&state1);
+                op[3] = FSE_original_GETSYMBOL(&state2);
+                BIT_reloadDStreamFast(&bitD);
+                op += 4;
+            } while (--nbRounds);
+    }   }
+
     /* 4 symbols per loop */
     for ( ; (BIT_reloadDStream(&bitD)==BIT_DStream_unfinished) && (op<olimit) ; op+=4) {
         op[0] = FSE_original_GETSYMBOL(&state1);
@@ -287,43 +386,378 @@ FORCE_INLINE size_t FSE_original_decompress_usingDTable_generic(
 }
 
 
+FSE_original_DGEN(FSE_original_decompress_usingDTable)
+
 size_t FSE_original_decompress_usingDTable(void* dst, size_t originalSize,
                             const void* cSrc, size_t cSrcSize,
                             const FSE_original_DTable* dt)
 {
-    const void* ptr = dt;
-    const FSE_original_DTableHeader* DTableH = (const FSE_original_DTableHeader*)ptr;
-    const U32 fastMode = DTableH->fastMode;
+    return FSE_original_decompress_usingDTable_internal(dst, originalSize, cSrc, cSrcSize, dt, 0);
+}
 
-    /* select fast mode (static) */
-    if (fastMode) return FSE_original_decompress_usingDTable_generic(dst, originalSize, cSrc, cSrcSize, dt, 1);
-    return FSE_original_decompress_usingDTable_generic(dst, originalSize, cSrc, cSrcSize, dt, 0);
+size_t FSE_original_decompress_usingDTable_withPadding(void* dst, size_t dstCapacity,
+                            const void* cSrc, size_t cSrcSize,
+                            const FSE_original_DTable* dt)
+{
+    return FSE_original_decompress_usingDTable_internal(dst, dstCapacity, cSrc, cSrcSize, dt, 1);
 }
 
 
-size_t FSE_original_decompress(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize)
+/*-*******************************************************
+*  4-streams decompression
+*********************************************************/
+#define FSE_original_DECODESYMBOL(statePtr, bitDPtr) (fast ? FSE_original_decodeSymbolFast(statePtr, bitDPtr) : FSE_original_decodeSymbol(statePtr, bitDPtr))
+
+/* decode remaining symbols of one stream, which must start with stateA */
+FORCE_INLINE size_t FSE_original_decodeStreamTail(BYTE* op, BYTE* const oend,
+                           BIT_DStream_t* bitD, FSE_original_DState_t* stateA, FSE_original_DState_t* stateB,
+                           const unsigned fast)
+{
+    while (op < oend) {
+        *op++ = FSE_original_DECODESYMBOL(stateA, bitD);
+        BIT_reloadDStream(bitD);
+        if (op == oend) break;
+        *op++ = FSE_original_DECODESYMBOL(stateB, bitD);
+        BIT_reloadDStream(bitD);
+    }
+
+    /* check stream has been entirely consumed */
+    if (BIT_reloadDStream(bitD) < BIT_DStream_completed) return ERROR(corruption_detected);
+    return 0;
+}
+
+/* FSE_original_readJumpEntry() :
+   jump table fields are 16 bits, or 32 bits for blocks larger than 128 KB */
+static size_t FSE_original_readJumpEntry(const void* p, size_t entrySize)
+{
+    return (entrySize==4) ? MEM_readLE32(p) : MEM_readLE16(p);
+}
+
+FORCE_INLINE size_t FSE_original_decompress4X_usingDTable_generic(
+          void* dst, size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const FSE_original_DTable* dt, const unsigned fast, const unsigned padded)
+{
+    size_t const entrySize = FSE_original_4X_JUMPTABLE_ENTRY_SIZE(dstSize);
+
+    /* Check */
+    if (cSrcSize < 3*entrySize + 4) return ERROR(corruption_detected);   /* strict minimum : jump table + 1 byte per stream */
+
+    {   const BYTE* const istart = (const BYTE*) cSrc;
+        BYTE* const ostart = (BYTE*) dst;
+        BYTE* const oend = ostart + dstSize;
+
+        /* Init */
+        size_t const length1 = FSE_original_readJumpEntry(istart, entrySize);
+        size_t const length2 = FSE_original_readJumpEntry(istart+entrySize, entrySize);
+        size_t const length3 = FSE_original_readJumpEntry(istart+2*entrySize, entrySize);
+        size_t const length4 = cSrcSize - (length1 + length2 + length3 + 3*entrySize);
+        const BYTE* const istart1 = istart + 3*entrySize;  /* jumpTable */
+        const BYTE* const istart2 = istart1 + length1;
+        const BYTE* const istart3 = istart2 + length2;
+        const BYTE* const istart4 = istart3 + length3;
+        size_t const segmentSize = (dstSize+3) / 4;
+        BYTE* const opStart2 = ostart + segmentSize;
+        BYTE* const opStart3 = opStart2 + segmentSize;
+        BYTE* const opStart4 = opStart3 + segmentSize;
+        BYTE* op1 = ostart;
+        BYTE* op2 = opStart2;
+        BYTE* op3 = opStart3;
+        BYTE* op4 = opStart4;
+        BIT_DStream_t bitD1, bitD2, bitD3, bitD4;
+        FSE_original_DState_t state1a, state1b, state2a, state2b, state3a, state3b, state4a, state4b;
+        BYTE* const olimit = padded ? oend : oend-3;   /* padded : last round may write up to 3 bytes beyond each segment */
+        U32 endSignal;
+
+        if ((length1 > cSrcSize) | (length2 > cSrcSize) | (length3 > cSrcSize)) return ERROR(corruption_detected);   /* prevents sum overflow */
+        if (length4 > cSrcSize) return ERROR(corruption_detected);   /* overflow */
+        if (opStart4 > oend) return ERROR(corruption_detected);      /* dstSize too small for 4 segments */
+        { size_t const errorCode = BIT_initDStream(&bitD1, istart1, length1);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = BIT_initDStream(&bitD2, istart2, length2);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = BIT_initDStream(&bitD3, istart3, length3);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = BIT_initDStream(&bitD4, istart4, length4);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+
+        FSE_original_initDState(&state1a, &bitD1, dt);
+        FSE_original_initDState(&state1b, &bitD1, dt);
+        FSE_original_initDState(&state2a, &bitD2, dt);
+        FSE_original_initDState(&state2b, &bitD2, dt);
+        FSE_original_initDState(&state3a, &bitD3, dt);
+        FSE_original_initDState(&state3b, &bitD3, dt);
+        FSE_original_initDState(&state4a, &bitD4, dt);
+        FSE_original_initDState(&state4b, &bitD4, dt);
+
+        /* 16 symbols per loop (4 per stream); segment 4 is the smallest one, hence the only one checked */
+        endSignal = BIT_reloadDStream(&bitD1) | BIT_reloadDStream(&bitD2) | BIT_reloadDStream(&bitD3) | BIT_reloadDStream(&bitD4);
+
+        /* fast loop : nb of rounds is determined upfront, so that reloads need no check */
+        if (FSE_original_FAST_ROUNDS(bitD1) && (endSignal==BIT_DStream_unfinished)) {
+            const void* const ptr = dt;
+            U32 const tableLog = ((const FSE_original_DTableHeader*)ptr)->tableLog;
+            for (;;) {
+                size_t const n12 = FSE_original_MIN(FSE_original_nbFastReloads(&bitD1, tableLog), FSE_original_nbFastReloads(&bitD2, tableLog));
+                size_t const n34 = FSE_original_MIN(FSE_original_nbFastReloads(&bitD3, tableLog), FSE_original_nbFastRounds(&bitD4, tableLog, op4, olimit));
+                size_t nbRounds = FSE_original_MIN(n12, n34);
+                if (nbRounds == 0) break;
+                do {
+                    op1[0] = FSE_original_DECODESYMBOL(&state1a, &bitD1);
+                    op2[0] = FSE_original_DECODESYMBOL(&state2a, &bitD2);
+                    op3[0] = FSE_original_DECODESYMBOL(&state3a, &bitD3);
+                    op4[0] = FSE_original_DECODESYMBOL(&state4a, &bitD4);
+                    op1[1] = FSE_original_DECODESYMBOL(&state1b, &bitD1);
+                    op2[1] = FSE_original_DECODESYMBOL(&state2b, &bitD2);
+                    op3[1] = FSE_original_DECODESYMBOL(&state3b, &bitD3);
+                    op4[1] = FSE_original_DECODESYMBOL(&state4b, &bitD4);
+                    op1[2] = FSE_original_DECODESYMBOL(&state1a, &bitD1);
+                    op2[2] = FSE_original_DECODESYMBOL(&state2a, &bitD2);
+                    op3[2] = FSE_original_DECODESYMBOL(&state3a, &bitD3);
+                    op4[2] = FSE_original_DECODESYMBOL(&state4a, &bitD4);
+                    op1[3] = FSE_original_DECODESYMBOL(&state1b, &bitD1);
+                    op2[3] = FSE_original_DECODESYMBOL(&state2b, &bitD2);
+                    op3[3] = FSE_original_DECODESYMBOL(&state3b, &bitD3);
+                    op4[3] = FSE_original_DECODESYMBOL(&state4b, &bitD4);
+                    op1+=4; op2+=4; op3+=4; op4+=4;
+                    BIT_reloadDStreamFast(&bitD1); BIT_reloadDStreamFast(&bitD2); BIT_reloadDStreamFast(&bitD3); BIT_reloadDStreamFast(&bitD4);
+                } while (--nbRounds);
+        }   }
+        while ((endSignal==BIT_DStream_unfinished) && (op4 < olimit)) {
+            op1[0] = FSE_original_DECODESYMBOL(&state1a, &bitD1);
+            op2[0] = FSE_original_DECODESYMBOL(&state2a, &bitD2);
+            op3[0] = FSE_original_DECODESYMBOL(&state3a, &bitD3);
+            op4[0] = FSE_original_DECODESYMBOL(&state4a, &bitD4);
+
+            if (FSE_original_MAX_TABLELOG*2+7 > sizeof(bitD1.bitContainer)*8) {   /* This test must be static */
+                BIT_reloadDStream(&bitD1); BIT_reloadDStream(&bitD2); BIT_reloadDStream(&bitD3); BIT_reloadDStream(&bitD4);
+            }
+
+            op1[1] = FSE_original_DECODESYMBOL(&state1b, &bitD1);
+            op2[1] = FSE_original_DECODESYMBOL(&state2b, &bitD2);
+            op3[1] = FSE_original_DECODESYMBOL(&state3b, &bitD3);
+            op4[1] = FSE_original_DECODESYMBOL(&state4b, &bitD4);
+
+            if (FSE_original_MAX_TABLELOG*4+7 > sizeof(bitD1.bitContainer)*8) {   /* This test must be static */
+                op1+=2; op2+=2; op3+=2; op4+=2;
+                endSignal = BIT_reloadDStream(&bitD1) | BIT_reloadDStream(&bitD2) | BIT_reloadDStream(&bitD3) | BIT_reloadDStream(&bitD4);
+                continue;   /* only 2 symbols per stream */
+            }
+
+            op1[2] = FSE_original_DECODESYMBOL(&state1a, &bitD1);
+            op2[2] = FSE_original_DECODESYMBOL(&state2a, &bitD2);
+            op3[2] = FSE_original_DECODESYMBOL(&state3a, &bitD3);
+            op4[2] = FSE_original_DECODESYMBOL(&state4a, &bitD4);
+
+            op1[3] = FSE_original_DECODESYMBOL(&state1b, &bitD1);
+            op2[3] = FSE_original_DECODESYMBOL(&state2b, &bitD2);
+            op3[3] = FSE_original_DECODESYMBOL(&state3b, &bitD3);
+            op4[3] = FSE_original_DECODESYMBOL(&state4b, &bitD4);
+
+            op1+=4; op2+=4; op3+=4; op4+=4;
+            endSignal = BIT_reloadDStream(&bitD1) | BIT_reloadDStream(&bitD2) | BIT_reloadDStream(&bitD3) | BIT_reloadDStream(&bitD4);
+        }
+
+        /* all streams progress at the same pace : they can only overrun their segment on corrupted input */
+        if (op4 > oend) return ERROR(corruption_detected);
+
+        /* tails : an even number of symbols has been decoded per stream, so each one resumes with its first state */
+        { size_t const errorCode = FSE_original_decodeStreamTail(op1, opStart2, &bitD1, &state1a, &state1b, fast);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = FSE_original_decodeStreamTail(op2, opStart3, &bitD2, &state2a, &state2b, fast);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = FSE_original_decodeStreamTail(op3, opStart4, &bitD3, &state3a, &state3b, fast);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = FSE_original_decodeStreamTail(op4, oend, &bitD4, &state4a, &state4b, fast);
+          if (FSE_original_isError(errorCode)) return errorCode; }
+
+        return dstSize;
+    }
+}
+
+
+FSE_original_DGEN(FSE_original_decompress4X_usingDTable)
+
+size_t FSE_original_decompress4X_usingDTable(void* dst, size_t originalSize,
+                              const void* cSrc, size_t cSrcSize,
+                              const FSE_original_DTable* dt)
+{
+    return FSE_original_decompress4X_usingDTable_internal(dst, originalSize, cSrc, cSrcSize, dt, 0);
+}
+
+size_t FSE_original_decompress4X_usingDTable_withPadding(void* dst, size_t originalSize,
+                              const void* cSrc, size_t cSrcSize,
+                              const FSE_original_DTable* dt)
+{
+    return FSE_original_decompress4X_usingDTable_internal(dst, originalSize, cSrc, cSrcSize, dt, 1);
+}
+
+
+/*-*******************************************************
+*  Decompression context
+*********************************************************/
+#define FSE_original_DCTX_TABLES_MAX 64
+
+typedef struct {
+    DTable_max_t dt;
+    BYTE header[FSE_original_NCOUNTBOUND];   /* raw header bytes which generated `dt` */
+    U32 headerSize;   /* 0 : empty entry */
+    U32 hash;
+    U32 lastUse;
+} FSE_original_DTableEntry;
+
+struct FSE_original_DCtx_s {
+    U32 nbTables;
+    U32 useCount;    /* LRU time stamp */
+    U32 prevTable;   /* table of previous block */
+    U32 hasTable;    /* prevTable is valid */
+    U64 hits;
+    U64 misses;
+    FSE_original_DTableEntry tables[1];   /* `nbTables` entries */
+};
+
+FSE_original_DCtx* FSE_original_createDCtx_advanced(unsigned nbTables)
+{
+    FSE_original_DCtx* dctx;
+    if (nbTables==0) nbTables = 1;
+    if (nbTables > FSE_original_DCTX_TABLES_MAX) nbTables = FSE_original_DCTX_TABLES_MAX;
+    dctx = (FSE_original_DCtx*)malloc(sizeof(FSE_original_DCtx) + (nbTables-1) * sizeof(FSE_original_DTableEntry));
+    if (dctx==NULL) return NULL;
+    dctx->nbTables = nbTables;
+    FSE_original_resetDCtx(dctx);
+    return dctx;
+}
+
+FSE_original_DCtx* FSE_original_createDCtx(void) { return FSE_original_createDCtx_advanced(1); }
+
+void FSE_original_freeDCtx(FSE_original_DCtx* dctx) { free(dctx); }
+
+void FSE_original_resetDCtx(FSE_original_DCtx* dctx)
+{
+    U32 n;
+    for (n=0; n<dctx->nbTables; n++) dctx->tables[n].headerSize = 0;
+    dctx->useCount = 0;
+    dctx->hasTable = 0;
+    dctx->hits = 0;
+    dctx->misses = 0;
+}
+
+void FSE_original_getDCtxCacheStats(const FSE_original_DCtx* dctx, unsigned long long* hits, unsigned long long* misses)
+{
+    *hits = dctx->hits;
+    *misses = dctx->misses;
+}
+
+static U32 FSE_original_hashHeader(const BYTE* p, size_t size)
+{
+    U32 h = 2166136261U;   /* FNV-1a */
+    size_t n;
+    for (n=0; n<size; n++) h = (h ^ p[n]) * 16777619U;
+    return h;
+}
+
+/* FSE_original_DCtx_getTable() :
+   finds table generated by header `hSize` first bytes of `header` within cache, or builds it into least recently used entry.
+   @return : index of table, or an errorCode */
+static size_t FSE_original_DCtx_getTable(FSE_original_DCtx* dctx, const BYTE* header, size_t hSize,
+                                const short* normalizedCounter, unsigned maxSymbolValue, unsigned tableLog)
+{
+    U32 const hash = FSE_original_hashHeader(header, hSize);
+    U32 n, victim = 0, emptyFound = 0;
+
+    dctx->hasTable = 0;
+    for (n=0; n<dctx->nbTables; n++) {
+        FSE_original_DTableEntry* const entry = dctx->tables + n;
+        if (entry->headerSize == 0) {
+            if (!emptyFound) { victim = n; emptyFound = 1; }
+            continue;
+        }
+        if ( (entry->headerSize == hSize) && (entry->hash == hash)
+          && !memcmp(entry->header, header, hSize) ) {
+            dctx->hits++;
+            entry->lastUse = ++dctx->useCount;
+            dctx->prevTable = n; dctx->hasTable = 1;
+            return n;
+        }
+        if (!emptyFound && (entry->lastUse < dctx->tables[victim].lastUse)) victim = n;
+    }
+
+    dctx->misses++;
+    {   FSE_original_DTableEntry* const entry = dctx->tables + victim;
+        size_t const errorCode = FSE_original_buildDTable (entry->dt, normalizedCounter, maxSymbolValue, tableLog);
+        entry->headerSize = 0;
+        if (FSE_original_isError(errorCode)) return errorCode;
+        if (hSize > sizeof(entry->header)) return victim;   /* can't be cached (should not happen) */
+        memcpy(entry->header, header, hSize);
+        entry->headerSize = (U32)hSize;
+        entry->hash = hash;
+        entry->lastUse = ++dctx->useCount;
+    }
+    dctx->prevTable = victim; dctx->hasTable = 1;
+    return victim;
+}
+
+
+/* FSE_original_decompress_internal() :
+   reads table header, and builds decoding table into stack, or finds it within `dctx` when provided.
+   With `dctx`, a block starting with FSE_original_REPEAT_HEADER re-uses table of previous block. */
+static size_t FSE_original_decompress_internal(void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize, unsigned fourStreams,
+                                      FSE_original_DCtx* dctx)
 {
     const BYTE* const istart = (const BYTE*)cSrc;
     const BYTE* ip = istart;
     short counting[FSE_original_MAX_SYMBOL_VALUE+1];
-    DTable_max_t dt;   /* Static analyzer seems unable to understand this table will be properly initialized later */
+    DTable_max_t localDT;   /* Static analyzer seems unable to understand this table will be properly initialized later */
+    const FSE_original_DTable* dt = localDT;
     unsigned tableLog;
     unsigned maxSymbolValue = FSE_original_MAX_SYMBOL_VALUE;
 
     if (cSrcSize<2) return ERROR(srcSize_wrong);   /* too small input size */
 
-    /* normal FSE decoding mode */
-    {   size_t const NCountLength = FSE_original_readNCount (counting, &maxSymbolValue, &tableLog, istart, cSrcSize);
+    if ((dctx != NULL) && (istart[0] == FSE_original_REPEAT_HEADER)) {
+        /* re-use previous table */
+        if (!dctx->hasTable) return ERROR(corruption_detected);
+        dt = dctx->tables[dctx->prevTable].dt;
+        ip++; cSrcSize--;
+    } else {
+        /* normal FSE decoding mode */
+        size_t const NCountLength = FSE_original_readNCount (counting, &maxSymbolValue, &tableLog, istart, cSrcSize);
         if (FSE_original_isError(NCountLength)) return NCountLength;
         if (NCountLength >= cSrcSize) return ERROR(srcSize_wrong);   /* too small input size */
         ip += NCountLength;
         cSrcSize -= NCountLength;
-    }
 
-    { size_t const errorCode = FSE_original_buildDTable (dt, counting, maxSymbolValue, tableLog);
-      if (FSE_original_isError(errorCode)) return errorCode; }
+        if (dctx == NULL) {
+            size_t const errorCode = FSE_original_buildDTable (localDT, counting, maxSymbolValue, tableLog);
+            if (FSE_original_isError(errorCode)) return errorCode;
+        } else {
+            size_t const tableNb = FSE_original_DCtx_getTable(dctx, istart, NCountLength, counting, maxSymbolValue, tableLog);
+            if (FSE_original_isError(tableNb)) return tableNb;
+            dt = dctx->tables[tableNb].dt;
+    }   }
+
+    if (fourStreams) return FSE_original_decompress4X_usingDTable (dst, dstSize, ip, cSrcSize, dt);
+    return FSE_original_decompress_usingDTable (dst, dstSize, ip, cSrcSize, dt);   /* always return, even if it is an error code */
+}
+
+size_t FSE_original_decompress(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize)
+{
+    return FSE_original_decompress_internal(dst, maxDstSize, cSrc, cSrcSize, 0, NULL);
+}
+
+size_t FSE_original_decompress4X(void* dst, size_t originalSize, const void* cSrc, size_t cSrcSize)
+{
+    return FSE_original_decompress_internal(dst, originalSize, cSrc, cSrcSize, 1, NULL);
+}
+
+size_t FSE_original_decompressDCtx(FSE_original_DCtx* dctx, void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize)
+{
+    return FSE_original_decompress_internal(dst, maxDstSize, cSrc, cSrcSize, 0, dctx);
+}
 
-    return FSE_original_decompress_usingDTable (dst, maxDstSize, ip, cSrcSize, dt);   /* always return, even if it is an error code */
+size_t FSE_original_decompress4X_DCtx(FSE_original_DCtx* dctx, void* dst, size_t originalSize, const void* cSrc, size_t cSrcSize)
+{
+    return FSE_original_decompress_internal(dst, originalSize, cSrc, cSrcSize, 1, dctx);
 }
 
 
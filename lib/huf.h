@@ -120,6 +120,14 @@ size_t HUF_original_compress2 (void* dst, size_t dstSize, const void* src, size_
     U32 name##hb[maxSymbolValue+1]; \
     void* name##hv = &(name##hb); \
     HUF_original_CElt* name = (HUF_original_CElt*)(name##hv)   /* no final ; */
+#define HUF_original_CTABLE_SIZE(maxSymbolValue) (((maxSymbolValue)+1) * sizeof(U32))   /* in bytes */
+
+/* scratch memory for HUF_original_compress*_wksp() functions */
+#define HUF_original_WORKSPACE_SIZE (16 << 10)
+#define HUF_original_WORKSPACE_SIZE_U32 (HUF_original_WORKSPACE_SIZE / sizeof(U32))
+#define HUF_original_PAIRTABLE_SIZE_U32 (1 << 16)   /* symbol pairs encoding table : one entry per pair of byte values */
+#define HUF_original_WORKSPACE_PAIRS_SIZE (HUF_original_WORKSPACE_SIZE + HUF_original_PAIRTABLE_SIZE_U32 * sizeof(U32))
+#define HUF_original_BUILDCTABLE_WKSP_SIZE_U32 (2 * (2*HUF_original_SYMBOLVALUE_MAX+1 +1))   /* huffman nodes, 8 bytes each */
 
 /* static allocation of HUF's DTable */
 typedef U32 HUF_original_DTable;
@@ -128,6 +136,8 @@ typedef U32 HUF_original_DTable;
         HUF_original_DTable DTable[HUF_original_DTABLE_SIZE((maxTableLog)-1)] = { ((U32)((maxTableLog)-1)*0x1000001) }
 #define HUF_original_CREATE_STATIC_DTABLEX4(DTable, maxTableLog) \
         HUF_original_DTable DTable[HUF_original_DTABLE_SIZE(maxTableLog)] = { ((U32)(maxTableLog)*0x1000001) }
+#define HUF_original_CREATE_STATIC_DTABLEX6(DTable, maxTableLog) \
+        HUF_original_DTable DTable[HUF_original_DTABLE_SIZE(maxTableLog) * 3 / 2] = { ((U32)(maxTableLog)*0x1000001) }
 
 
 /* ****************************************
@@ -135,15 +145,18 @@ typedef U32 HUF_original_DTable;
 ******************************************/
 size_t HUF_original_decompress4X2 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< single-symbol decoder */
 size_t HUF_original_decompress4X4 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< double-symbols decoder */
+size_t HUF_original_decompress4X6 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< quad-symbols decoder */
 
 size_t HUF_original_decompress4X_DCtx (HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);
 size_t HUF_original_decompress4X_hufOnly(HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize); /**< considers RLE and uncompressed as errors */
 size_t HUF_original_decompress4X2_DCtx(HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< single-symbol decoder */
 size_t HUF_original_decompress4X4_DCtx(HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< double-symbols decoder */
+size_t HUF_original_decompress4X6_DCtx(HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< quad-symbols decoder, `dctx` must be created with HUF_original_CREATE_STATIC_DTABLEX6() */
 
 size_t HUF_original_decompress1X_DCtx (HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);
 size_t HUF_original_decompress1X2_DCtx(HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< single-symbol decoder */
 size_t HUF_original_decompress1X4_DCtx(HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< double-symbols decoder */
+size_t HUF_original_decompress1X6_DCtx(HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /**< quad-symbols decoder, `dctx` must be created with HUF_original_CREATE_STATIC_DTABLEX6() */
 
 
 /* ****************************************
@@ -168,6 +181,117 @@ size_t HUF_original_buildCTable (HUF_original_CElt* CTable, const unsigned* coun
 size_t HUF_original_writeCTable (void* dst, size_t maxDstSize, const HUF_original_CElt* CTable, unsigned maxSymbolValue, unsigned huffLog);
 size_t HUF_original_compress4X_usingCTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable);
 
+/** HUF_original_estimateCompressedSize() :
+*   Size of bitstream produced by HUF_original_compress1X_usingCTable() for a block of histogram `count`, without encoding it.
+*   Result is exact for single stream. 4-streams format (HUF_original_compress4X_usingCTable()) adds between 6 and 9 bytes.
+*   It doesn't include table header (see HUF_original_writeCTable()).
+*   @return : size in bytes, or an errorCode if `CTable` can't represent a symbol present in `count` */
+size_t HUF_original_estimateCompressedSize(const HUF_original_CElt* CTable, const unsigned* count, unsigned maxSymbolValue);
+
+/** HUF_original_buildCTable_wksp() :
+*   Same as HUF_original_buildCTable(), but using an externally provided scratch buffer.
+*   `workSpace` must be aligned on 4-bytes boundaries, and be at least HUF_original_BUILDCTABLE_WKSP_SIZE_U32 unsigned */
+size_t HUF_original_buildCTable_wksp (HUF_original_CElt* tree, const unsigned* count, unsigned maxSymbolValue, unsigned maxNbBits, void* workSpace, size_t wkspSize);
+
+
+/* ****************************************
+*  Compression context and workspace
+******************************************/
+/*!
+HUF_original_compress2() and HUF_original_compress1X() allocate their tables on stack, which requires ~20 KB of stack space.
+Below variants take all their scratch memory from a workspace, or from a context, provided by the caller,
+so that successive compressions don't use stack space, nor touch new memory pages.
+Compressed data is the same as HUF_original_compress2() and HUF_original_compress1X().
+*/
+size_t HUF_original_compress4X_wksp (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize);
+size_t HUF_original_compress1X_wksp (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize);
+/**< `workSpace` must be aligned on 4-bytes boundaries, and `wkspSize` must be >= HUF_original_WORKSPACE_SIZE.
+     With `wkspSize` >= HUF_original_WORKSPACE_PAIRS_SIZE, large enough inputs are encoded 2 symbols at a time (same output, faster).
+     Contexts always have this room. */
+
+typedef struct HUF_original_CCtx_s HUF_original_CCtx;   /* incomplete type */
+HUF_original_CCtx* HUF_original_createCCtx(void);
+void      HUF_original_freeCCtx(HUF_original_CCtx* cctx);
+
+size_t HUF_original_compress4X_CCtx (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+size_t HUF_original_compress1X_CCtx (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+/**< same as HUF_original_compress2() and HUF_original_compress1X(), using memory from `cctx`.
+     A context can be re-used for successive compressions, but must not be shared by concurrent threads. */
+
+
+/* ****************************************
+*  Table repeat mode
+******************************************/
+/*!
+In repeat mode, compressor may re-use the Huffman table of previous compressed block,
+when it's cheaper than sending a new one.
+Such block starts with the single byte HUF_original_REPEAT_HEADER instead of the weights header.
+Decoding requires HUF_original_decompress4X_DCtx() (or HUF_original_decompress1X_DCtx() for single stream),
+using the same `dctx` for all blocks, in the same order, so that it still contains previous block's table.
+`cctx` remembers the table of the last compressed block (result > 1).
+If such block is not sent, or when starting a new stream, use HUF_original_resetCCtx().
+On decoder side, a new stream starts with a freshly initialized `dctx` (see HUF_original_CREATE_STATIC_DTABLEX4()).
+*/
+#define HUF_original_REPEAT_HEADER 0   /* never starts a weights header */
+
+size_t HUF_original_compress4X_CCtx_repeat (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+size_t HUF_original_compress1X_CCtx_repeat (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+void   HUF_original_resetCCtx(HUF_original_CCtx* cctx);   /**< forget previous table : next block will not re-use it */
+
+/*!
+Same mode, with a table held by the caller, who can share it between blocks of a sequence, or provide a pre-built one.
+`hufTable` must be created with HUF_original_CREATE_STATIC_CTABLE(hufTable, HUF_original_SYMBOLVALUE_MAX).
+Symbols absent from `hufTable` are recognized by `nbBits==0`, and the check reads all entries up to HUF_original_SYMBOLVALUE_MAX.
+Tables saved by the compressor fulfill this condition. But HUF_original_buildCTable() doesn't write entries beyond its `maxSymbolValue` :
+a pre-built table must be zeroed before being built, using memset(hufTable, 0, HUF_original_CTABLE_SIZE(HUF_original_SYMBOLVALUE_MAX)).
+`*repeat` tells if `hufTable` can be re-used :
+- HUF_original_repeat_none : no, a new table is always sent.
+- HUF_original_repeat_check : yes, if it can represent all present symbols, and if its estimated cost (data + 1 byte marker)
+                     does not exceed the cost of a new table (header + data).
+- HUF_original_repeat_valid : `hufTable` is known to represent all symbols. With `preferRepeat`, it's used directly,
+                     skipping statistics, table construction and header : this is the fastest mode.
+When a new table is sent (result > 1), it's saved into `hufTable`, and `*repeat` becomes HUF_original_repeat_check.
+Otherwise, `hufTable` and `*repeat` are not modified.
+Decoding is the same as for HUF_original_compress4X_CCtx_repeat().
+For a pre-built `hufTable`, decoder's `dctx` must be loaded first, using HUF_original_readDTableX2() or HUF_original_readDTableX4()
+on the header written by HUF_original_writeCTable().
+*/
+typedef enum {
+    HUF_original_repeat_none,    /**< `hufTable` can't be re-used */
+    HUF_original_repeat_check,   /**< `hufTable` can be re-used, after checking it represents all present symbols */
+    HUF_original_repeat_valid    /**< `hufTable` represents all symbols, it can be re-used without check */
+} HUF_original_repeat;
+
+size_t HUF_original_compress4X_repeat (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog,
+                              void* workSpace, size_t wkspSize, HUF_original_CElt* hufTable, HUF_original_repeat* repeat, int preferRepeat);
+size_t HUF_original_compress1X_repeat (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog,
+                              void* workSpace, size_t wkspSize, HUF_original_CElt* hufTable, HUF_original_repeat* repeat, int preferRepeat);
+/**< `workSpace` : same as HUF_original_compress4X_wksp() */
+
+
+/* ****************************************
+*  Decoding table cache
+******************************************/
+/*!
+A cache keeps the decoding tables of the last `nbTables` different weights headers it decoded,
+identified by a hash of raw header bytes (bytes are compared too).
+Blocks with a header already present skip HUF_original_readDTableX2() / HUF_original_readDTableX4().
+Otherwise, the least recently used table is replaced.
+The cache also decodes blocks using table repeat mode, since it remembers the table of previous block.
+Each table costs ~16 KB.
+*/
+typedef struct HUF_original_DTableCache_s HUF_original_DTableCache;   /* incomplete type */
+HUF_original_DTableCache* HUF_original_createDTableCache(unsigned nbTables);   /**< `nbTables` : from 1 to 64 */
+void   HUF_original_freeDTableCache(HUF_original_DTableCache* cache);
+void   HUF_original_resetDTableCache(HUF_original_DTableCache* cache);   /**< forget all tables, and statistics */
+
+size_t HUF_original_decompress4X_usingDTableCache(HUF_original_DTableCache* cache, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);
+size_t HUF_original_decompress1X_usingDTableCache(HUF_original_DTableCache* cache, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);
+/**< same as HUF_original_decompress4X_DCtx() and HUF_original_decompress1X_DCtx() */
+
+void   HUF_original_getDTableCacheStats(const HUF_original_DTableCache* cache, unsigned long long* hits, unsigned long long* misses);
+/**< nb of headers found within cache (hits), and nb of tables built (misses), since creation or last reset */
+
 
 /*! HUF_original_readStats() :
     Read compact Huffman tree, saved by HUF_original_writeCTable().
@@ -185,24 +309,41 @@ size_t HUF_original_readCTable (HUF_original_CElt* CTable, unsigned maxSymbolVal
 
 /*
 HUF_original_decompress() does the following:
-1. select the decompression algorithm (X2, X4) based on pre-computed heuristics
+1. select the decompression algorithm (X2, X4, X6) based on pre-computed heuristics
 2. build Huffman table from save, using HUF_original_readDTableXn()
-3. decode 1 or 4 segments in parallel using HUF_original_decompressSXn_usingDTable
+3. decode 1, 4 or 8 segments in parallel using HUF_original_decompressSXn_usingDTable
 */
 
 /** HUF_original_selectDecoder() :
 *   Tells which decoder is likely to decode faster,
-*   based on a set of pre-determined metrics.
+*   based on a set of pre-determined metrics, or on a decoder profile (see below).
 *   @return : 0==HUF_original_decompress4X2, 1==HUF_original_decompress4X4 .
-*   Assumption : 0 < cSrcSize < dstSize <= 128 KB */
+*   Quad-symbols decoder is not a candidate, since its table doesn't fit into a `dctx` sized for X4 :
+*   only HUF_original_decompress(), which allocates its own table, may also select HUF_original_decompress4X6.
+*   Assumption : 0 < cSrcSize < dstSize <= HUF_original_LARGE_BLOCKSIZE_MAX */
 U32 HUF_original_selectDecoder (size_t dstSize, size_t cSrcSize);
 
+/*! Decoder profile :
+    Built-in metrics were measured on a single machine, and may select the slower decoder elsewhere.
+    HUF_original_calibrateDecoders() measures X2, X4 and X6 table building and decoding speed on current host (~0.5 s),
+    and makes HUF_original_selectDecoder() use these timings for the rest of the process.
+    It's defined in huf_calibrate.c, which also requires huf_compress.c to generate its samples.
+    Result can be saved with HUF_original_saveDecoderProfile(), and loaded in later processes, to skip calibration.
+    Profile is process-wide : load it before decoding starts, never while other threads decode. */
+#define HUF_original_DECODER_PROFILE_SIZE (4 + 16*3*8)
+size_t HUF_original_calibrateDecoders(void);   /**< @return : 0, or an error code */
+size_t HUF_original_saveDecoderProfile(void* dst, size_t dstCapacity);   /**< saves timings in use. @return : HUF_original_DECODER_PROFILE_SIZE, or an error code */
+size_t HUF_original_loadDecoderProfile(const void* src, size_t srcSize);   /**< @return : 0, or an error code if `src` is not a valid profile (timings in use are then unchanged) */
+void   HUF_original_resetDecoderProfile(void);   /**< back to built-in metrics */
+
 size_t HUF_original_readDTableX2 (HUF_original_DTable* DTable, const void* src, size_t srcSize);
 size_t HUF_original_readDTableX4 (HUF_original_DTable* DTable, const void* src, size_t srcSize);
+size_t HUF_original_readDTableX6 (HUF_original_DTable* DTable, const void* src, size_t srcSize);
 
 size_t HUF_original_decompress4X_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
 size_t HUF_original_decompress4X2_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
 size_t HUF_original_decompress4X4_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
+size_t HUF_original_decompress4X6_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
 
 
 /* single stream variants */
@@ -212,10 +353,57 @@ size_t HUF_original_compress1X_usingCTable(void* dst, size_t dstSize, const void
 
 size_t HUF_original_decompress1X2 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /* single-symbol decoder */
 size_t HUF_original_decompress1X4 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /* double-symbol decoder */
+size_t HUF_original_decompress1X6 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize);   /* quad-symbol decoder */
 
 size_t HUF_original_decompress1X_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
 size_t HUF_original_decompress1X2_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
 size_t HUF_original_decompress1X4_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
+size_t HUF_original_decompress1X6_usingDTable(void* dst, size_t maxDstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
+
+/* 8 streams variants */
+
+size_t HUF_original_compress8X (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+size_t HUF_original_compress8X_wksp (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize);
+size_t HUF_original_compress8X_usingCTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable);
+/**< same as HUF_original_compress2(), HUF_original_compress4X_wksp() and HUF_original_compress4X_usingCTable(),
+     but source is cut into 8 segments, giving more independent work to wide cores during decoding.
+     Jump table is 16 bytes instead of 6. Inputs < 64 bytes are not compressed.
+     There is no specific decoder : all 4-streams decoders recognize 8-streams blocks from their jump table. */
+
+/* large blocks */
+#define HUF_original_LARGE_BLOCKSIZE_MAX (64 << 20)
+#define HUF_original_JUMPTABLE_ENTRY_SIZE(blockSize) (((blockSize) > HUF_original_BLOCKSIZE_MAX) ? 4 : 2)   /* bytes per jump table field */
+
+size_t HUF_original_compress4X_large (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog);
+size_t HUF_original_compress4X_large_wksp (void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned tableLog, void* workSpace, size_t wkspSize);
+/**< same as HUF_original_compress2() and HUF_original_compress4X_wksp(), but `srcSize` can be up to HUF_original_LARGE_BLOCKSIZE_MAX,
+     so that a large input with stable statistics pays for a single table header.
+     Blocks > HUF_original_BLOCKSIZE_MAX store jump table fields on 32 bits (4X : 12 bytes, 8X : 32 bytes).
+     Since regenerated size must be known exactly, decoders tell the format from `dstSize` :
+     all 4-streams decoding functions accept large blocks, no specific decoder is needed.
+     HUF_original_compress4X_usingCTable() and HUF_original_compress8X_usingCTable() select the format the same way. */
+
+/* symbol pairs encoding */
+size_t HUF_original_buildPairTable(U32* pairTable, const HUF_original_CElt* CTable, unsigned maxSymbolValue);
+/**< builds a table of concatenated codes for each pair of symbols <= `maxSymbolValue` from `CTable`.
+     `pairTable` must be HUF_original_PAIRTABLE_SIZE_U32 unsigned large.
+     @return : 0, or an error code */
+
+size_t HUF_original_compress1X_usingPairTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable, const U32* pairTable);
+size_t HUF_original_compress4X_usingPairTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable, const U32* pairTable);
+/**< same as HUF_original_compress1X_usingCTable() and HUF_original_compress4X_usingCTable(), with identical output,
+     but symbols are encoded 2 by 2, with a single table lookup per pair.
+     `pairTable` must be built from `CTable`. */
+
+/* padded destination */
+#define HUF_original_DECODE_PADDING 8   /* bytes which may be written beyond `dst + dstSize` by *_withPadding() variants */
+
+size_t HUF_original_decompress4X_usingDTable_withPadding(void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
+size_t HUF_original_decompress1X_usingDTable_withPadding(void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable);
+/**< same as HUF_original_decompress4X_usingDTable() and HUF_original_decompress1X_usingDTable(),
+     but `dst` must be writable up to `dstSize + HUF_original_DECODE_PADDING` bytes.
+     Fast loops then run up to the end of each segment, leaving less work to the careful tail loops.
+     Content of padding bytes is undefined after the call. */
 
 
 #endif /* HUF_original_STATIC_LINKING_ONLY */
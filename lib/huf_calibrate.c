@@ -0,0 +1,207 @@
+/* ******************************************************************
+   Huffman decoder calibration, part of New Generation Entropy library
+   Copyright (C) 2013-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    You can contact the author at :
+    - FSE+HUF source repository : https://github.com/Cyan4973/FiniteStateEntropy
+    - Public forum : https://groups.google.com/forum/#!forum/lz4c
+****************************************************************** */
+
+/* **************************************************************
+*  Includes
+****************************************************************/
+#include <stdlib.h>     /* malloc, free */
+#include <string.h>     /* memcpy */
+#include <time.h>       /* clock */
+#include "mem.h"
+#include "error_private.h"
+#define HUF_original_STATIC_LINKING_ONLY
+#include "huf.h"
+
+
+/* **************************************************************
+*  Constants
+****************************************************************/
+#define HUF_original_CALIB_SAMPLESIZE (32 * 1024)
+#define HUF_original_CALIB_MINTIME    (CLOCKS_PER_SEC / 250)   /* 4 ms per measurement */
+#define HUF_original_CALIB_NBROUNDS   2                        /* keep best */
+
+
+/* **************************************************************
+*  Sample generation
+****************************************************************/
+static U32 HUF_original_calibRand(U32* seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/* HUF_original_generateSample() :
+   geometric distribution : each symbol takes `p/4096` of remaining probability.
+   Large `p` generates highly compressible samples, small `p` almost random ones. */
+static void HUF_original_generateSample(BYTE* buffer, size_t size, U32 p, U32* seed)
+{
+    BYTE table[4096];
+    U32 remaining = 4096, pos = 0, s = 0;
+    size_t i;
+
+    while (remaining) {
+        U32 n = (s==255) ? remaining : (remaining * p) >> 12;
+        if (!n) n = 1;
+        remaining -= n;
+        while (n--) table[pos++] = (BYTE)s;
+        s++;
+    }
+
+    for (i=0; i<size; i++) buffer[i] = table[HUF_original_calibRand(seed) & 4095];
+}
+
+
+/* **************************************************************
+*  Measurements
+****************************************************************/
+/* HUF_original_runOnce() :
+   what : 0 = readDTableX2, 1 = decode X2, 2 = readDTableX4, 3 = decode X4, 4 = readDTableX6, 5 = decode X6.
+   Decoders expect `dt` to be already filled with the corresponding table. */
+static size_t HUF_original_runOnce(U32 what, HUF_original_DTable* dt, void* dst, size_t dstSize,
+                          const BYTE* cSrc, size_t cSize, size_t hSize)
+{
+    switch(what)
+    {
+    case 0 : return HUF_original_readDTableX2(dt, cSrc, cSize);
+    case 1 : return HUF_original_decompress4X2_usingDTable(dst, dstSize, cSrc+hSize, cSize-hSize, dt);
+    case 2 : return HUF_original_readDTableX4(dt, cSrc, cSize);
+    case 3 : return HUF_original_decompress4X4_usingDTable(dst, dstSize, cSrc+hSize, cSize-hSize, dt);
+    case 4 : return HUF_original_readDTableX6(dt, cSrc, cSize);
+    default: return HUF_original_decompress4X6_usingDTable(dst, dstSize, cSrc+hSize, cSize-hSize, dt);
+    }
+}
+
+/* HUF_original_timeRun() :
+   @return : nanoseconds per run (best of HUF_original_CALIB_NBROUNDS), or 0 if run fails */
+static U32 HUF_original_timeRun(U32 what, HUF_original_DTable* dt, void* dst, size_t dstSize,
+                       const BYTE* cSrc, size_t cSize, size_t hSize)
+{
+    U64 best = (U64)-1;
+    U32 round;
+    for (round=0; round<HUF_original_CALIB_NBROUNDS; round++) {
+        U32 nbRuns = 1;
+        while (1) {
+            clock_t const start = clock();
+            clock_t elapsed;
+            U32 r;
+            for (r=0; r<nbRuns; r++)
+                if (HUF_original_isError(HUF_original_runOnce(what, dt, dst, dstSize, cSrc, cSize, hSize))) return 0;
+            elapsed = clock() - start;
+            if (elapsed >= HUF_original_CALIB_MINTIME) {
+                U64 const ns = ((U64)elapsed * 1000000000ULL / CLOCKS_PER_SEC) / nbRuns;
+                if (ns < best) best = ns;
+                break;
+            }
+            nbRuns *= 2;
+    }   }
+    if (best == 0) best = 1;
+    return (best > 0xFFFFFFFF) ? 0xFFFFFFFF : (U32)best;
+}
+
+
+/* **************************************************************
+*  Calibration
+****************************************************************/
+size_t HUF_original_calibrateDecoders(void)
+{
+    size_t const sampleSize = HUF_original_CALIB_SAMPLESIZE;
+    BYTE* const sample = (BYTE*)malloc(sampleSize);
+    BYTE* const cSample = (BYTE*)malloc(HUF_original_COMPRESSBOUND(sampleSize));
+    BYTE* const dst = (BYTE*)malloc(sampleSize);
+    U32* const workSpace = (U32*)malloc(HUF_original_WORKSPACE_SIZE);
+    U32 timing[16][3][2];   /* [Q][X2,X4,X6][tableTime, decode256Time] */
+    U32 measured[16] = { 0 };
+    BYTE profile[HUF_original_DECODER_PROFILE_SIZE];
+    U32 seed = 1, p, q;
+    size_t result = ERROR(GENERIC);
+    HUF_original_CREATE_STATIC_DTABLEX6(dt, HUF_original_TABLELOG_MAX);   /* large enough for all table types */
+
+    if (!sample || !cSample || !dst || !workSpace) goto _end;
+
+    /* sweep from highly compressible to almost random samples */
+    for (p=4000; p>=4; p = p*7/8) {
+        HUF_original_generateSample(sample, sampleSize, p, &seed);
+        {   size_t const cs = HUF_original_compress4X_wksp(cSample, HUF_original_COMPRESSBOUND(sampleSize), sample, sampleSize,
+                                                  255, HUF_original_TABLELOG_DEFAULT, workSpace, HUF_original_WORKSPACE_SIZE);
+            U32 a;
+            if (HUF_original_isError(cs) || (cs <= 1)) continue;   /* not compressible, or rle */
+            q = (U32)(cs * 16 / sampleSize);
+            if (measured[q]) continue;
+            for (a=0; a<3; a++) {
+                size_t const hSize = HUF_original_runOnce(2*a, dt, dst, sampleSize, cSample, cs, 0);   /* read table */
+                U32 tableTime, decodeTime;
+                if (HUF_original_isError(hSize)) goto _end;
+                tableTime = HUF_original_timeRun(2*a, dt, dst, sampleSize, cSample, cs, hSize);
+                decodeTime = HUF_original_timeRun(2*a+1, dt, dst, sampleSize, cSample, cs, hSize);
+                if (!tableTime || !decodeTime) goto _end;
+                timing[q][a][0] = tableTime;
+                timing[q][a][1] = (U32)(((U64)decodeTime * 256) / sampleSize);
+                if (timing[q][a][1] == 0) timing[q][a][1] = 1;
+            }
+            measured[q] = 1;
+    }   }
+
+    /* unmeasured quantization levels : copy closest measured one, preferring lower levels */
+    for (q=0; q<16; q++) {
+        if (!measured[q]) {
+            int d;
+            for (d=1; d<16; d++) {
+                if ((int)q-d >= 0 && measured[q-d] == 1) { memcpy(timing[q], timing[q-d], sizeof(timing[q])); break; }
+                if (q+d < 16 && measured[q+d] == 1) { memcpy(timing[q], timing[q+d], sizeof(timing[q])); break; }
+            }
+            if (d==16) goto _end;   /* nothing measured */
+            measured[q] = 2;   /* filled, not measured */
+    }   }
+
+    /* write profile (same layout as HUF_original_saveDecoderProfile()), then load it */
+    {   size_t const pSize = HUF_original_saveDecoderProfile(profile, sizeof(profile));   /* provides header */
+        BYTE* op = profile + 4;
+        if (HUF_original_isError(pSize)) { result = pSize; goto _end; }
+        for (q=0; q<16; q++) {
+            U32 a;
+            for (a=0; a<3; a++) {
+                MEM_writeLE32(op, timing[q][a][0]);
+                MEM_writeLE32(op+4, timing[q][a][1]);
+                op += 8;
+        }   }
+        result = HUF_original_loadDecoderProfile(profile, pSize);
+    }
+
+_end:
+    free(sample);
+    free(cSample);
+    free(dst);
+    free(workSpace);
+    return result;
+}
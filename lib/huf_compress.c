@@ -59,10 +59,12 @@
 /* **************************************************************
 *  Includes
 ****************************************************************/
-#include <string.h>     /* memcpy, memset */
+#include <stdlib.h>     /* malloc, free */
+#include <string.h>     /* memcpy, memmove, memset */
 #include <stdio.h>      /* printf (debug) */
 #include "bitstream.h"
-#define FSE_original_STATIC_LINKING_ONLY   /* FSE_original_optimalTableLog_internal */
+#include "cpu.h"        /* CPU_TARGET_ATTRIBUTE, CPU_bmi2 */
+#define FSE_original_STATIC_LINKING_ONLY   /* FSE_original_optimalTableLog_internal, FSE_original_compress_wksp */
 #include "fse.h"        /* header compression */
 #define HUF_original_STATIC_LINKING_ONLY
 #include "huf.h"
@@ -74,6 +76,31 @@
 #define HUF_original_STATIC_ASSERT(c) { enum { HUF_original_static_assert = 1/(int)(!!(c)) }; }   /* use only *after* variable declarations */
 
 
+/* **************************************************************
+*  Runtime dispatch
+****************************************************************/
+/* HUF_original_CGEN() :
+   generates fn##_internal() from FORCE_INLINE fn##_body(), with one variant compiled for generic target,
+   and one for BMI2, selected at runtime. Each variant is specialized for the presence of `pairTable`. */
+#define HUF_original_CGEN_ARGS void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable, const U32* pairTable
+#define HUF_original_CGEN_BODY(fn)                                                      \
+    {   if (pairTable) return fn##_body(dst, dstSize, src, srcSize, CTable, pairTable);  \
+        return fn##_body(dst, dstSize, src, srcSize, CTable, NULL); }
+
+#if CPU_TARGET_SUPPORT
+#  define HUF_original_CGEN(fn)                                                      \
+    static size_t fn##_default(HUF_original_CGEN_ARGS) HUF_original_CGEN_BODY(fn)    \
+    CPU_TARGET_ATTRIBUTE("bmi2")                                                     \
+    static size_t fn##_bmi2(HUF_original_CGEN_ARGS) HUF_original_CGEN_BODY(fn)       \
+    static size_t fn##_internal(HUF_original_CGEN_ARGS)                              \
+    {   if (CPU_bmi2()) return fn##_bmi2(dst, dstSize, src, srcSize, CTable, pairTable); \
+        return fn##_default(dst, dstSize, src, srcSize, CTable, pairTable); }
+#else
+#  define HUF_original_CGEN(fn) \
+    static size_t fn##_internal(HUF_original_CGEN_ARGS) HUF_original_CGEN_BODY(fn)
+#endif
+
+
 /* **************************************************************
 *  Utils
 ****************************************************************/
@@ -98,11 +125,16 @@ typedef struct nodeElt_s {
     BYTE nbBits;
 } nodeElt;
 
-/*! HUF_original_writeCTable() :
-    `CTable` : huffman tree to save, using huf representation.
-    @return : size of saved CTable */
-size_t HUF_original_writeCTable (void* dst, size_t maxDstSize,
-                        const HUF_original_CElt* CTable, U32 maxSymbolValue, U32 huffLog)
+typedef nodeElt huffNodeTable[2*HUF_original_SYMBOLVALUE_MAX+1 +1];
+
+#define HUF_original_WEIGHTS_FSELOG 6   /* weights header (<= 255 bytes, values <= HUF_original_TABLELOG_MAX) never uses a larger FSE table */
+
+/*! HUF_original_writeCTable_wksp() :
+    `workSpace` is used to compress weights with FSE,
+    its size must be >= FSE_original_WKSP_SIZE_U32(HUF_original_WEIGHTS_FSELOG, HUF_original_TABLELOG_MAX) unsigned. */
+static size_t HUF_original_writeCTable_wksp (void* dst, size_t maxDstSize,
+                        const HUF_original_CElt* CTable, U32 maxSymbolValue, U32 huffLog,
+                        void* workSpace, size_t wkspSize)
 {
     BYTE bitsToWeight[HUF_original_TABLELOG_MAX + 1];
     BYTE huffWeight[HUF_original_SYMBOLVALUE_MAX + 1];
@@ -121,7 +153,8 @@ size_t HUF_original_writeCTable (void* dst, size_t maxDstSize,
     for (n=0; n<maxSymbolValue; n++)
         huffWeight[n] = bitsToWeight[CTable[n].nbBits];
 
-    size = FSE_original_compress(op+1, maxDstSize-1, huffWeight, maxSymbolValue);   /* don't need last symbol stat : implied */
+    size = FSE_original_compress_wksp(op+1, maxDstSize-1, huffWeight, maxSymbolValue,   /* don't need last symbol stat : implied */
+                             FSE_original_MAX_SYMBOL_VALUE, FSE_original_DEFAULT_TABLELOG, workSpace, wkspSize);   /* same parameters as FSE_original_compress() */
     if (HUF_original_isError(size)) return size;
     if (size >= 128) return ERROR(GENERIC);   /* should never happen, since maxSymbolValue <= 255 */
     if ((size <= 1) || (size >= maxSymbolValue/2)) {
@@ -165,6 +198,16 @@ size_t HUF_original_writeCTable (void* dst, size_t maxDstSize,
     return size+1;
 }
 
+/*! HUF_original_writeCTable() :
+    `CTable` : huffman tree to save, using huf representation.
+    @return : size of saved CTable */
+size_t HUF_original_writeCTable (void* dst, size_t maxDstSize,
+                        const HUF_original_CElt* CTable, U32 maxSymbolValue, U32 huffLog)
+{
+    U32 workSpace[FSE_original_WKSP_SIZE_U32(HUF_original_WEIGHTS_FSELOG, HUF_original_TABLELOG_MAX)];
+    return HUF_original_writeCTable_wksp(dst, maxDstSize, CTable, maxSymbolValue, huffLog, workSpace, sizeof(workSpace));
+}
+
 
 
 size_t HUF_original_readCTable (HUF_original_CElt* CTable, U32 maxSymbolValue, const void* src, size_t srcSize)
@@ -323,19 +366,22 @@ static void HUF_original_sort(nodeElt* huffNode, const U32* count, U32 maxSymbol
 
 
 #define STARTNODE (HUF_original_SYMBOLVALUE_MAX+1)
-size_t HUF_original_buildCTable (HUF_original_CElt* tree, const U32* count, U32 maxSymbolValue, U32 maxNbBits)
+size_t HUF_original_buildCTable_wksp (HUF_original_CElt* tree, const U32* count, U32 maxSymbolValue, U32 maxNbBits, void* workSpace, size_t wkspSize)
 {
-    nodeElt huffNode0[2*HUF_original_SYMBOLVALUE_MAX+1 +1];
-    nodeElt* huffNode = huffNode0 + 1;
+    nodeElt* const huffNode0 = (nodeElt*)workSpace;
+    nodeElt* const huffNode = huffNode0 + 1;
     U32 n, nonNullRank;
     int lowS, lowN;
     U16 nodeNb = STARTNODE;
     U32 nodeRoot;
 
     /* safety checks */
+    HUF_original_STATIC_ASSERT(HUF_original_BUILDCTABLE_WKSP_SIZE_U32 * sizeof(U32) == sizeof(huffNodeTable));   /* A compilation error here means HUF_original_BUILDCTABLE_WKSP_SIZE_U32 is not correct */
+    if (((size_t)workSpace & 3) != 0) return ERROR(GENERIC);   /* must be aligned on 4-bytes boundaries */
+    if (wkspSize < sizeof(huffNodeTable)) return ERROR(workSpace_tooSmall);
     if (maxNbBits == 0) maxNbBits = HUF_original_TABLELOG_DEFAULT;
     if (maxSymbolValue > HUF_original_SYMBOLVALUE_MAX) return ERROR(GENERIC);
-    memset(huffNode0, 0, sizeof(huffNode0));
+    memset(huffNode0, 0, sizeof(huffNodeTable));
 
     /* sort, decreasing order */
     HUF_original_sort(huffNode, count, maxSymbolValue);
@@ -391,7 +437,13 @@ size_t HUF_original_buildCTable (HUF_original_CElt* tree, const U32* count, U32
     return maxNbBits;
 }
 
-static void HUF_original_encodeSymbol(BIT_CStream_t* bitCPtr, U32 symbol, const HUF_original_CElt* CTable)
+size_t HUF_original_buildCTable (HUF_original_CElt* tree, const U32* count, U32 maxSymbolValue, U32 maxNbBits)
+{
+    huffNodeTable nodeTable;
+    return HUF_original_buildCTable_wksp(tree, count, maxSymbolValue, maxNbBits, nodeTable, sizeof(nodeTable));
+}
+
+FORCE_INLINE void HUF_original_encodeSymbol(BIT_CStream_t* bitCPtr, U32 symbol, const HUF_original_CElt* CTable)
 {
     BIT_addBitsFast(bitCPtr, CTable[symbol].val, CTable[symbol].nbBits);
 }
@@ -406,7 +458,71 @@ size_t HUF_original_compressBound(size_t size) { return HUF_original_COMPRESSBOU
 #define HUF_original_FLUSHBITS_2(stream) \
     if (sizeof((stream)->bitContainer)*8 < HUF_original_TABLELOG_MAX*4+7) HUF_original_FLUSHBITS(stream)
 
-size_t HUF_original_compress1X_usingCTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable)
+/* HUF_original_encodeTail() :
+   a stream is encoded backward, starting with its last (srcSize & 3) symbols */
+FORCE_INLINE void HUF_original_encodeTail(BIT_CStream_t* bitCPtr, const BYTE* ip, size_t srcSize, const HUF_original_CElt* CTable, const unsigned fast)
+{
+    size_t const n = srcSize & ~3;  /* join to mod 4 */
+    switch (srcSize & 3)
+    {
+        case 3 : HUF_original_encodeSymbol(bitCPtr, ip[n+ 2], CTable);
+                 HUF_original_FLUSHBITS_2(bitCPtr);
+        case 2 : HUF_original_encodeSymbol(bitCPtr, ip[n+ 1], CTable);
+                 HUF_original_FLUSHBITS_1(bitCPtr);
+        case 1 : HUF_original_encodeSymbol(bitCPtr, ip[n+ 0], CTable);
+                 HUF_original_FLUSHBITS(bitCPtr);
+        case 0 :
+        default: ;
+    }
+}
+
+/* pair table entry : codes of symbols `a` then `b` concatenated (bits 8+), combined nb of bits (bits 0-7).
+   Index is (a<<8) + b, hence a little-endian 16-bit read of `b` followed by `a`. */
+size_t HUF_original_buildPairTable(U32* pairTable, const HUF_original_CElt* CTable, unsigned maxSymbolValue)
+{
+    U32 a, b;
+    if (maxSymbolValue > HUF_original_SYMBOLVALUE_MAX) return ERROR(maxSymbolValue_tooLarge);
+    for (a=0; a<=maxSymbolValue; a++) {
+        U32 const nbBitsA = CTable[a].nbBits;
+        U32 const valA = CTable[a].val;
+        U32* const row = pairTable + (a<<8);
+        if (!nbBitsA) continue;   /* absent symbol : row never used */
+        for (b=0; b<=maxSymbolValue; b++)
+            row[b] = ((valA + ((U32)CTable[b].val << nbBitsA)) << 8) + nbBitsA + CTable[b].nbBits;
+    }
+    return 0;
+}
+
+FORCE_INLINE void HUF_original_encodePair(BIT_CStream_t* bitCPtr, U32 pair, const U32* pairTable)
+{
+    U32 const elt = pairTable[pair];
+    BIT_addBitsFast(bitCPtr, elt >> 8, elt & 0xFF);
+}
+
+/* HUF_original_encodeGroup() :
+   encodes the 4 symbols preceding `ip`, last one first.
+   `pairTable` is optional : when provided, symbols are encoded 2 by 2 */
+FORCE_INLINE void HUF_original_encodeGroup(BIT_CStream_t* bitCPtr, const BYTE* ip, const HUF_original_CElt* CTable, const U32* pairTable, const unsigned fast)
+{
+    if (pairTable) {
+        HUF_original_encodePair(bitCPtr, MEM_readLE16(ip-2), pairTable);
+        HUF_original_FLUSHBITS_2(bitCPtr);
+        HUF_original_encodePair(bitCPtr, MEM_readLE16(ip-4), pairTable);
+        HUF_original_FLUSHBITS(bitCPtr);
+        return;
+    }
+    HUF_original_encodeSymbol(bitCPtr, ip[-1], CTable);
+    HUF_original_FLUSHBITS_1(bitCPtr);
+    HUF_original_encodeSymbol(bitCPtr, ip[-2], CTable);
+    HUF_original_FLUSHBITS_2(bitCPtr);
+    HUF_original_encodeSymbol(bitCPtr, ip[-3], CTable);
+    HUF_original_FLUSHBITS_1(bitCPtr);
+    HUF_original_encodeSymbol(bitCPtr, ip[-4], CTable);
+    HUF_original_FLUSHBITS(bitCPtr);
+}
+
+FORCE_INLINE size_t HUF_original_compress1X_body(void* dst, size_t dstSize, const void* src, size_t srcSize,
+                                            const HUF_original_CElt* CTable, const U32* pairTable)
 {
     const BYTE* ip = (const BYTE*) src;
     BYTE* const ostart = (BYTE*)dst;
@@ -421,72 +537,201 @@ size_t HUF_original_compress1X_usingCTable(void* dst, size_t dstSize, const void
     { size_t const errorCode = BIT_initCStream(&bitC, op, oend-op);
       if (HUF_original_isError(errorCode)) return 0; }
 
-    n = srcSize & ~3;  /* join to mod 4 */
-    switch (srcSize & 3)
-    {
-        case 3 : HUF_original_encodeSymbol(&bitC, ip[n+ 2], CTable);
-                 HUF_original_FLUSHBITS_2(&bitC);
-        case 2 : HUF_original_encodeSymbol(&bitC, ip[n+ 1], CTable);
-                 HUF_original_FLUSHBITS_1(&bitC);
-        case 1 : HUF_original_encodeSymbol(&bitC, ip[n+ 0], CTable);
-                 HUF_original_FLUSHBITS(&bitC);
-        case 0 :
-        default: ;
+    HUF_original_encodeTail(&bitC, ip, srcSize, CTable, fast);
+
+    for (n = srcSize & ~3; n>0; n-=4)   /* note : n&3==0 at this stage */
+        HUF_original_encodeGroup(&bitC, ip+n, CTable, pairTable, fast);
+
+    return BIT_closeCStream(&bitC);
+}
+
+HUF_original_CGEN(HUF_original_compress1X)
+
+size_t HUF_original_compress1X_usingCTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable)
+{
+    return HUF_original_compress1X_internal(dst, dstSize, src, srcSize, CTable, NULL);
+}
+
+size_t HUF_original_compress1X_usingPairTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable, const U32* pairTable)
+{
+    return HUF_original_compress1X_internal(dst, dstSize, src, srcSize, CTable, pairTable);
+}
+
+
+/* HUF_original_writeJumpEntry() :
+   jump table fields are 16 bits, or 32 bits for blocks larger than HUF_original_BLOCKSIZE_MAX */
+static void HUF_original_writeJumpEntry(void* p, size_t value, size_t entrySize)
+{
+    if (entrySize==4) MEM_writeLE32(p, (U32)value);
+    else MEM_writeLE16(p, (U16)value);
+}
+
+/* HUF_original_compress4X_interleaved() :
+   encodes the 4 segments within a single loop, one group of 4 symbols per stream and per round,
+   each stream into its own region of `dst`,
+   then packs regions behind the jump table.
+   A region is sized for typical cases, not for worst case (up to HUF_original_TABLELOG_MAX bits per symbol),
+   so flushes are checked : a stream never writes beyond its region, and an overflow is reported by BIT_closeCStream().
+   Output is identical to 4 successive HUF_original_compress1X_usingCTable().
+   requires dstSize >= 3*entrySize + 4*HUF_original_BLOCKBOUND(segmentSize) and srcSize >= 12.
+   @return : compressed size, or 0 if one stream does not fit into its region */
+FORCE_INLINE size_t HUF_original_compress4X_interleaved(void* dst, const void* src, size_t srcSize,
+                                               const HUF_original_CElt* CTable, const U32* pairTable)
+{
+    size_t const segmentSize = (srcSize+3)/4;   /* first 3 segments */
+    size_t const lastSize = srcSize - 3*segmentSize;
+    size_t const entrySize = HUF_original_JUMPTABLE_ENTRY_SIZE(srcSize);
+    size_t const regionSize = HUF_original_BLOCKBOUND(segmentSize);
+    const BYTE* const ip1 = (const BYTE*) src;
+    const BYTE* const ip2 = ip1 + segmentSize;
+    const BYTE* const ip3 = ip2 + segmentSize;
+    const BYTE* const ip4 = ip3 + segmentSize;
+    BYTE* const ostart = (BYTE*) dst;
+    BYTE* const region1 = ostart + 3*entrySize;
+    const unsigned fast = 0;   /* a skewed segment can exceed its region */
+    size_t n = segmentSize & ~3;
+    BIT_CStream_t bitC1, bitC2, bitC3, bitC4;
+
+    /* init : cannot fail, regionSize > sizeof(size_t) */
+    BIT_initCStream(&bitC1, region1, regionSize);
+    BIT_initCStream(&bitC2, region1 + regionSize, regionSize);
+    BIT_initCStream(&bitC3, region1 + 2*regionSize, regionSize);
+    BIT_initCStream(&bitC4, region1 + 3*regionSize, regionSize);
+
+    /* each stream starts with its own remainder */
+    HUF_original_encodeTail(&bitC1, ip1, segmentSize, CTable, fast);
+    HUF_original_encodeTail(&bitC2, ip2, segmentSize, CTable, fast);
+    HUF_original_encodeTail(&bitC3, ip3, segmentSize, CTable, fast);
+    HUF_original_encodeTail(&bitC4, ip4, lastSize, CTable, fast);
+
+    if (n > (lastSize & ~3)) {   /* last segment has one group less */
+        HUF_original_encodeGroup(&bitC1, ip1+n, CTable, pairTable, fast);
+        HUF_original_encodeGroup(&bitC2, ip2+n, CTable, pairTable, fast);
+        HUF_original_encodeGroup(&bitC3, ip3+n, CTable, pairTable, fast);
+        n -= 4;
     }
 
     for (; n>0; n-=4) {  /* note : n&3==0 at this stage */
-        HUF_original_encodeSymbol(&bitC, ip[n- 1], CTable);
-        HUF_original_FLUSHBITS_1(&bitC);
-        HUF_original_encodeSymbol(&bitC, ip[n- 2], CTable);
-        HUF_original_FLUSHBITS_2(&bitC);
-        HUF_original_encodeSymbol(&bitC, ip[n- 3], CTable);
-        HUF_original_FLUSHBITS_1(&bitC);
-        HUF_original_encodeSymbol(&bitC, ip[n- 4], CTable);
-        HUF_original_FLUSHBITS(&bitC);
+        HUF_original_encodeGroup(&bitC1, ip1+n, CTable, pairTable, fast);
+        HUF_original_encodeGroup(&bitC2, ip2+n, CTable, pairTable, fast);
+        HUF_original_encodeGroup(&bitC3, ip3+n, CTable, pairTable, fast);
+        HUF_original_encodeGroup(&bitC4, ip4+n, CTable, pairTable, fast);
     }
 
-    return BIT_closeCStream(&bitC);
+    /* close streams, and pack regions behind the jump table */
+    {   size_t const cSize1 = BIT_closeCStream(&bitC1);
+        size_t const cSize2 = BIT_closeCStream(&bitC2);
+        size_t const cSize3 = BIT_closeCStream(&bitC3);
+        size_t const cSize4 = BIT_closeCStream(&bitC4);
+        BYTE* op = region1 + cSize1;
+        if ((cSize1==0) | (cSize2==0) | (cSize3==0) | (cSize4==0)) return 0;
+        HUF_original_writeJumpEntry(ostart, cSize1, entrySize);
+        HUF_original_writeJumpEntry(ostart+entrySize, cSize2, entrySize);
+        HUF_original_writeJumpEntry(ostart+2*entrySize, cSize3, entrySize);
+        memmove(op, region1 + regionSize, cSize2);   op += cSize2;
+        memmove(op, region1 + 2*regionSize, cSize3); op += cSize3;
+        memmove(op, region1 + 3*regionSize, cSize4); op += cSize4;
+        return op-ostart;
+    }
 }
 
-
-size_t HUF_original_compress4X_usingCTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable)
+FORCE_INLINE size_t HUF_original_compress4X_body(void* dst, size_t dstSize, const void* src, size_t srcSize,
+                                            const HUF_original_CElt* CTable, const U32* pairTable)
 {
     size_t const segmentSize = (srcSize+3)/4;   /* first 3 segments */
+    size_t const entrySize = HUF_original_JUMPTABLE_ENTRY_SIZE(srcSize);
     const BYTE* ip = (const BYTE*) src;
     const BYTE* const iend = ip + srcSize;
     BYTE* const ostart = (BYTE*) dst;
     BYTE* const oend = ostart + dstSize;
     BYTE* op = ostart;
 
-    if (dstSize < 6 + 1 + 1 + 1 + 8) return 0;   /* minimum space to compress successfully */
+    if (dstSize < 3*entrySize + 1 + 1 + 1 + 8) return 0;   /* minimum space to compress successfully */
     if (srcSize < 12) return 0;   /* no saving possible : too small input */
-    op += 6;   /* jumpTable */
 
-    {   size_t const cSize = HUF_original_compress1X_usingCTable(op, oend-op, ip, segmentSize, CTable);
+    if (dstSize >= 3*entrySize + 4*HUF_original_BLOCKBOUND(segmentSize)) {   /* enough room for 4 independent regions */
+        size_t const cSize = HUF_original_compress4X_interleaved(dst, src, srcSize, CTable, pairTable);
+        if (cSize) return cSize;
+        /* a stream overflowed its region : serial version below decides */
+    }
+
+    op += 3*entrySize;   /* jumpTable */
+
+    {   size_t const cSize = HUF_original_compress1X_body(op, oend-op, ip, segmentSize, CTable, pairTable);
         if (HUF_original_isError(cSize)) return cSize;
         if (cSize==0) return 0;
-        MEM_writeLE16(ostart, (U16)cSize);
+        HUF_original_writeJumpEntry(ostart, cSize, entrySize);
         op += cSize;
     }
 
     ip += segmentSize;
-    {   size_t const cSize = HUF_original_compress1X_usingCTable(op, oend-op, ip, segmentSize, CTable);
+    {   size_t const cSize = HUF_original_compress1X_body(op, oend-op, ip, segmentSize, CTable, pairTable);
         if (HUF_original_isError(cSize)) return cSize;
         if (cSize==0) return 0;
-        MEM_writeLE16(ostart+2, (U16)cSize);
+        HUF_original_writeJumpEntry(ostart+entrySize, cSize, entrySize);
         op += cSize;
     }
 
     ip += segmentSize;
-    {   size_t const cSize = HUF_original_compress1X_usingCTable(op, oend-op, ip, segmentSize, CTable);
+    {   size_t const cSize = HUF_original_compress1X_body(op, oend-op, ip, segmentSize, CTable, pairTable);
         if (HUF_original_isError(cSize)) return cSize;
         if (cSize==0) return 0;
-        MEM_writeLE16(ostart+4, (U16)cSize);
+        HUF_original_writeJumpEntry(ostart+2*entrySize, cSize, entrySize);
         op += cSize;
     }
 
     ip += segmentSize;
-    {   size_t const cSize = HUF_original_compress1X_usingCTable(op, oend-op, ip, iend-ip, CTable);
+    {   size_t const cSize = HUF_original_compress1X_body(op, oend-op, ip, iend-ip, CTable, pairTable);
+        if (HUF_original_isError(cSize)) return cSize;
+        if (cSize==0) return 0;
+        op += cSize;
+    }
+
+    return op-ostart;
+}
+
+HUF_original_CGEN(HUF_original_compress4X)
+
+size_t HUF_original_compress4X_usingCTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable)
+{
+    return HUF_original_compress4X_internal(dst, dstSize, src, srcSize, CTable, NULL);
+}
+
+size_t HUF_original_compress4X_usingPairTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable, const U32* pairTable)
+{
+    return HUF_original_compress4X_internal(dst, dstSize, src, srcSize, CTable, pairTable);
+}
+
+
+/* 8-streams format : jump table starts with a 0 marker, which is never a valid 4-streams first size,
+   followed by the compressed sizes of first 7 streams. */
+FORCE_INLINE size_t HUF_original_compress8X_body(void* dst, size_t dstSize, const void* src, size_t srcSize,
+                                            const HUF_original_CElt* CTable, const U32* pairTable)
+{
+    size_t const segmentSize = (srcSize+7)/8;   /* first 7 segments */
+    size_t const entrySize = HUF_original_JUMPTABLE_ENTRY_SIZE(srcSize);
+    const BYTE* ip = (const BYTE*) src;
+    const BYTE* const iend = ip + srcSize;
+    BYTE* const ostart = (BYTE*) dst;
+    BYTE* const oend = ostart + dstSize;
+    BYTE* op = ostart;
+    U32 n;
+
+    if (dstSize < 8*entrySize + 7 + 1 + 8) return 0;   /* minimum space to compress successfully */
+    if (srcSize < 64) return 0;   /* too small input : last segment could be empty */
+    HUF_original_writeJumpEntry(ostart, 0, entrySize);   /* 8-streams marker */
+    op += 8*entrySize;   /* jumpTable */
+
+    for (n=0; n<7; n++) {
+        size_t const cSize = HUF_original_compress1X_body(op, oend-op, ip, segmentSize, CTable, pairTable);
+        if (HUF_original_isError(cSize)) return cSize;
+        if (cSize==0) return 0;
+        HUF_original_writeJumpEntry(ostart+(n+1)*entrySize, cSize, entrySize);
+        op += cSize;
+        ip += segmentSize;
+    }
+
+    {   size_t const cSize = HUF_original_compress1X_body(op, oend-op, ip, iend-ip, CTable, pairTable);
         if (HUF_original_isError(cSize)) return cSize;
         if (cSize==0) return 0;
         op += cSize;
@@ -495,30 +740,130 @@ size_t HUF_original_compress4X_usingCTable(void* dst, size_t dstSize, const void
     return op-ostart;
 }
 
+HUF_original_CGEN(HUF_original_compress8X)
+
+size_t HUF_original_compress8X_usingCTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable)
+{
+    return HUF_original_compress8X_internal(dst, dstSize, src, srcSize, CTable, NULL);
+}
+
+static size_t HUF_original_compress8X_usingPairTable(void* dst, size_t dstSize, const void* src, size_t srcSize, const HUF_original_CElt* CTable, const U32* pairTable)
+{
+    return HUF_original_compress8X_internal(dst, dstSize, src, srcSize, CTable, pairTable);
+}
+
+
+/* HUF_original_compress_internal() scratch memory.
+   Counting tables, tree construction and weights compression take place successively, so they share the same area. */
+typedef struct {
+    U32 count[HUF_original_SYMBOLVALUE_MAX+1];
+    HUF_original_CElt CTable[HUF_original_SYMBOLVALUE_MAX+1];
+    union {
+        U32 counting[FSE_original_COUNT_WKSP_SIZE_U32];
+        U32 buildCTable[HUF_original_BUILDCTABLE_WKSP_SIZE_U32];
+        U32 writeCTable[FSE_original_WKSP_SIZE_U32(HUF_original_WEIGHTS_FSELOG, HUF_original_TABLELOG_MAX)];
+    } scratch;
+} HUF_original_compress_tables_t;
+
+/* HUF_original_estimateBits() :
+   @return : nb of bits required to compress `count` using `CTable`,
+             or 0 if `CTable` cannot represent all present symbols */
+static size_t HUF_original_estimateBits(const HUF_original_CElt* CTable, U32 tableMaxSymbolValue, const unsigned* count, U32 maxSymbolValue)
+{
+    size_t nbBits = 0;
+    U32 s;
+    for (s=0; s<=maxSymbolValue; s++) {
+        if (!count[s]) continue;
+        if ((s > tableMaxSymbolValue) || (CTable[s].nbBits == 0)) return 0;
+        nbBits += (size_t)count[s] * CTable[s].nbBits;
+    }
+    return nbBits;
+}
+
+size_t HUF_original_estimateCompressedSize(const HUF_original_CElt* CTable, const unsigned* count, unsigned maxSymbolValue)
+{
+    size_t nbBits;
+    if (maxSymbolValue > HUF_original_SYMBOLVALUE_MAX) return ERROR(maxSymbolValue_tooLarge);
+    nbBits = HUF_original_estimateBits(CTable, maxSymbolValue, count, maxSymbolValue);
+    if (nbBits==0) return ERROR(GENERIC);   /* a present symbol is not part of the tree */
+    return (nbBits + 1 /* end mark */ + 7) >> 3;
+}
+
+/* HUF_original_usePairTable() :
+   pair table build writes one row of (maxSymbolValue+1) entries per present symbol.
+   It must be amortized by srcSize, and its used part must stay L2-resident (<= 128 KB) */
+static unsigned HUF_original_usePairTable(const unsigned* count, U32 maxSymbolValue, size_t srcSize)
+{
+    size_t nbEntries = 0;
+    U32 s;
+    for (s=0; s<=maxSymbolValue; s++) nbEntries += (count[s]!=0);
+    nbEntries *= maxSymbolValue+1;
+    return (nbEntries <= (32 << 10)) && (srcSize >= 4*nbEntries);
+}
+
+/* HUF_original_compressBody() :
+   compresses `src` with `CTable` into `op`, after a table description header starting at `ostart`.
+   `count` is optional (NULL when statistics were not collected) : it enables the pair table.
+   @return : total compressed size from `ostart`, 0 if not compressible, or an error code */
+static size_t HUF_original_compressBody(BYTE* op, size_t dstCapacity, const BYTE* ostart,
+                               const void* src, size_t srcSize, unsigned nbStreams,
+                               const HUF_original_CElt* CTable, void* workSpace, size_t wkspSize,
+                               const unsigned* count, unsigned maxSymbolValue)
+{
+    size_t cSize;
+    if ((count != NULL) && (wkspSize >= HUF_original_WORKSPACE_PAIRS_SIZE) && HUF_original_usePairTable(count, maxSymbolValue, srcSize)) {
+        U32* const pairTable = (U32*)workSpace + HUF_original_WORKSPACE_SIZE_U32;
+        HUF_original_buildPairTable(pairTable, CTable, maxSymbolValue);
+        cSize = (nbStreams==1) ? HUF_original_compress1X_usingPairTable(op, dstCapacity, src, srcSize, CTable, pairTable) :
+                (nbStreams==8) ? HUF_original_compress8X_usingPairTable(op, dstCapacity, src, srcSize, CTable, pairTable) :
+                                 HUF_original_compress4X_usingPairTable(op, dstCapacity, src, srcSize, CTable, pairTable);
+    } else {
+        cSize = (nbStreams==1) ? HUF_original_compress1X_usingCTable(op, dstCapacity, src, srcSize, CTable) :   /* single segment */
+                (nbStreams==8) ? HUF_original_compress8X_usingCTable(op, dstCapacity, src, srcSize, CTable) :
+                                 HUF_original_compress4X_usingCTable(op, dstCapacity, src, srcSize, CTable);
+    }
+    if (HUF_original_isError(cSize)) return cSize;
+    if (cSize==0) return 0;   /* uncompressible */
+    op += cSize;
+
+    /* check compressibility */
+    if ((size_t)(op-ostart) >= srcSize-1) return 0;
+    return op-ostart;
+}
 
 static size_t HUF_original_compress_internal (
                 void* dst, size_t dstSize,
                 const void* src, size_t srcSize,
                 unsigned maxSymbolValue, unsigned huffLog,
-                unsigned singleStream)
+                unsigned nbStreams, size_t blockSizeMax,
+                void* workSpace, size_t wkspSize,
+                HUF_original_CElt* oldHufTable, HUF_original_repeat* repeat, int preferRepeat)
 {
+    HUF_original_compress_tables_t* const table = (HUF_original_compress_tables_t*)workSpace;
     BYTE* const ostart = (BYTE*)dst;
     BYTE* const oend = ostart + dstSize;
     BYTE* op = ostart;
 
-    U32 count[HUF_original_SYMBOLVALUE_MAX+1];
-    HUF_original_CElt CTable[HUF_original_SYMBOLVALUE_MAX+1];
-
     /* checks & inits */
+    HUF_original_STATIC_ASSERT(sizeof(HUF_original_compress_tables_t) <= HUF_original_WORKSPACE_SIZE);   /* A compilation error here means HUF_original_WORKSPACE_SIZE is too small */
+    if (((size_t)workSpace & 3) != 0) return ERROR(GENERIC);   /* must be aligned on 4-bytes boundaries */
+    if (wkspSize < sizeof(HUF_original_compress_tables_t)) return ERROR(workSpace_tooSmall);
     if (!srcSize) return 0;  /* Uncompressed (note : 1 means rle, so first byte must be correct) */
     if (!dstSize) return 0;  /* cannot fit within dst budget */
-    if (srcSize > HUF_original_BLOCKSIZE_MAX) return ERROR(srcSize_wrong);   /* current block size limit */
+    if (srcSize > blockSizeMax) return ERROR(srcSize_wrong);   /* current block size limit */
     if (huffLog > HUF_original_TABLELOG_MAX) return ERROR(tableLog_tooLarge);
     if (!maxSymbolValue) maxSymbolValue = HUF_original_SYMBOLVALUE_MAX;
     if (!huffLog) huffLog = HUF_original_TABLELOG_DEFAULT;
 
+    /* trusted previous table : skip statistics and table construction */
+    if (preferRepeat && repeat && (*repeat == HUF_original_repeat_valid)) {
+        if (dstSize < 2) return 0;
+        *op++ = HUF_original_REPEAT_HEADER;
+        return HUF_original_compressBody(op, oend - op, ostart, src, srcSize, nbStreams, oldHufTable, workSpace, wkspSize, NULL, 0);
+    }
+
     /* Scan input and build symbol stats */
-    {   size_t const largest = FSE_original_count (count, &maxSymbolValue, (const BYTE*)src, srcSize);
+    {   size_t const largest = FSE_original_count_wksp (table->count, &maxSymbolValue, (const BYTE*)src, srcSize, table->scratch.counting);
         if (HUF_original_isError(largest)) return largest;
         if (largest == srcSize) { *ostart = ((const BYTE*)src)[0]; return 1; }   /* rle */
         if (largest <= (srcSize >> 7)+1) return 0;   /* Fast heuristic : not compressible enough */
@@ -526,47 +871,106 @@ static size_t HUF_original_compress_internal (
 
     /* Build Huffman Tree */
     huffLog = HUF_original_optimalTableLog(huffLog, srcSize, maxSymbolValue);
-    {   size_t const maxBits = HUF_original_buildCTable (CTable, count, maxSymbolValue, huffLog);
+    {   size_t const maxBits = HUF_original_buildCTable_wksp (table->CTable, table->count, maxSymbolValue, huffLog,
+                                                     table->scratch.buildCTable, sizeof(table->scratch.buildCTable));
         if (HUF_original_isError(maxBits)) return maxBits;
         huffLog = (U32)maxBits;
     }
 
     /* Write table description header */
-    {   size_t const hSize = HUF_original_writeCTable (op, dstSize, CTable, maxSymbolValue, huffLog);
+    {   const HUF_original_CElt* CTable = table->CTable;
+        size_t hSize = HUF_original_writeCTable_wksp (op, dstSize, table->CTable, maxSymbolValue, huffLog,
+                                             table->scratch.writeCTable, sizeof(table->scratch.writeCTable));
         if (HUF_original_isError(hSize)) return hSize;
+
+        /* re-use previous table if it's cheaper than sending the new one */
+        if (repeat && (*repeat != HUF_original_repeat_none)) {
+            size_t const prevBits = HUF_original_estimateBits(oldHufTable, HUF_original_SYMBOLVALUE_MAX, table->count, maxSymbolValue);
+            size_t const newBits = HUF_original_estimateBits(table->CTable, maxSymbolValue, table->count, maxSymbolValue);
+            if ((prevBits != 0) && (1 + (prevBits+7)/8 <= hSize + (newBits+7)/8)) {
+                *op = HUF_original_REPEAT_HEADER;
+                hSize = 1;
+                CTable = oldHufTable;
+        }   }
+
         if (hSize + 12 >= srcSize) return 0;   /* not useful to try compression */
         op += hSize;
-    }
 
-    /* Compress */
-    {   size_t const cSize = (singleStream) ?
-                            HUF_original_compress1X_usingCTable(op, oend - op, src, srcSize, CTable) :   /* single segment */
-                            HUF_original_compress4X_usingCTable(op, oend - op, src, srcSize, CTable);
-        if (HUF_original_isError(cSize)) return cSize;
-        if (cSize==0) return 0;   /* uncompressible */
-        op += cSize;
-    }
+        {   size_t const cSize = HUF_original_compressBody(op, oend - op, ostart, src, srcSize, nbStreams, CTable, workSpace, wkspSize, table->count, maxSymbolValue);
+            if (HUF_original_isError(cSize) || (cSize==0)) return cSize;
+            /* save new table, for next block */
+            if (repeat && (CTable != oldHufTable)) {
+                memcpy(oldHufTable, table->CTable, (maxSymbolValue+1) * sizeof(HUF_original_CElt));
+                memset(oldHufTable + maxSymbolValue+1, 0, (HUF_original_SYMBOLVALUE_MAX-maxSymbolValue) * sizeof(HUF_original_CElt));   /* absent symbols */
+                *repeat = HUF_original_repeat_check;
+            }
+            return cSize;
+    }   }
+}
 
-    /* check compressibility */
-    if ((size_t)(op-ostart) >= srcSize-1)
-        return 0;
 
-    return op-ostart;
+size_t HUF_original_compress1X_wksp (void* dst, size_t dstSize,
+                      const void* src, size_t srcSize,
+                      unsigned maxSymbolValue, unsigned huffLog,
+                      void* workSpace, size_t wkspSize)
+{
+    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 1, HUF_original_BLOCKSIZE_MAX, workSpace, wkspSize, NULL, NULL, 0);
 }
 
+size_t HUF_original_compress4X_wksp (void* dst, size_t dstSize,
+                      const void* src, size_t srcSize,
+                      unsigned maxSymbolValue, unsigned huffLog,
+                      void* workSpace, size_t wkspSize)
+{
+    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 4, HUF_original_BLOCKSIZE_MAX, workSpace, wkspSize, NULL, NULL, 0);
+}
+
+size_t HUF_original_compress8X_wksp (void* dst, size_t dstSize,
+                      const void* src, size_t srcSize,
+                      unsigned maxSymbolValue, unsigned huffLog,
+                      void* workSpace, size_t wkspSize)
+{
+    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 8, HUF_original_BLOCKSIZE_MAX, workSpace, wkspSize, NULL, NULL, 0);
+}
+
+size_t HUF_original_compress4X_large_wksp (void* dst, size_t dstSize,
+                      const void* src, size_t srcSize,
+                      unsigned maxSymbolValue, unsigned huffLog,
+                      void* workSpace, size_t wkspSize)
+{
+    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 4, HUF_original_LARGE_BLOCKSIZE_MAX, workSpace, wkspSize, NULL, NULL, 0);
+}
 
 size_t HUF_original_compress1X (void* dst, size_t dstSize,
                  const void* src, size_t srcSize,
                  unsigned maxSymbolValue, unsigned huffLog)
 {
-    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 1);
+    U32 workSpace[HUF_original_WORKSPACE_SIZE_U32];
+    return HUF_original_compress1X_wksp(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, workSpace, sizeof(workSpace));
 }
 
 size_t HUF_original_compress2 (void* dst, size_t dstSize,
                 const void* src, size_t srcSize,
                 unsigned maxSymbolValue, unsigned huffLog)
 {
-    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 0);
+    U32 workSpace[HUF_original_WORKSPACE_SIZE_U32];
+    return HUF_original_compress4X_wksp(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, workSpace, sizeof(workSpace));
+}
+
+size_t HUF_original_compress8X (void* dst, size_t dstSize,
+                 const void* src, size_t srcSize,
+                 unsigned maxSymbolValue, unsigned huffLog)
+{
+    U32 workSpace[HUF_original_WORKSPACE_SIZE_U32];
+    return HUF_original_compress8X_wksp(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, workSpace, sizeof(workSpace));
+}
+
+size_t HUF_original_compress4X_large (void* dst, size_t dstSize,
+                 const void* src, size_t srcSize,
+                 unsigned maxSymbolValue, unsigned huffLog)
+{
+    U32 workSpace[HUF_original_WORKSPACE_SIZE_U32];
+    return HUF_original_compress4X_large_wksp(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, workSpace, sizeof(workSpace));
 }
 
 
@@ -574,3 +978,80 @@ size_t HUF_original_compress (void* dst, size_t maxDstSize, const void* src, siz
 {
     return HUF_original_compress2(dst, maxDstSize, src, (U32)srcSize, 255, HUF_original_TABLELOG_DEFAULT);
 }
+
+
+/* **************************************************************
+*  Compression context
+****************************************************************/
+struct HUF_original_CCtx_s {
+    U32 workSpace[HUF_original_WORKSPACE_PAIRS_SIZE / sizeof(U32)];
+    HUF_original_CElt CTable[HUF_original_SYMBOLVALUE_MAX+1];   /* table of last compressed block, for repeat mode */
+    HUF_original_repeat repeat;
+};
+
+HUF_original_CCtx* HUF_original_createCCtx(void)
+{
+    HUF_original_CCtx* const cctx = (HUF_original_CCtx*)malloc(sizeof(HUF_original_CCtx));
+    if (cctx) HUF_original_resetCCtx(cctx);
+    return cctx;
+}
+
+void HUF_original_freeCCtx(HUF_original_CCtx* cctx) { free(cctx); }
+
+void HUF_original_resetCCtx(HUF_original_CCtx* cctx) { cctx->repeat = HUF_original_repeat_none; }
+
+/* HUF_original_compressCCtx_internal() :
+   new tables are always saved into `cctx`; they are only re-used with `allowRepeat` */
+static size_t HUF_original_compressCCtx_internal (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize,
+                                         unsigned maxSymbolValue, unsigned huffLog, unsigned nbStreams, unsigned allowRepeat)
+{
+    HUF_original_repeat repeat = allowRepeat ? cctx->repeat : HUF_original_repeat_none;
+    size_t const cSize = HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, nbStreams, HUF_original_BLOCKSIZE_MAX,
+                                                        cctx->workSpace, sizeof(cctx->workSpace), cctx->CTable, &repeat, 0);
+    if (repeat != HUF_original_repeat_none) cctx->repeat = repeat;   /* a new table was saved, or previous one is still valid */
+    return cSize;
+}
+
+size_t HUF_original_compress4X_CCtx (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned huffLog)
+{
+    return HUF_original_compressCCtx_internal(cctx, dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 4, 0);
+}
+
+size_t HUF_original_compress1X_CCtx (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned huffLog)
+{
+    return HUF_original_compressCCtx_internal(cctx, dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 1, 0);
+}
+
+size_t HUF_original_compress4X_CCtx_repeat (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned huffLog)
+{
+    return HUF_original_compressCCtx_internal(cctx, dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 4, 1);
+}
+
+size_t HUF_original_compress1X_CCtx_repeat (HUF_original_CCtx* cctx, void* dst, size_t dstSize, const void* src, size_t srcSize, unsigned maxSymbolValue, unsigned huffLog)
+{
+    return HUF_original_compressCCtx_internal(cctx, dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 1, 1);
+}
+
+
+/* **************************************************************
+*  Caller-held table repeat mode
+****************************************************************/
+size_t HUF_original_compress4X_repeat (void* dst, size_t dstSize,
+                      const void* src, size_t srcSize,
+                      unsigned maxSymbolValue, unsigned huffLog,
+                      void* workSpace, size_t wkspSize,
+                      HUF_original_CElt* hufTable, HUF_original_repeat* repeat, int preferRepeat)
+{
+    if ((hufTable == NULL) || (repeat == NULL)) return ERROR(GENERIC);
+    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 4, HUF_original_BLOCKSIZE_MAX, workSpace, wkspSize, hufTable, repeat, preferRepeat);
+}
+
+size_t HUF_original_compress1X_repeat (void* dst, size_t dstSize,
+                      const void* src, size_t srcSize,
+                      unsigned maxSymbolValue, unsigned huffLog,
+                      void* workSpace, size_t wkspSize,
+                      HUF_original_CElt* hufTable, HUF_original_repeat* repeat, int preferRepeat)
+{
+    if ((hufTable == NULL) || (repeat == NULL)) return ERROR(GENERIC);
+    return HUF_original_compress_internal(dst, dstSize, src, srcSize, maxSymbolValue, huffLog, 1, HUF_original_BLOCKSIZE_MAX, workSpace, wkspSize, hufTable, repeat, preferRepeat);
+}
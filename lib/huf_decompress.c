@@ -59,8 +59,10 @@
 /* **************************************************************
 *  Includes
 ****************************************************************/
+#include <stdlib.h>     /* malloc, free */
 #include <string.h>     /* memcpy, memset */
 #include "bitstream.h"
+#include "cpu.h"        /* CPU_TARGET_ATTRIBUTE, CPU_bmi2 */
 #include "fse.h"        /* header compression */
 #define HUF_original_STATIC_LINKING_ONLY
 #include "huf.h"
@@ -72,6 +74,32 @@
 #define HUF_original_STATIC_ASSERT(c) { enum { HUF_original_static_assert = 1/(int)(!!(c)) }; }   /* use only *after* variable declarations */
 
 
+/* **************************************************************
+*  Runtime dispatch
+****************************************************************/
+/* HUF_original_DGEN() :
+   generates fn##_internal() from FORCE_INLINE fn##_body(), with one variant compiled for generic target,
+   and one for BMI2 (shlx/shrx : shifts without flags nor dependency on cl), selected at runtime.
+   Each variant is specialized for `padded`. */
+#define HUF_original_DGEN_ARGS void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize, const HUF_original_DTable* DTable, unsigned padded
+#define HUF_original_DGEN_BODY(fn)                                                   \
+    {   if (padded) return fn##_body(dst, dstSize, cSrc, cSrcSize, DTable, 1);        \
+        return fn##_body(dst, dstSize, cSrc, cSrcSize, DTable, 0); }
+
+#if CPU_TARGET_SUPPORT
+#  define HUF_original_DGEN(fn)                                                      \
+    static size_t fn##_default(HUF_original_DGEN_ARGS) HUF_original_DGEN_BODY(fn)    \
+    CPU_TARGET_ATTRIBUTE("bmi2")                                                     \
+    static size_t fn##_bmi2(HUF_original_DGEN_ARGS) HUF_original_DGEN_BODY(fn)       \
+    static size_t fn##_internal(HUF_original_DGEN_ARGS)                              \
+    {   if (CPU_bmi2()) return fn##_bmi2(dst, dstSize, cSrc, cSrcSize, DTable, padded); \
+        return fn##_default(dst, dstSize, cSrc, cSrcSize, DTable, padded); }
+#else
+#  define HUF_original_DGEN(fn) \
+    static size_t fn##_internal(HUF_original_DGEN_ARGS) HUF_original_DGEN_BODY(fn)
+#endif
+
+
 /*-***************************/
 /*  generic DTableDesc       */
 /*-***************************/
@@ -86,6 +114,119 @@ static DTableDesc HUF_original_getDTableDesc(const HUF_original_DTable* table)
 }
 
 
+/*-***************************/
+/*  jump tables              */
+/*-***************************/
+
+/* HUF_original_readJumpEntry() :
+   jump table fields are 16 bits, or 32 bits for blocks larger than HUF_original_BLOCKSIZE_MAX */
+static size_t HUF_original_readJumpEntry(const void* p, size_t entrySize)
+{
+    return (entrySize==4) ? MEM_readLE32(p) : MEM_readLE16(p);
+}
+
+/* HUF_original_is8X() :
+   8-streams blocks start with a 0 marker, which is never a valid size of first 4-streams bitstream.
+   `cSrc` must be at least one jump table field large */
+static unsigned HUF_original_is8X(const void* cSrc, size_t dstSize)
+{
+    return HUF_original_readJumpEntry(cSrc, HUF_original_JUMPTABLE_ENTRY_SIZE(dstSize)) == 0;
+}
+
+/* HUF_original_init8X() :
+   reads jump table, initializes the 8 bitstreams, and segment boundaries into `opStart[0..8]`
+   @return : 0, or an error code */
+static size_t HUF_original_init8X(BIT_DStream_t* bitD, BYTE** opStart,
+                         void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    const BYTE* const istart = (const BYTE*) cSrc;
+    size_t const entrySize = HUF_original_JUMPTABLE_ENTRY_SIZE(dstSize);
+    const BYTE* ip = istart + 8*entrySize;   /* jumpTable */
+    size_t const segmentSize = (dstSize+7) / 8;
+    size_t lengthSum = 8*entrySize;
+    U32 n;
+
+    if (cSrcSize < 8*entrySize + 8) return ERROR(corruption_detected);   /* strict minimum : jump table + 1 byte per stream */
+    if (segmentSize*7 >= dstSize) return ERROR(corruption_detected);   /* last segment can't be empty */
+    for (n=1; n<8; n++) {
+        size_t const length = HUF_original_readJumpEntry(istart+n*entrySize, entrySize);
+        if (length > cSrcSize) return ERROR(corruption_detected);   /* also prevents sum overflow */
+        lengthSum += length;
+    }
+    if (lengthSum >= cSrcSize) return ERROR(corruption_detected);   /* last stream would be empty, or beyond input */
+
+    for (n=0; n<8; n++) {
+        size_t const length = (n<7) ? HUF_original_readJumpEntry(istart+(n+1)*entrySize, entrySize) : (size_t)(istart+cSrcSize-ip);
+        size_t const errorCode = BIT_initDStream(bitD+n, ip, length);
+        if (HUF_original_isError(errorCode)) return errorCode;
+        ip += length;
+        opStart[n] = (BYTE*)dst + n*segmentSize;
+    }
+    opStart[8] = (BYTE*)dst + dstSize;
+    return 0;
+}
+
+#define HUF_original_DECODE_8X(decode) { \
+    decode(op[0], bitD+0); decode(op[1], bitD+1); decode(op[2], bitD+2); decode(op[3], bitD+3); \
+    decode(op[4], bitD+4); decode(op[5], bitD+5); decode(op[6], bitD+6); decode(op[7], bitD+7); }
+
+#define HUF_original_RELOAD_8X() \
+    ( BIT_reloadDStream(bitD+0) | BIT_reloadDStream(bitD+1) | BIT_reloadDStream(bitD+2) | BIT_reloadDStream(bitD+3) \
+    | BIT_reloadDStream(bitD+4) | BIT_reloadDStream(bitD+5) | BIT_reloadDStream(bitD+6) | BIT_reloadDStream(bitD+7) )
+
+
+/*-***************************/
+/*  unchecked reloads        */
+/*-***************************/
+/* Fast loops run a nb of rounds determined upfront, from the distance to the beginning of each bitstream
+   and to the end of output, so that they can reload with BIT_reloadDStreamFast(), without status nor branch.
+   They are only used on 64-bits, where a round decodes 4 lookups per stream, hence consumes at most 4*dtLog bits.
+   Once they are done, the regular (checked) loops take over. */
+
+#define HUF_original_MIN(a,b) ((a)<(b) ? (a) : (b))
+
+/* HUF_original_nbFastRounds() :
+   nb of rounds `bitD` can run using BIT_reloadDStreamFast(), a round consuming at most `maxBits` bits,
+   while `op`, advancing by at most `maxBytes` per round, stays < `olimit` at the beginning of each round */
+FORCE_INLINE size_t HUF_original_nbFastRounds(const BIT_DStream_t* bitD, U32 maxBits,
+                                     const BYTE* op, const BYTE* olimit, size_t maxBytes)
+{
+    size_t const nbReloads = BIT_nbFastReloads(bitD, maxBits);
+    size_t const nbWrites = (op < olimit) ? (size_t)(olimit - op + maxBytes-1) / maxBytes : 0;
+    return HUF_original_MIN(nbReloads, nbWrites);
+}
+
+/* HUF_original_safeLimit() :
+   `margin` bytes before `oend`, or `ostart` when the segment is not larger than `margin`,
+   so that no pointer is formed before the segment, and loops on `op < limit` are simply skipped */
+FORCE_INLINE BYTE* HUF_original_safeLimit(BYTE* ostart, BYTE* oend, size_t margin)
+{
+    return (oend > ostart) && ((size_t)(oend - ostart) > margin) ? oend - margin : ostart;
+}
+
+/* HUF_original_nbFastRounds4() :
+   same as HUF_original_nbFastRounds(), for 4 streams progressing at the same pace.
+   Only `op4` is checked, since segment 4 is the smallest one. */
+FORCE_INLINE size_t HUF_original_nbFastRounds4(const BIT_DStream_t* bitD1, const BIT_DStream_t* bitD2,
+                                      const BIT_DStream_t* bitD3, const BIT_DStream_t* bitD4, U32 maxBits,
+                                      const BYTE* op4, const BYTE* olimit, size_t maxBytes)
+{
+    size_t const n12 = HUF_original_MIN(BIT_nbFastReloads(bitD1, maxBits), BIT_nbFastReloads(bitD2, maxBits));
+    size_t const n34 = HUF_original_MIN(BIT_nbFastReloads(bitD3, maxBits), HUF_original_nbFastRounds(bitD4, maxBits, op4, olimit, maxBytes));
+    return HUF_original_MIN(n12, n34);
+}
+
+#define HUF_original_DECODE_4X(decode) { \
+    decode(op1, &bitD1); decode(op2, &bitD2); decode(op3, &bitD3); decode(op4, &bitD4); }
+
+#define HUF_original_RELOAD_FAST_4X() { \
+    BIT_reloadDStreamFast(&bitD1); BIT_reloadDStreamFast(&bitD2); BIT_reloadDStreamFast(&bitD3); BIT_reloadDStreamFast(&bitD4); }
+
+#define HUF_original_RELOAD_FAST_8X() { \
+    BIT_reloadDStreamFast(bitD+0); BIT_reloadDStreamFast(bitD+1); BIT_reloadDStreamFast(bitD+2); BIT_reloadDStreamFast(bitD+3); \
+    BIT_reloadDStreamFast(bitD+4); BIT_reloadDStreamFast(bitD+5); BIT_reloadDStreamFast(bitD+6); BIT_reloadDStreamFast(bitD+7); }
+
+
 /*-***************************/
 /*  single-symbol decoding   */
 /*-***************************/
@@ -141,7 +282,7 @@ size_t HUF_original_readDTableX2 (HUF_original_DTable* DTable, const void* src,
 }
 
 
-static BYTE HUF_original_decodeSymbolX2(BIT_DStream_t* Dstream, const HUF_original_DEltX2* dt, const U32 dtLog)
+FORCE_INLINE BYTE HUF_original_decodeSymbolX2(BIT_DStream_t* Dstream, const HUF_original_DEltX2* dt, const U32 dtLog)
 {
     size_t const val = BIT_lookBitsFast(Dstream, dtLog); /* note : dtLog >= 1 */
     BYTE const c = dt[val].byte;
@@ -160,12 +301,28 @@ static BYTE HUF_original_decodeSymbolX2(BIT_DStream_t* Dstream, const HUF_origin
     if (MEM_64bits()) \
         HUF_original_DECODE_SYMBOLX2_0(ptr, DStreamPtr)
 
-static inline size_t HUF_original_decodeStreamX2(BYTE* p, BIT_DStream_t* const bitDPtr, BYTE* const pEnd, const HUF_original_DEltX2* const dt, const U32 dtLog)
+/* padded : `pEnd` may be overrun by up to 3 bytes, which only happens on corrupted input.
+ * @return : nb of decoded bytes, which is `pEnd-p` on valid input */
+FORCE_INLINE size_t HUF_original_decodeStreamX2(BYTE* p, BIT_DStream_t* const bitDPtr, BYTE* const pEnd, const HUF_original_DEltX2* const dt, const U32 dtLog, const unsigned padded)
 {
     BYTE* const pStart = p;
+    BYTE* const pLimit = padded ? pEnd : pEnd-3;
+
+    /* fast loop : unchecked reloads */
+    if (MEM_64bits() && (BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished)) {
+        size_t nbRounds;
+        while ((nbRounds = HUF_original_nbFastRounds(bitDPtr, 4*dtLog, p, pLimit, 4)) > 0) {
+            do {
+                HUF_original_DECODE_SYMBOLX2_2(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX2_1(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX2_2(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX2_0(p, bitDPtr);
+                BIT_reloadDStreamFast(bitDPtr);
+            } while (--nbRounds);
+    }   }
 
     /* up to 4 symbols at a time */
-    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p <= pEnd-4)) {
+    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p < pLimit)) {
         HUF_original_DECODE_SYMBOLX2_2(p, bitDPtr);
         HUF_original_DECODE_SYMBOLX2_1(p, bitDPtr);
         HUF_original_DECODE_SYMBOLX2_2(p, bitDPtr);
@@ -180,13 +337,13 @@ static inline size_t HUF_original_decodeStreamX2(BYTE* p, BIT_DStream_t* const b
     while (p < pEnd)
         HUF_original_DECODE_SYMBOLX2_0(p, bitDPtr);
 
-    return pEnd-pStart;
+    return p-pStart;
 }
 
-static size_t HUF_original_decompress1X2_usingDTable_internal(
+FORCE_INLINE size_t HUF_original_decompress1X2_usingDTable_body(
           void* dst,  size_t dstSize,
     const void* cSrc, size_t cSrcSize,
-    const HUF_original_DTable* DTable)
+    const HUF_original_DTable* DTable, unsigned padded)
 {
     BYTE* op = (BYTE*)dst;
     BYTE* const oend = op + dstSize;
@@ -199,7 +356,7 @@ static size_t HUF_original_decompress1X2_usingDTable_internal(
     { size_t const errorCode = BIT_initDStream(&bitD, cSrc, cSrcSize);
       if (HUF_original_isError(errorCode)) return errorCode; }
 
-    HUF_original_decodeStreamX2(op, &bitD, oend, dt, dtLog);
+    if (HUF_original_decodeStreamX2(op, &bitD, oend, dt, dtLog, padded) != dstSize) return ERROR(corruption_detected);
 
     /* check */
     if (!BIT_endOfDStream(&bitD)) return ERROR(corruption_detected);
@@ -207,6 +364,8 @@ static size_t HUF_original_decompress1X2_usingDTable_internal(
     return dstSize;
 }
 
+HUF_original_DGEN(HUF_original_decompress1X2_usingDTable)
+
 size_t HUF_original_decompress1X2_usingDTable(
           void* dst,  size_t dstSize,
     const void* cSrc, size_t cSrcSize,
@@ -214,7 +373,7 @@ size_t HUF_original_decompress1X2_usingDTable(
 {
     DTableDesc dtd = HUF_original_getDTableDesc(DTable);
     if (dtd.tableType != 0) return ERROR(GENERIC);
-    return HUF_original_decompress1X2_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable);
+    return HUF_original_decompress1X2_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 0);
 }
 
 size_t HUF_original_decompress1X2_DCtx (HUF_original_DTable* DCtx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
@@ -226,7 +385,7 @@ size_t HUF_original_decompress1X2_DCtx (HUF_original_DTable* DCtx, void* dst, si
     if (hSize >= cSrcSize) return ERROR(srcSize_wrong);
     ip += hSize; cSrcSize -= hSize;
 
-    return HUF_original_decompress1X2_usingDTable_internal (dst, dstSize, ip, cSrcSize, DCtx);
+    return HUF_original_decompress1X2_usingDTable_internal (dst, dstSize, ip, cSrcSize, DCtx, 0);
 }
 
 size_t HUF_original_decompress1X2 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
@@ -236,13 +395,86 @@ size_t HUF_original_decompress1X2 (void* dst, size_t dstSize, const void* cSrc,
 }
 
 
-static size_t HUF_original_decompress4X2_usingDTable_internal(
+FORCE_INLINE size_t HUF_original_decompress8X2_usingDTable_body(
           void* dst,  size_t dstSize,
     const void* cSrc, size_t cSrcSize,
-    const HUF_original_DTable* DTable)
+    const HUF_original_DTable* DTable, unsigned padded)
 {
+    BYTE* const oend = (BYTE*)dst + dstSize;
+    const void* const dtPtr = DTable + 1;
+    const HUF_original_DEltX2* const dt = (const HUF_original_DEltX2*)dtPtr;
+    BYTE* const olimit = padded ? oend : oend-7;   /* padded : last round may overrun a segment, on corrupted input only */
+    DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
+    U32 const dtLog = dtd.tableLog;
+    BIT_DStream_t bitD[8];
+    BYTE* opStart[9];
+    BYTE* op[8];
+    U32 endSignal;
+    U32 n;
+
+    /* Init */
+    {   size_t const errorCode = HUF_original_init8X(bitD, opStart, dst, dstSize, cSrc, cSrcSize);
+        if (HUF_original_isError(errorCode)) return errorCode; }
+    for (n=0; n<8; n++) op[n] = opStart[n];
+
+    /* 32-64 symbols per loop (4-8 symbols per stream) */
+    endSignal = HUF_original_RELOAD_8X();
+    /* fast loop : unchecked reloads */
+    if (MEM_64bits() && (endSignal==BIT_DStream_unfinished)) {
+        for (;;) {
+            size_t nbRounds = HUF_original_nbFastRounds(bitD+7, 4*dtLog, op[7], olimit, 4);
+            for (n=0; n<7; n++) {
+                size_t const nbRoundsN = BIT_nbFastReloads(bitD+n, 4*dtLog);
+                nbRounds = HUF_original_MIN(nbRounds, nbRoundsN);
+            }
+            if (nbRounds == 0) break;
+            do {
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_2);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_1);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_2);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_0);
+                HUF_original_RELOAD_FAST_8X();
+            } while (--nbRounds);
+    }   }
+
+    for ( ; (endSignal==BIT_DStream_unfinished) && (op[7]<olimit) ; ) {
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_2);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_1);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_2);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX2_0);
+        endSignal = HUF_original_RELOAD_8X();
+    }
+
+    /* check corruption */
+    for (n=0; n<8; n++)
+        if (op[n] > opStart[n+1]) return ERROR(corruption_detected);   /* last one only possible when padded */
+
+    /* finish bitStreams one by one */
+    for (n=0; n<8; n++)
+        if (HUF_original_decodeStreamX2(op[n], bitD+n, opStart[n+1], dt, dtLog, padded) != (size_t)(opStart[n+1]-op[n]))
+            return ERROR(corruption_detected);
+
+    /* check */
+    for (n=0; n<8; n++)
+        if (!BIT_endOfDStream(bitD+n)) return ERROR(corruption_detected);
+
+    /* decoded size */
+    return dstSize;
+}
+
+HUF_original_DGEN(HUF_original_decompress8X2_usingDTable)
+
+
+FORCE_INLINE size_t HUF_original_decompress4X2_usingDTable_body(
+          void* dst,  size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const HUF_original_DTable* DTable, unsigned padded)
+{
+    size_t const entrySize = HUF_original_JUMPTABLE_ENTRY_SIZE(dstSize);
+
     /* Check */
-    if (cSrcSize < 10) return ERROR(corruption_detected);  /* strict minimum : jump table + 1 byte per stream */
+    if (cSrcSize < 3*entrySize + 4) return ERROR(corruption_detected);  /* strict minimum : jump table + 1 byte per stream */
+    if (HUF_original_is8X(cSrc, dstSize)) return HUF_original_decompress8X2_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, padded);
 
     {   const BYTE* const istart = (const BYTE*) cSrc;
         BYTE* const ostart = (BYTE*) dst;
@@ -255,11 +487,11 @@ static size_t HUF_original_decompress4X2_usingDTable_internal(
         BIT_DStream_t bitD2;
         BIT_DStream_t bitD3;
         BIT_DStream_t bitD4;
-        size_t const length1 = MEM_readLE16(istart);
-        size_t const length2 = MEM_readLE16(istart+2);
-        size_t const length3 = MEM_readLE16(istart+4);
-        size_t const length4 = cSrcSize - (length1 + length2 + length3 + 6);
-        const BYTE* const istart1 = istart + 6;  /* jumpTable */
+        size_t const length1 = HUF_original_readJumpEntry(istart, entrySize);
+        size_t const length2 = HUF_original_readJumpEntry(istart+entrySize, entrySize);
+        size_t const length3 = HUF_original_readJumpEntry(istart+2*entrySize, entrySize);
+        size_t const length4 = cSrcSize - (length1 + length2 + length3 + 3*entrySize);
+        const BYTE* const istart1 = istart + 3*entrySize;  /* jumpTable */
         const BYTE* const istart2 = istart1 + length1;
         const BYTE* const istart3 = istart2 + length2;
         const BYTE* const istart4 = istart3 + length3;
@@ -271,10 +503,12 @@ static size_t HUF_original_decompress4X2_usingDTable_internal(
         BYTE* op2 = opStart2;
         BYTE* op3 = opStart3;
         BYTE* op4 = opStart4;
+        BYTE* const olimit = padded ? oend : oend-7;   /* padded : last round may overrun a segment, on corrupted input only */
         U32 endSignal;
         DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
         U32 const dtLog = dtd.tableLog;
 
+        if ((length1 > cSrcSize) | (length2 > cSrcSize) | (length3 > cSrcSize)) return ERROR(corruption_detected);   /* prevents sum overflow of large jump tables */
         if (length4 > cSrcSize) return ERROR(corruption_detected);   /* overflow */
         { size_t const errorCode = BIT_initDStream(&bitD1, istart1, length1);
           if (HUF_original_isError(errorCode)) return errorCode; }
@@ -287,7 +521,20 @@ static size_t HUF_original_decompress4X2_usingDTable_internal(
 
         /* 16-32 symbols per loop (4-8 symbols per stream) */
         endSignal = BIT_reloadDStream(&bitD1) | BIT_reloadDStream(&bitD2) | BIT_reloadDStream(&bitD3) | BIT_reloadDStream(&bitD4);
-        for ( ; (endSignal==BIT_DStream_unfinished) && (op4<(oend-7)) ; ) {
+        /* fast loop : unchecked reloads */
+        if (MEM_64bits() && (endSignal==BIT_DStream_unfinished)) {
+            size_t nbRounds;
+            while ((nbRounds = HUF_original_nbFastRounds4(&bitD1, &bitD2, &bitD3, &bitD4, 4*dtLog, op4, olimit, 4)) > 0) {
+                do {
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX2_2);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX2_1);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX2_2);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX2_0);
+                    HUF_original_RELOAD_FAST_4X();
+                } while (--nbRounds);
+        }   }
+
+        for ( ; (endSignal==BIT_DStream_unfinished) && (op4<olimit) ; ) {
             HUF_original_DECODE_SYMBOLX2_2(op1, &bitD1);
             HUF_original_DECODE_SYMBOLX2_2(op2, &bitD2);
             HUF_original_DECODE_SYMBOLX2_2(op3, &bitD3);
@@ -311,13 +558,13 @@ static size_t HUF_original_decompress4X2_usingDTable_internal(
         if (op1 > opStart2) return ERROR(corruption_detected);
         if (op2 > opStart3) return ERROR(corruption_detected);
         if (op3 > opStart4) return ERROR(corruption_detected);
-        /* note : op4 supposed already verified within main loop */
+        if (op4 > oend) return ERROR(corruption_detected);   /* only possible when padded */
 
         /* finish bitStreams one by one */
-        HUF_original_decodeStreamX2(op1, &bitD1, opStart2, dt, dtLog);
-        HUF_original_decodeStreamX2(op2, &bitD2, opStart3, dt, dtLog);
-        HUF_original_decodeStreamX2(op3, &bitD3, opStart4, dt, dtLog);
-        HUF_original_decodeStreamX2(op4, &bitD4, oend,     dt, dtLog);
+        if (HUF_original_decodeStreamX2(op1, &bitD1, opStart2, dt, dtLog, padded) != (size_t)(opStart2-op1)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX2(op2, &bitD2, opStart3, dt, dtLog, padded) != (size_t)(opStart3-op2)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX2(op3, &bitD3, opStart4, dt, dtLog, padded) != (size_t)(opStart4-op3)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX2(op4, &bitD4, oend,     dt, dtLog, padded) != (size_t)(oend-op4))     return ERROR(corruption_detected);
 
         /* check */
         endSignal = BIT_endOfDStream(&bitD1) & BIT_endOfDStream(&bitD2) & BIT_endOfDStream(&bitD3) & BIT_endOfDStream(&bitD4);
@@ -328,6 +575,8 @@ static size_t HUF_original_decompress4X2_usingDTable_internal(
     }
 }
 
+HUF_original_DGEN(HUF_original_decompress4X2_usingDTable)
+
 
 size_t HUF_original_decompress4X2_usingDTable(
           void* dst,  size_t dstSize,
@@ -336,7 +585,7 @@ size_t HUF_original_decompress4X2_usingDTable(
 {
     DTableDesc dtd = HUF_original_getDTableDesc(DTable);
     if (dtd.tableType != 0) return ERROR(GENERIC);
-    return HUF_original_decompress4X2_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable);
+    return HUF_original_decompress4X2_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 0);
 }
 
 
@@ -349,7 +598,7 @@ size_t HUF_original_decompress4X2_DCtx (HUF_original_DTable* dctx, void* dst, si
     if (hSize >= cSrcSize) return ERROR(srcSize_wrong);
     ip += hSize; cSrcSize -= hSize;
 
-    return HUF_original_decompress4X2_usingDTable_internal (dst, dstSize, ip, cSrcSize, dctx);
+    return HUF_original_decompress4X2_usingDTable_internal (dst, dstSize, ip, cSrcSize, dctx, 0);
 }
 
 size_t HUF_original_decompress4X2 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
@@ -366,88 +615,147 @@ typedef struct { U16 sequence; BYTE nbBits; BYTE length; } HUF_original_DEltX4;
 
 typedef struct { BYTE symbol; BYTE weight; } sortedSymbol_t;
 
-static void HUF_original_fillDTableX4Level2(HUF_original_DEltX4* DTable, U32 sizeLog, const U32 consumed,
-                           const U32* rankValOrigin, const int minWeight,
-                           const sortedSymbol_t* sortedSymbols, const U32 sortedListSize,
-                           U32 nbBitsBaseline, U16 baseSeq)
+/* HUF_original_buildDEltX4x2() :
+ * @return : 2 identical HUF_original_DEltX4 cells packed into a U64, so that ranges are filled with 8-bytes stores */
+FORCE_INLINE U64 HUF_original_buildDEltX4x2(U32 sequence, U32 nbBits, U32 length)
 {
     HUF_original_DEltX4 DElt;
-    U32 rankVal[HUF_original_TABLELOG_ABSOLUTEMAX + 1];
+    U32 DElt32;
+    MEM_writeLE16(&(DElt.sequence), (U16)sequence);
+    DElt.nbBits = (BYTE)nbBits;
+    DElt.length = (BYTE)length;
+    memcpy(&DElt32, &DElt, sizeof(DElt32));
+    return DElt32 + ((U64)DElt32 << 32);
+}
 
-    /* get pre-calculated rankVal */
-    memcpy(rankVal, rankValOrigin, sizeof(rankVal));
+/* HUF_original_fillDTableX4ForWeight() :
+ * symbols in [begin, end[ share the same weight, hence the same range length,
+ * so each range is filled with a fixed number of 8-bytes stores, selected once per weight.
+ * level 1 : cells decode `symbol` alone; level 2 : cells decode `baseSeq` followed by `symbol`. */
+FORCE_INLINE void HUF_original_fillDTableX4ForWeight(HUF_original_DEltX4* DTableRank,
+                           const sortedSymbol_t* begin, const sortedSymbol_t* end,
+                           U32 totalBits, U32 targetLog, U32 baseSeq, U32 const level)
+{
+    U32 const length = 1U << ((targetLog - totalBits) & 0x1F);
+    const sortedSymbol_t* ptr;
+#   define HUF_original_DELTX4X2(ptr) HUF_original_buildDEltX4x2(level==1 ? (ptr)->symbol : baseSeq + ((U32)(ptr)->symbol << 8), totalBits, level)
+    switch (length) {
+    case 1:
+        for (ptr = begin; ptr != end; ptr++) {
+            U64 const DElt2 = HUF_original_DELTX4X2(ptr);
+            memcpy(DTableRank, &DElt2, sizeof(HUF_original_DEltX4));
+            DTableRank += 1;
+        }
+        break;
+    case 2:
+        for (ptr = begin; ptr != end; ptr++) {
+            U64 const DElt2 = HUF_original_DELTX4X2(ptr);
+            memcpy(DTableRank, &DElt2, 8);
+            DTableRank += 2;
+        }
+        break;
+    case 4:
+        for (ptr = begin; ptr != end; ptr++) {
+            U64 const DElt2 = HUF_original_DELTX4X2(ptr);
+            memcpy(DTableRank + 0, &DElt2, 8);
+            memcpy(DTableRank + 2, &DElt2, 8);
+            DTableRank += 4;
+        }
+        break;
+    default:   /* length >= 8 */
+        for (ptr = begin; ptr != end; ptr++) {
+            U64 const DElt2 = HUF_original_DELTX4X2(ptr);
+            HUF_original_DEltX4* const DTableRankEnd = DTableRank + length;
+            for (; DTableRank != DTableRankEnd; DTableRank += 8) {
+                memcpy(DTableRank + 0, &DElt2, 8);
+                memcpy(DTableRank + 2, &DElt2, 8);
+                memcpy(DTableRank + 4, &DElt2, 8);
+                memcpy(DTableRank + 6, &DElt2, 8);
+        }   }
+        break;
+    }
+#   undef HUF_original_DELTX4X2
+}
 
-    /* fill skipped values */
+/* HUF_original_fillDTableX4Level2() :
+ * fills the (1 << (targetLog-consumed)) cells which start with first symbol `baseSeq`.
+ * rankStart[w] is the first sorted symbol of weight w, rankStart[maxWeight+1] the end of the sorted list. */
+static void HUF_original_fillDTableX4Level2(HUF_original_DEltX4* DTable, U32 targetLog, const U32 consumed,
+                           const U32* rankVal, const int minWeight, const U32 maxWeight,
+                           const sortedSymbol_t* sortedSymbols, const U32* rankStart,
+                           U32 nbBitsBaseline, U16 baseSeq)
+{
+    /* fill skipped values (all cells whose second symbol doesn't fit) :
+     * the range is a power of 2 >= 2, so it is filled by whole 8-bytes stores ;
+     * cells written beyond skipSize are overwritten by the second symbols below */
     if (minWeight>1) {
-        U32 i, skipSize = rankVal[minWeight];
-        MEM_writeLE16(&(DElt.sequence), baseSeq);
-        DElt.nbBits   = (BYTE)(consumed);
-        DElt.length   = 1;
-        for (i = 0; i < skipSize; i++)
-            DTable[i] = DElt;
+        U32 const length = 1U << ((targetLog - consumed) & 0x1F);
+        U64 const DElt2 = HUF_original_buildDEltX4x2(baseSeq, consumed, 1);
+        U32 const skipSize = rankVal[minWeight];
+        switch (length) {
+        case 2:
+            memcpy(DTable, &DElt2, 8);
+            break;
+        case 4:
+            memcpy(DTable + 0, &DElt2, 8);
+            memcpy(DTable + 2, &DElt2, 8);
+            break;
+        default:
+            {   U32 i;
+                for (i = 0; i < skipSize; i += 8) {
+                    memcpy(DTable + i + 0, &DElt2, 8);
+                    memcpy(DTable + i + 2, &DElt2, 8);
+                    memcpy(DTable + i + 4, &DElt2, 8);
+                    memcpy(DTable + i + 6, &DElt2, 8);
+        }   }   }
     }
 
-    /* fill DTable */
-    { U32 s; for (s=0; s<sortedListSize; s++) {   /* note : sortedSymbols already skipped */
-        const U32 symbol = sortedSymbols[s].symbol;
-        const U32 weight = sortedSymbols[s].weight;
-        const U32 nbBits = nbBitsBaseline - weight;
-        const U32 length = 1 << (sizeLog-nbBits);
-        const U32 start = rankVal[weight];
-        U32 i = start;
-        const U32 end = start + length;
-
-        MEM_writeLE16(&(DElt.sequence), (U16)(baseSeq + (symbol << 8)));
-        DElt.nbBits = (BYTE)(nbBits + consumed);
-        DElt.length = 2;
-        do { DTable[i++] = DElt; } while (i<end);   /* since length >= 1 */
-
-        rankVal[weight] += length;
-    }}
+    /* fill DTable, one weight at a time; rankVal[w] is the first cell of weight w */
+    {   U32 w;
+        for (w = minWeight; w < maxWeight+1; w++) {
+            U32 const totalBits = nbBitsBaseline - w + consumed;
+            HUF_original_fillDTableX4ForWeight(DTable + rankVal[w],
+                           sortedSymbols + rankStart[w], sortedSymbols + rankStart[w+1],
+                           totalBits, targetLog, baseSeq, 2);
+    }   }
 }
 
 typedef U32 rankVal_t[HUF_original_TABLELOG_ABSOLUTEMAX][HUF_original_TABLELOG_ABSOLUTEMAX + 1];
 
 static void HUF_original_fillDTableX4(HUF_original_DEltX4* DTable, const U32 targetLog,
-                           const sortedSymbol_t* sortedList, const U32 sortedListSize,
+                           const sortedSymbol_t* sortedList,
                            const U32* rankStart, rankVal_t rankValOrigin, const U32 maxWeight,
                            const U32 nbBitsBaseline)
 {
-    U32 rankVal[HUF_original_TABLELOG_ABSOLUTEMAX + 1];
+    const U32* const rankVal = rankValOrigin[0];
     const int scaleLog = nbBitsBaseline - targetLog;   /* note : targetLog >= srcLog, hence scaleLog <= 1 */
     const U32 minBits  = nbBitsBaseline - maxWeight;
-    U32 s;
-
-    memcpy(rankVal, rankValOrigin, sizeof(rankVal));
+    U32 w;
 
-    /* fill DTable */
-    for (s=0; s<sortedListSize; s++) {
-        const U16 symbol = sortedList[s].symbol;
-        const U32 weight = sortedList[s].weight;
-        const U32 nbBits = nbBitsBaseline - weight;
-        const U32 start = rankVal[weight];
-        const U32 length = 1 << (targetLog-nbBits);
+    /* fill DTable, one weight at a time : all symbols of a weight share nbBits and range length */
+    for (w=1; w<maxWeight+1; w++) {
+        U32 const begin = rankStart[w];
+        U32 const end = rankStart[w+1];
+        U32 const nbBits = nbBitsBaseline - w;
 
         if (targetLog-nbBits >= minBits) {   /* enough room for a second symbol */
-            U32 sortedRank;
+            U32 const length = 1U << ((targetLog-nbBits) & 0x1F);
+            U32 start = rankVal[w];
             int minWeight = nbBits + scaleLog;
+            U32 s;
             if (minWeight < 1) minWeight = 1;
-            sortedRank = rankStart[minWeight];
-            HUF_original_fillDTableX4Level2(DTable+start, targetLog-nbBits, nbBits,
-                           rankValOrigin[nbBits], minWeight,
-                           sortedList+sortedRank, sortedListSize-sortedRank,
-                           nbBitsBaseline, symbol);
+            for (s = begin; s != end; s++) {
+                HUF_original_fillDTableX4Level2(DTable+start, targetLog, nbBits,
+                           rankValOrigin[nbBits], minWeight, maxWeight,
+                           sortedList, rankStart,
+                           nbBitsBaseline, sortedList[s].symbol);
+                start += length;
+            }
         } else {
-            HUF_original_DEltX4 DElt;
-            MEM_writeLE16(&(DElt.sequence), symbol);
-            DElt.nbBits = (BYTE)(nbBits);
-            DElt.length = 1;
-            {   U32 u;
-                const U32 end = start + length;
-                for (u = start; u < end; u++) DTable[u] = DElt;
-        }   }
-        rankVal[weight] += length;
-    }
+            HUF_original_fillDTableX4ForWeight(DTable + rankVal[w],
+                           sortedList + begin, sortedList + end,
+                           nbBits, targetLog, 0, 1);
+    }   }
 }
 
 size_t HUF_original_readDTableX4 (HUF_original_DTable* DTable, const void* src, size_t srcSize)
@@ -458,7 +766,7 @@ size_t HUF_original_readDTableX4 (HUF_original_DTable* DTable, const void* src,
     U32 rankStart0[HUF_original_TABLELOG_ABSOLUTEMAX + 2] = { 0 };
     U32* const rankStart = rankStart0+1;
     rankVal_t rankVal;
-    U32 tableLog, maxW, sizeOfSort, nbSymbols;
+    U32 tableLog, maxW, nbSymbols;
     DTableDesc dtd = HUF_original_getDTableDesc(DTable);
     U32 const maxTableLog = dtd.maxTableLog;
     size_t iSize;
@@ -486,7 +794,6 @@ size_t HUF_original_readDTableX4 (HUF_original_DTable* DTable, const void* src,
             rankStart[w] = current;
         }
         rankStart[0] = nextRankStart;   /* put all 0w symbols at the end of sorted list*/
-        sizeOfSort = nextRankStart;
     }
 
     /* sort symbols by weight */
@@ -498,7 +805,7 @@ size_t HUF_original_readDTableX4 (HUF_original_DTable* DTable, const void* src,
             sortedSymbol[r].weight = (BYTE)w;
         }
         rankStart[0] = 0;   /* forget 0w symbols; this is beginning of weight(1) */
-    }
+    }   /* now rankStart0[w] is the beginning of weight w, and rankStart0[maxW+1] the end of sorted list */
 
     /* Build rankVal */
     {   U32* const rankVal0 = rankVal[0];
@@ -520,7 +827,7 @@ size_t HUF_original_readDTableX4 (HUF_original_DTable* DTable, const void* src,
     }   }   }   }
 
     HUF_original_fillDTableX4(dt, maxTableLog,
-                   sortedSymbol, sizeOfSort,
+                   sortedSymbol,
                    rankStart0, rankVal, maxW,
                    tableLog+1);
 
@@ -531,7 +838,7 @@ size_t HUF_original_readDTableX4 (HUF_original_DTable* DTable, const void* src,
 }
 
 
-static U32 HUF_original_decodeSymbolX4(void* op, BIT_DStream_t* DStream, const HUF_original_DEltX4* dt, const U32 dtLog)
+FORCE_INLINE U32 HUF_original_decodeSymbolX4(void* op, BIT_DStream_t* DStream, const HUF_original_DEltX4* dt, const U32 dtLog)
 {
     const size_t val = BIT_lookBitsFast(DStream, dtLog);   /* note : dtLog >= 1 */
     memcpy(op, dt+val, 2);
@@ -539,7 +846,7 @@ static U32 HUF_original_decodeSymbolX4(void* op, BIT_DStream_t* DStream, const H
     return dt[val].length;
 }
 
-static U32 HUF_original_decodeLastSymbolX4(void* op, BIT_DStream_t* DStream, const HUF_original_DEltX4* dt, const U32 dtLog)
+FORCE_INLINE U32 HUF_original_decodeLastSymbolX4(void* op, BIT_DStream_t* DStream, const HUF_original_DEltX4* dt, const U32 dtLog)
 {
     const size_t val = BIT_lookBitsFast(DStream, dtLog);   /* note : dtLog >= 1 */
     memcpy(op, dt+val, 1);
@@ -565,12 +872,27 @@ static U32 HUF_original_decodeLastSymbolX4(void* op, BIT_DStream_t* DStream, con
     if (MEM_64bits()) \
         ptr += HUF_original_decodeSymbolX4(ptr, DStreamPtr, dt, dtLog)
 
-static inline size_t HUF_original_decodeStreamX4(BYTE* p, BIT_DStream_t* bitDPtr, BYTE* const pEnd, const HUF_original_DEltX4* const dt, const U32 dtLog)
+/* padded : `pEnd` may be overrun by up to 7 bytes, which only happens on corrupted input.
+ * @return : nb of decoded bytes, which is `pEnd-p` on valid input */
+FORCE_INLINE size_t HUF_original_decodeStreamX4(BYTE* p, BIT_DStream_t* bitDPtr, BYTE* const pEnd, const HUF_original_DEltX4* const dt, const U32 dtLog, const unsigned padded)
 {
     BYTE* const pStart = p;
 
+    /* fast loop : unchecked reloads */
+    if (MEM_64bits() && (BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished)) {
+        size_t nbRounds;
+        while ((nbRounds = HUF_original_nbFastRounds(bitDPtr, 4*dtLog, p, (padded ? pEnd : pEnd-7), 8)) > 0) {
+            do {
+                HUF_original_DECODE_SYMBOLX4_2(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX4_1(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX4_2(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX4_0(p, bitDPtr);
+                BIT_reloadDStreamFast(bitDPtr);
+            } while (--nbRounds);
+    }   }
+
     /* up to 8 symbols at a time */
-    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p < pEnd-7)) {
+    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p < (padded ? pEnd : pEnd-7))) {
         HUF_original_DECODE_SYMBOLX4_2(p, bitDPtr);
         HUF_original_DECODE_SYMBOLX4_1(p, bitDPtr);
         HUF_original_DECODE_SYMBOLX4_2(p, bitDPtr);
@@ -578,7 +900,7 @@ static inline size_t HUF_original_decodeStreamX4(BYTE* p, BIT_DStream_t* bitDPtr
     }
 
     /* closer to end : up to 2 symbols at a time */
-    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p <= pEnd-2))
+    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p < (padded ? pEnd : pEnd-1)))
         HUF_original_DECODE_SYMBOLX4_0(p, bitDPtr);
 
     while (p <= pEnd-2)
@@ -591,10 +913,10 @@ static inline size_t HUF_original_decodeStreamX4(BYTE* p, BIT_DStream_t* bitDPtr
 }
 
 
-static size_t HUF_original_decompress1X4_usingDTable_internal(
+FORCE_INLINE size_t HUF_original_decompress1X4_usingDTable_body(
           void* dst,  size_t dstSize,
     const void* cSrc, size_t cSrcSize,
-    const HUF_original_DTable* DTable)
+    const HUF_original_DTable* DTable, unsigned padded)
 {
     BIT_DStream_t bitD;
 
@@ -609,7 +931,7 @@ static size_t HUF_original_decompress1X4_usingDTable_internal(
         const void* const dtPtr = DTable+1;   /* force compiler to not use strict-aliasing */
         const HUF_original_DEltX4* const dt = (const HUF_original_DEltX4*)dtPtr;
         DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
-        HUF_original_decodeStreamX4(ostart, &bitD, oend, dt, dtd.tableLog);
+        if (HUF_original_decodeStreamX4(ostart, &bitD, oend, dt, dtd.tableLog, padded) != dstSize) return ERROR(corruption_detected);
     }
 
     /* check */
@@ -619,6 +941,8 @@ static size_t HUF_original_decompress1X4_usingDTable_internal(
     return dstSize;
 }
 
+HUF_original_DGEN(HUF_original_decompress1X4_usingDTable)
+
 size_t HUF_original_decompress1X4_usingDTable(
           void* dst,  size_t dstSize,
     const void* cSrc, size_t cSrcSize,
@@ -626,7 +950,7 @@ size_t HUF_original_decompress1X4_usingDTable(
 {
     DTableDesc dtd = HUF_original_getDTableDesc(DTable);
     if (dtd.tableType != 1) return ERROR(GENERIC);
-    return HUF_original_decompress1X4_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable);
+    return HUF_original_decompress1X4_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 0);
 }
 
 size_t HUF_original_decompress1X4_DCtx (HUF_original_DTable* DCtx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
@@ -638,7 +962,7 @@ size_t HUF_original_decompress1X4_DCtx (HUF_original_DTable* DCtx, void* dst, si
     if (hSize >= cSrcSize) return ERROR(srcSize_wrong);
     ip += hSize; cSrcSize -= hSize;
 
-    return HUF_original_decompress1X4_usingDTable_internal (dst, dstSize, ip, cSrcSize, DCtx);
+    return HUF_original_decompress1X4_usingDTable_internal (dst, dstSize, ip, cSrcSize, DCtx, 0);
 }
 
 size_t HUF_original_decompress1X4 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
@@ -647,12 +971,85 @@ size_t HUF_original_decompress1X4 (void* dst, size_t dstSize, const void* cSrc,
     return HUF_original_decompress1X4_DCtx(DTable, dst, dstSize, cSrc, cSrcSize);
 }
 
-static size_t HUF_original_decompress4X4_usingDTable_internal(
+FORCE_INLINE size_t HUF_original_decompress8X4_usingDTable_body(
           void* dst,  size_t dstSize,
     const void* cSrc, size_t cSrcSize,
-    const HUF_original_DTable* DTable)
+    const HUF_original_DTable* DTable, unsigned padded)
 {
-    if (cSrcSize < 10) return ERROR(corruption_detected);   /* strict minimum : jump table + 1 byte per stream */
+    BYTE* const oend = (BYTE*)dst + dstSize;
+    const void* const dtPtr = DTable + 1;
+    const HUF_original_DEltX4* const dt = (const HUF_original_DEltX4*)dtPtr;
+    BYTE* const olimit = padded ? oend : oend-7;   /* padded : last round may overrun a segment, on corrupted input only */
+    DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
+    U32 const dtLog = dtd.tableLog;
+    BIT_DStream_t bitD[8];
+    BYTE* opStart[9];
+    BYTE* op[8];
+    U32 endSignal;
+    U32 n;
+
+    /* Init */
+    {   size_t const errorCode = HUF_original_init8X(bitD, opStart, dst, dstSize, cSrc, cSrcSize);
+        if (HUF_original_isError(errorCode)) return errorCode; }
+    for (n=0; n<8; n++) op[n] = opStart[n];
+
+    /* 32-64 symbols per loop (4-8 symbols per stream) */
+    endSignal = HUF_original_RELOAD_8X();
+    /* fast loop : unchecked reloads */
+    if (MEM_64bits() && (endSignal==BIT_DStream_unfinished)) {
+        for (;;) {
+            size_t nbRounds = HUF_original_nbFastRounds(bitD+7, 4*dtLog, op[7], olimit, 8);
+            for (n=0; n<7; n++) {
+                size_t const nbRoundsN = BIT_nbFastReloads(bitD+n, 4*dtLog);
+                nbRounds = HUF_original_MIN(nbRounds, nbRoundsN);
+            }
+            if (nbRounds == 0) break;
+            do {
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_2);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_1);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_2);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_0);
+                HUF_original_RELOAD_FAST_8X();
+            } while (--nbRounds);
+    }   }
+
+    for ( ; (endSignal==BIT_DStream_unfinished) && (op[7]<olimit) ; ) {
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_2);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_1);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_2);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX4_0);
+        endSignal = HUF_original_RELOAD_8X();
+    }
+
+    /* check corruption */
+    for (n=0; n<8; n++)
+        if (op[n] > opStart[n+1]) return ERROR(corruption_detected);   /* last one only possible when padded */
+
+    /* finish bitStreams one by one */
+    for (n=0; n<8; n++)
+        if (HUF_original_decodeStreamX4(op[n], bitD+n, opStart[n+1], dt, dtLog, padded) != (size_t)(opStart[n+1]-op[n]))
+            return ERROR(corruption_detected);
+
+    /* check */
+    for (n=0; n<8; n++)
+        if (!BIT_endOfDStream(bitD+n)) return ERROR(corruption_detected);
+
+    /* decoded size */
+    return dstSize;
+}
+
+HUF_original_DGEN(HUF_original_decompress8X4_usingDTable)
+
+
+FORCE_INLINE size_t HUF_original_decompress4X4_usingDTable_body(
+          void* dst,  size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const HUF_original_DTable* DTable, unsigned padded)
+{
+    size_t const entrySize = HUF_original_JUMPTABLE_ENTRY_SIZE(dstSize);
+
+    if (cSrcSize < 3*entrySize + 4) return ERROR(corruption_detected);   /* strict minimum : jump table + 1 byte per stream */
+    if (HUF_original_is8X(cSrc, dstSize)) return HUF_original_decompress8X4_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, padded);
 
     {   const BYTE* const istart = (const BYTE*) cSrc;
         BYTE* const ostart = (BYTE*) dst;
@@ -665,11 +1062,11 @@ static size_t HUF_original_decompress4X4_usingDTable_internal(
         BIT_DStream_t bitD2;
         BIT_DStream_t bitD3;
         BIT_DStream_t bitD4;
-        size_t const length1 = MEM_readLE16(istart);
-        size_t const length2 = MEM_readLE16(istart+2);
-        size_t const length3 = MEM_readLE16(istart+4);
-        size_t const length4 = cSrcSize - (length1 + length2 + length3 + 6);
-        const BYTE* const istart1 = istart + 6;  /* jumpTable */
+        size_t const length1 = HUF_original_readJumpEntry(istart, entrySize);
+        size_t const length2 = HUF_original_readJumpEntry(istart+entrySize, entrySize);
+        size_t const length3 = HUF_original_readJumpEntry(istart+2*entrySize, entrySize);
+        size_t const length4 = cSrcSize - (length1 + length2 + length3 + 3*entrySize);
+        const BYTE* const istart1 = istart + 3*entrySize;  /* jumpTable */
         const BYTE* const istart2 = istart1 + length1;
         const BYTE* const istart3 = istart2 + length2;
         const BYTE* const istart4 = istart3 + length3;
@@ -681,10 +1078,12 @@ static size_t HUF_original_decompress4X4_usingDTable_internal(
         BYTE* op2 = opStart2;
         BYTE* op3 = opStart3;
         BYTE* op4 = opStart4;
+        BYTE* const olimit = padded ? oend : oend-7;   /* padded : last round may overrun a segment, on corrupted input only */
         U32 endSignal;
         DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
         U32 const dtLog = dtd.tableLog;
 
+        if ((length1 > cSrcSize) | (length2 > cSrcSize) | (length3 > cSrcSize)) return ERROR(corruption_detected);   /* prevents sum overflow of large jump tables */
         if (length4 > cSrcSize) return ERROR(corruption_detected);   /* overflow */
         { size_t const errorCode = BIT_initDStream(&bitD1, istart1, length1);
           if (HUF_original_isError(errorCode)) return errorCode; }
@@ -697,7 +1096,20 @@ static size_t HUF_original_decompress4X4_usingDTable_internal(
 
         /* 16-32 symbols per loop (4-8 symbols per stream) */
         endSignal = BIT_reloadDStream(&bitD1) | BIT_reloadDStream(&bitD2) | BIT_reloadDStream(&bitD3) | BIT_reloadDStream(&bitD4);
-        for ( ; (endSignal==BIT_DStream_unfinished) && (op4<(oend-7)) ; ) {
+        /* fast loop : unchecked reloads */
+        if (MEM_64bits() && (endSignal==BIT_DStream_unfinished)) {
+            size_t nbRounds;
+            while ((nbRounds = HUF_original_nbFastRounds4(&bitD1, &bitD2, &bitD3, &bitD4, 4*dtLog, op4, olimit, 8)) > 0) {
+                do {
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX4_2);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX4_1);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX4_2);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX4_0);
+                    HUF_original_RELOAD_FAST_4X();
+                } while (--nbRounds);
+        }   }
+
+        for ( ; (endSignal==BIT_DStream_unfinished) && (op4<olimit) ; ) {
             HUF_original_DECODE_SYMBOLX4_2(op1, &bitD1);
             HUF_original_DECODE_SYMBOLX4_2(op2, &bitD2);
             HUF_original_DECODE_SYMBOLX4_2(op3, &bitD3);
@@ -722,13 +1134,13 @@ static size_t HUF_original_decompress4X4_usingDTable_internal(
         if (op1 > opStart2) return ERROR(corruption_detected);
         if (op2 > opStart3) return ERROR(corruption_detected);
         if (op3 > opStart4) return ERROR(corruption_detected);
-        /* note : op4 supposed already verified within main loop */
+        if (op4 > oend) return ERROR(corruption_detected);   /* only possible when padded */
 
         /* finish bitStreams one by one */
-        HUF_original_decodeStreamX4(op1, &bitD1, opStart2, dt, dtLog);
-        HUF_original_decodeStreamX4(op2, &bitD2, opStart3, dt, dtLog);
-        HUF_original_decodeStreamX4(op3, &bitD3, opStart4, dt, dtLog);
-        HUF_original_decodeStreamX4(op4, &bitD4, oend,     dt, dtLog);
+        if (HUF_original_decodeStreamX4(op1, &bitD1, opStart2, dt, dtLog, padded) != (size_t)(opStart2-op1)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX4(op2, &bitD2, opStart3, dt, dtLog, padded) != (size_t)(opStart3-op2)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX4(op3, &bitD3, opStart4, dt, dtLog, padded) != (size_t)(opStart4-op3)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX4(op4, &bitD4, oend,     dt, dtLog, padded) != (size_t)(oend-op4))     return ERROR(corruption_detected);
 
         /* check */
         { U32 const endCheck = BIT_endOfDStream(&bitD1) & BIT_endOfDStream(&bitD2) & BIT_endOfDStream(&bitD3) & BIT_endOfDStream(&bitD4);
@@ -739,6 +1151,8 @@ static size_t HUF_original_decompress4X4_usingDTable_internal(
     }
 }
 
+HUF_original_DGEN(HUF_original_decompress4X4_usingDTable)
+
 
 size_t HUF_original_decompress4X4_usingDTable(
           void* dst,  size_t dstSize,
@@ -747,7 +1161,7 @@ size_t HUF_original_decompress4X4_usingDTable(
 {
     DTableDesc dtd = HUF_original_getDTableDesc(DTable);
     if (dtd.tableType != 1) return ERROR(GENERIC);
-    return HUF_original_decompress4X4_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable);
+    return HUF_original_decompress4X4_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 0);
 }
 
 
@@ -760,7 +1174,7 @@ size_t HUF_original_decompress4X4_DCtx (HUF_original_DTable* dctx, void* dst, si
     if (hSize >= cSrcSize) return ERROR(srcSize_wrong);
     ip += hSize; cSrcSize -= hSize;
 
-    return HUF_original_decompress4X4_usingDTable_internal(dst, dstSize, ip, cSrcSize, dctx);
+    return HUF_original_decompress4X4_usingDTable_internal(dst, dstSize, ip, cSrcSize, dctx, 0);
 }
 
 size_t HUF_original_decompress4X4 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
@@ -770,6 +1184,526 @@ size_t HUF_original_decompress4X4 (void* dst, size_t dstSize, const void* cSrc,
 }
 
 
+/* ********************************/
+/* quad-symbols decoding          */
+/* ********************************/
+typedef struct { BYTE nbBits; BYTE nbBytes; } HUF_original_DDescX6;
+typedef union { BYTE byte[4]; U32 sequence; } HUF_original_DSeqX6;
+
+/* DTable layout : DTableDesc, then (1<<tableLog) HUF_original_DDescX6, then (1<<tableLog) HUF_original_DSeqX6 */
+
+/* recursive, up to level 3; may benefit from <template>-like strategy to nest each level inline */
+static void HUF_original_fillDTableX6LevelN(HUF_original_DDescX6* DDescription, HUF_original_DSeqX6* DSequence, int sizeLog,
+                           const rankVal_t rankValOrigin, const U32 consumed, const int minWeight, const U32 maxWeight,
+                           const sortedSymbol_t* sortedSymbols, const U32 sortedListSize, const U32* rankStart,
+                           const U32 nbBitsBaseline, HUF_original_DSeqX6 baseSeq, HUF_original_DDescX6 DDesc)
+{
+    const int scaleLog = nbBitsBaseline - sizeLog;   /* note : targetLog >= (nbBitsBaseline-1), hence scaleLog <= 1 */
+    const int minBits  = nbBitsBaseline - maxWeight;
+    const U32 level = DDesc.nbBytes;
+    U32 rankVal[HUF_original_TABLELOG_ABSOLUTEMAX + 1];
+    U32 s;
+
+    /* local rankVal, will be modified */
+    memcpy(rankVal, rankValOrigin[consumed], sizeof(rankVal));
+
+    /* fill skipped values */
+    if (minWeight>1) {
+        U32 i;
+        const U32 skipSize = rankVal[minWeight];
+        for (i = 0; i < skipSize; i++) {
+            DSequence[i] = baseSeq;
+            DDescription[i] = DDesc;
+    }   }
+
+    /* fill DTable */
+    DDesc.nbBytes++;
+    for (s=rankStart[minWeight]; s<sortedListSize; s++) {
+        const BYTE symbol = sortedSymbols[s].symbol;
+        const U32  weight = sortedSymbols[s].weight;   /* >= 1 (sorted) */
+        const int  nbBits = nbBitsBaseline - weight;   /* >= 1 (by construction) */
+        const int  totalBits = consumed+nbBits;
+        const U32  start  = rankVal[weight];
+        const U32  length = 1 << (sizeLog-nbBits);
+        baseSeq.byte[level] = symbol;
+        DDesc.nbBits = (BYTE)totalBits;
+
+        if ((level<3) && (sizeLog-totalBits >= minBits)) {  /* enough room for another symbol; conservative : keeps tables cheap to build */
+            int nextMinWeight = totalBits + scaleLog;
+            if (nextMinWeight < 1) nextMinWeight = 1;
+            HUF_original_fillDTableX6LevelN(DDescription+start, DSequence+start, sizeLog-nbBits,
+                           rankValOrigin, totalBits, nextMinWeight, maxWeight,
+                           sortedSymbols, sortedListSize, rankStart,
+                           nbBitsBaseline, baseSeq, DDesc);   /* recursive (max : level 3) */
+        } else {
+            U32 i;
+            const U32 end = start + length;
+            for (i = start; i < end; i++) {
+                DDescription[i] = DDesc;
+                DSequence[i] = baseSeq;
+        }   }
+        rankVal[weight] += length;
+    }
+}
+
+
+/* note : same preparation as X4 */
+size_t HUF_original_readDTableX6 (HUF_original_DTable* DTable, const void* src, size_t srcSize)
+{
+    BYTE weightList[HUF_original_SYMBOLVALUE_MAX + 1];
+    sortedSymbol_t sortedSymbol[HUF_original_SYMBOLVALUE_MAX + 1];
+    U32 rankStats[HUF_original_TABLELOG_ABSOLUTEMAX + 1] = { 0 };
+    U32 rankStart0[HUF_original_TABLELOG_ABSOLUTEMAX + 2] = { 0 };
+    U32* const rankStart = rankStart0+1;
+    rankVal_t rankVal;
+    U32 tableLog, maxW, sizeOfSort, nbSymbols;
+    DTableDesc dtd = HUF_original_getDTableDesc(DTable);
+    U32 const maxTableLog = dtd.maxTableLog;
+    size_t iSize;
+
+    HUF_original_STATIC_ASSERT(sizeof(HUF_original_DSeqX6) == sizeof(HUF_original_DTable));   /* if compilation fails here, assertion is false */
+    if (maxTableLog > HUF_original_TABLELOG_ABSOLUTEMAX) return ERROR(tableLog_tooLarge);
+
+    iSize = HUF_original_readStats(weightList, HUF_original_SYMBOLVALUE_MAX + 1, rankStats, &nbSymbols, &tableLog, src, srcSize);
+    if (HUF_original_isError(iSize)) return iSize;
+
+    /* check result */
+    if (tableLog > maxTableLog) return ERROR(tableLog_tooLarge);   /* DTable can't fit code depth */
+
+    /* find maxWeight */
+    for (maxW = tableLog; rankStats[maxW]==0; maxW--) {}  /* necessarily finds a solution before 0 */
+
+    /* Get start index of each weight */
+    {   U32 w, nextRankStart = 0;
+        for (w=1; w<maxW+1; w++) {
+            U32 current = nextRankStart;
+            nextRankStart += rankStats[w];
+            rankStart[w] = current;
+        }
+        rankStart[0] = nextRankStart;   /* put all 0w symbols at the end of sorted list*/
+        sizeOfSort = nextRankStart;
+    }
+
+    /* sort symbols by weight */
+    {   U32 s;
+        for (s=0; s<nbSymbols; s++) {
+            U32 const w = weightList[s];
+            U32 const r = rankStart[w]++;
+            sortedSymbol[r].symbol = (BYTE)s;
+            sortedSymbol[r].weight = (BYTE)w;
+        }
+        rankStart[0] = 0;   /* forget 0w symbols; this is beginning of weight(1) */
+    }
+
+    /* Build rankVal */
+    {   U32* const rankVal0 = rankVal[0];
+        {   int const rescale = (maxTableLog-tableLog) - 1;   /* tableLog <= maxTableLog */
+            U32 nextRankVal = 0;
+            U32 w;
+            for (w=1; w<maxW+1; w++) {
+                U32 current = nextRankVal;
+                nextRankVal += rankStats[w] << (w+rescale);
+                rankVal0[w] = current;
+        }   }
+        {   U32 const minBits = tableLog+1 - maxW;
+            U32 consumed;
+            for (consumed = minBits; consumed < maxTableLog - minBits + 1; consumed++) {
+                U32* const rankValPtr = rankVal[consumed];
+                U32 w;
+                for (w = 1; w < maxW+1; w++) {
+                    rankValPtr[w] = rankVal0[w] >> consumed;
+    }   }   }   }
+
+    /* fill tables */
+    {   void* const ddPtr = DTable+1;   /* force compiler to avoid strict-aliasing */
+        void* const dsPtr = DTable + 1 + ((size_t)1<<(maxTableLog-1));
+        HUF_original_DSeqX6 DSeq;
+        HUF_original_DDescX6 DDesc;
+        DSeq.sequence = 0;
+        DDesc.nbBits = 0;
+        DDesc.nbBytes = 0;
+        HUF_original_fillDTableX6LevelN((HUF_original_DDescX6*)ddPtr, (HUF_original_DSeqX6*)dsPtr, maxTableLog,
+                       (const U32 (*)[HUF_original_TABLELOG_ABSOLUTEMAX + 1])rankVal, 0, 1, maxW,
+                       sortedSymbol, sizeOfSort, rankStart0,
+                       tableLog+1, DSeq, DDesc);
+    }
+
+    dtd.tableLog = (BYTE)maxTableLog;
+    dtd.tableType = 2;
+    memcpy(DTable, &dtd, sizeof(dtd));
+    return iSize;
+}
+
+
+FORCE_INLINE U32 HUF_original_decodeSymbolX6(void* op, BIT_DStream_t* DStream, const HUF_original_DDescX6* dd, const HUF_original_DSeqX6* ds, const U32 dtLog)
+{
+    size_t const val = BIT_lookBitsFast(DStream, dtLog);   /* note : dtLog >= 1 */
+    memcpy(op, ds+val, sizeof(HUF_original_DSeqX6));
+    BIT_skipBits(DStream, dd[val].nbBits);
+    return dd[val].nbBytes;
+}
+
+FORCE_INLINE U32 HUF_original_decodeLastSymbolsX6(void* op, U32 const maxL, BIT_DStream_t* DStream,
+                                  const HUF_original_DDescX6* dd, const HUF_original_DSeqX6* ds, const U32 dtLog)
+{
+    size_t const val = BIT_lookBitsFast(DStream, dtLog);   /* note : dtLog >= 1 */
+    U32 const length = dd[val].nbBytes;
+    if (length <= maxL) {
+        memcpy(op, ds+val, length);
+        BIT_skipBits(DStream, dd[val].nbBits);
+        return length;
+    }
+    memcpy(op, ds+val, maxL);
+    if (DStream->bitsConsumed < (sizeof(DStream->bitContainer)*8)) {
+        BIT_skipBits(DStream, dd[val].nbBits);
+        if (DStream->bitsConsumed > (sizeof(DStream->bitContainer)*8))
+            DStream->bitsConsumed = (sizeof(DStream->bitContainer)*8);   /* ugly hack; works only because it's the last symbol. Note : can't easily extract nbBits from just this symbol */
+    }
+    return maxL;
+}
+
+
+#define HUF_original_DECODE_SYMBOLX6_0(ptr, DStreamPtr) \
+    ptr += HUF_original_decodeSymbolX6(ptr, DStreamPtr, dd, ds, dtLog)
+
+#define HUF_original_DECODE_SYMBOLX6_1(ptr, DStreamPtr) \
+    if (MEM_64bits() || (HUF_original_TABLELOG_MAX<=12)) \
+        HUF_original_DECODE_SYMBOLX6_0(ptr, DStreamPtr)
+
+#define HUF_original_DECODE_SYMBOLX6_2(ptr, DStreamPtr) \
+    if (MEM_64bits()) \
+        HUF_original_DECODE_SYMBOLX6_0(ptr, DStreamPtr)
+
+/* Each lookup writes 4 bytes, even when it decodes less symbols, so a round of 4 lookups writes up to 16 bytes.
+ * Limits keep these writes below `pEnd`, so they never overwrite the beginning of next segment.
+ * padded : only for last segment; `pEnd` may be overrun by up to 8 bytes.
+ * @return : nb of decoded bytes, which is `pEnd-p` on valid input */
+FORCE_INLINE size_t HUF_original_decodeStreamX6(BYTE* p, BIT_DStream_t* bitDPtr, BYTE* const pEnd,
+                                        const HUF_original_DDescX6* const dd, const HUF_original_DSeqX6* const ds, const U32 dtLog, const unsigned padded)
+{
+    BYTE* const pStart = p;
+    BYTE* const pLimit16 = HUF_original_safeLimit(pStart, pEnd, padded ? 7 : 15);
+    BYTE* const pLimit4 = padded ? pEnd : HUF_original_safeLimit(pStart, pEnd, 3);
+
+    /* fast loop : unchecked reloads */
+    if (MEM_64bits() && (BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished)) {
+        size_t nbRounds;
+        while ((nbRounds = HUF_original_nbFastRounds(bitDPtr, 4*dtLog, p, pLimit16, 16)) > 0) {
+            do {
+                HUF_original_DECODE_SYMBOLX6_2(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX6_1(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX6_2(p, bitDPtr);
+                HUF_original_DECODE_SYMBOLX6_0(p, bitDPtr);
+                BIT_reloadDStreamFast(bitDPtr);
+            } while (--nbRounds);
+    }   }
+
+    /* up to 16 symbols at a time */
+    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p < pLimit16)) {
+        HUF_original_DECODE_SYMBOLX6_2(p, bitDPtr);
+        HUF_original_DECODE_SYMBOLX6_1(p, bitDPtr);
+        HUF_original_DECODE_SYMBOLX6_2(p, bitDPtr);
+        HUF_original_DECODE_SYMBOLX6_0(p, bitDPtr);
+    }
+
+    /* closer to the end, up to 4 symbols at a time */
+    while ((BIT_reloadDStream(bitDPtr) == BIT_DStream_unfinished) && (p < pLimit4))
+        HUF_original_DECODE_SYMBOLX6_0(p, bitDPtr);
+
+    /* no more data to retrieve from bitstream, hence no need to reload */
+    while (p < pEnd)
+        p += HUF_original_decodeLastSymbolsX6(p, (U32)(pEnd-p), bitDPtr, dd, ds, dtLog);
+
+    return p-pStart;
+}
+
+
+FORCE_INLINE size_t HUF_original_decompress1X6_usingDTable_body(
+          void* dst,  size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const HUF_original_DTable* DTable, unsigned padded)
+{
+    BIT_DStream_t bitD;
+
+    /* Init */
+    {   size_t const errorCode = BIT_initDStream(&bitD, cSrc, cSrcSize);
+        if (HUF_original_isError(errorCode)) return errorCode;
+    }
+
+    /* decode */
+    {   BYTE* const ostart = (BYTE*) dst;
+        BYTE* const oend = ostart + dstSize;
+        DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
+        const void* const ddPtr = DTable + 1;   /* force compiler to not use strict-aliasing */
+        const void* const dsPtr = DTable + 1 + ((size_t)1<<(dtd.tableLog-1));
+        if (HUF_original_decodeStreamX6(ostart, &bitD, oend, (const HUF_original_DDescX6*)ddPtr, (const HUF_original_DSeqX6*)dsPtr, dtd.tableLog, padded) != dstSize)
+            return ERROR(corruption_detected);
+    }
+
+    /* check */
+    if (!BIT_endOfDStream(&bitD)) return ERROR(corruption_detected);
+
+    /* decoded size */
+    return dstSize;
+}
+
+HUF_original_DGEN(HUF_original_decompress1X6_usingDTable)
+
+size_t HUF_original_decompress1X6_usingDTable(
+          void* dst,  size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const HUF_original_DTable* DTable)
+{
+    DTableDesc dtd = HUF_original_getDTableDesc(DTable);
+    if (dtd.tableType != 2) return ERROR(GENERIC);
+    return HUF_original_decompress1X6_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 0);
+}
+
+size_t HUF_original_decompress1X6_DCtx (HUF_original_DTable* DCtx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    const BYTE* ip = (const BYTE*) cSrc;
+
+    size_t const hSize = HUF_original_readDTableX6 (DCtx, cSrc, cSrcSize);
+    if (HUF_original_isError(hSize)) return hSize;
+    if (hSize >= cSrcSize) return ERROR(srcSize_wrong);
+    ip += hSize; cSrcSize -= hSize;
+
+    return HUF_original_decompress1X6_usingDTable_internal (dst, dstSize, ip, cSrcSize, DCtx, 0);
+}
+
+size_t HUF_original_decompress1X6 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    HUF_original_CREATE_STATIC_DTABLEX6(DTable, HUF_original_TABLELOG_MAX);
+    return HUF_original_decompress1X6_DCtx(DTable, dst, dstSize, cSrc, cSrcSize);
+}
+
+FORCE_INLINE size_t HUF_original_decompress8X6_usingDTable_body(
+          void* dst,  size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const HUF_original_DTable* DTable, unsigned padded)
+{
+    BYTE* const oend = (BYTE*)dst + dstSize;
+    DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
+    U32 const dtLog = dtd.tableLog;
+    const void* const ddPtr = DTable + 1;   /* force compiler to not use strict-aliasing */
+    const void* const dsPtr = DTable + 1 + ((size_t)1<<(dtLog-1));
+    const HUF_original_DDescX6* const dd = (const HUF_original_DDescX6*)ddPtr;
+    const HUF_original_DSeqX6* const ds = (const HUF_original_DSeqX6*)dsPtr;
+    BIT_DStream_t bitD[8];
+    BYTE* opStart[9];
+    BYTE* opLimit[8];
+    BYTE* op[8];
+    U32 endSignal;
+    U32 n;
+
+    /* Init */
+    {   size_t const errorCode = HUF_original_init8X(bitD, opStart, dst, dstSize, cSrc, cSrcSize);
+        if (HUF_original_isError(errorCode)) return errorCode; }
+    for (n=0; n<8; n++) {
+        op[n] = opStart[n];
+        opLimit[n] = HUF_original_safeLimit(opStart[n], opStart[n+1], 15);   /* a round writes up to 16 bytes per stream, which must not reach next segment */
+    }
+    if (padded) opLimit[7] = HUF_original_safeLimit(opStart[7], oend, 7);   /* padded : last round may overrun last segment, on corrupted input only */
+
+    /* 32-128 symbols per loop (4-16 symbols per stream) */
+    endSignal = HUF_original_RELOAD_8X();
+    /* fast loop : unchecked reloads */
+    if (MEM_64bits() && (endSignal==BIT_DStream_unfinished)) {
+        for (;;) {
+            size_t nbRounds = HUF_original_nbFastRounds(bitD+7, 4*dtLog, op[7], opLimit[7], 16);
+            for (n=0; n<7; n++) {
+                size_t const nbRoundsN = HUF_original_nbFastRounds(bitD+n, 4*dtLog, op[n], opLimit[n], 16);
+                nbRounds = HUF_original_MIN(nbRounds, nbRoundsN);
+            }
+            if (nbRounds == 0) break;
+            do {
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_2);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_1);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_2);
+                HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_0);
+                HUF_original_RELOAD_FAST_8X();
+            } while (--nbRounds);
+    }   }
+
+    while (endSignal==BIT_DStream_unfinished) {
+        for (n=0; n<8; n++) if (op[n] >= opLimit[n]) break;
+        if (n<8) break;
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_2);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_1);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_2);
+        HUF_original_DECODE_8X(HUF_original_DECODE_SYMBOLX6_0);
+        endSignal = HUF_original_RELOAD_8X();
+    }
+
+    /* check corruption */
+    for (n=0; n<8; n++)
+        if (op[n] > opStart[n+1]) return ERROR(corruption_detected);   /* only possible when padded */
+
+    /* finish bitStreams one by one */
+    for (n=0; n<8; n++)
+        if (HUF_original_decodeStreamX6(op[n], bitD+n, opStart[n+1], dd, ds, dtLog, padded && (n==7)) != (size_t)(opStart[n+1]-op[n]))
+            return ERROR(corruption_detected);
+
+    /* check */
+    for (n=0; n<8; n++)
+        if (!BIT_endOfDStream(bitD+n)) return ERROR(corruption_detected);
+
+    /* decoded size */
+    return dstSize;
+}
+
+HUF_original_DGEN(HUF_original_decompress8X6_usingDTable)
+
+
+FORCE_INLINE size_t HUF_original_decompress4X6_usingDTable_body(
+          void* dst,  size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const HUF_original_DTable* DTable, unsigned padded)
+{
+    size_t const entrySize = HUF_original_JUMPTABLE_ENTRY_SIZE(dstSize);
+
+    if (cSrcSize < 3*entrySize + 4) return ERROR(corruption_detected);   /* strict minimum : jump table + 1 byte per stream */
+    if (HUF_original_is8X(cSrc, dstSize)) return HUF_original_decompress8X6_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, padded);
+
+    {   const BYTE* const istart = (const BYTE*) cSrc;
+        BYTE* const ostart = (BYTE*) dst;
+        BYTE* const oend = ostart + dstSize;
+        DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
+        U32 const dtLog = dtd.tableLog;
+        const void* const ddPtr = DTable + 1;   /* force compiler to not use strict-aliasing */
+        const void* const dsPtr = DTable + 1 + ((size_t)1<<(dtLog-1));
+        const HUF_original_DDescX6* const dd = (const HUF_original_DDescX6*)ddPtr;
+        const HUF_original_DSeqX6* const ds = (const HUF_original_DSeqX6*)dsPtr;
+
+        /* Init */
+        BIT_DStream_t bitD1;
+        BIT_DStream_t bitD2;
+        BIT_DStream_t bitD3;
+        BIT_DStream_t bitD4;
+        size_t const length1 = HUF_original_readJumpEntry(istart, entrySize);
+        size_t const length2 = HUF_original_readJumpEntry(istart+entrySize, entrySize);
+        size_t const length3 = HUF_original_readJumpEntry(istart+2*entrySize, entrySize);
+        size_t const length4 = cSrcSize - (length1 + length2 + length3 + 3*entrySize);
+        const BYTE* const istart1 = istart + 3*entrySize;  /* jumpTable */
+        const BYTE* const istart2 = istart1 + length1;
+        const BYTE* const istart3 = istart2 + length2;
+        const BYTE* const istart4 = istart3 + length3;
+        size_t const segmentSize = (dstSize+3) / 4;
+        BYTE* const opStart2 = ostart + segmentSize;
+        BYTE* const opStart3 = opStart2 + segmentSize;
+        BYTE* const opStart4 = opStart3 + segmentSize;
+        BYTE* op1 = ostart;
+        BYTE* op2 = opStart2;
+        BYTE* op3 = opStart3;
+        BYTE* op4 = opStart4;
+        BYTE* const olimit1 = HUF_original_safeLimit(ostart, opStart2, 15);
+        BYTE* const olimit2 = HUF_original_safeLimit(opStart2, opStart3, 15);
+        BYTE* const olimit3 = HUF_original_safeLimit(opStart3, opStart4, 15);
+        BYTE* const olimit4 = HUF_original_safeLimit(opStart4, oend, padded ? 7 : 15);   /* padded : last round may overrun a segment, on corrupted input only */
+        U32 endSignal;
+
+        if ((length1 > cSrcSize) | (length2 > cSrcSize) | (length3 > cSrcSize)) return ERROR(corruption_detected);   /* prevents sum overflow of large jump tables */
+        if (length4 > cSrcSize) return ERROR(corruption_detected);   /* overflow */
+        { size_t const errorCode = BIT_initDStream(&bitD1, istart1, length1);
+          if (HUF_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = BIT_initDStream(&bitD2, istart2, length2);
+          if (HUF_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = BIT_initDStream(&bitD3, istart3, length3);
+          if (HUF_original_isError(errorCode)) return errorCode; }
+        { size_t const errorCode = BIT_initDStream(&bitD4, istart4, length4);
+          if (HUF_original_isError(errorCode)) return errorCode; }
+
+        /* 16-64 symbols per loop (4-16 symbols per stream) */
+        /* a round writes up to 16 bytes per stream, which must not reach next segment : all streams are checked */
+        endSignal = BIT_reloadDStream(&bitD1) | BIT_reloadDStream(&bitD2) | BIT_reloadDStream(&bitD3) | BIT_reloadDStream(&bitD4);
+        /* fast loop : unchecked reloads */
+        if (MEM_64bits() && (endSignal==BIT_DStream_unfinished)) {
+            size_t nbRounds;
+            while ((nbRounds = HUF_original_MIN(HUF_original_MIN(HUF_original_nbFastRounds(&bitD1, 4*dtLog, op1, olimit1, 16),
+                                          HUF_original_nbFastRounds(&bitD2, 4*dtLog, op2, olimit2, 16)),
+                                      HUF_original_MIN(HUF_original_nbFastRounds(&bitD3, 4*dtLog, op3, olimit3, 16),
+                                          HUF_original_nbFastRounds(&bitD4, 4*dtLog, op4, olimit4, 16)))) > 0) {
+                do {
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX6_2);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX6_1);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX6_2);
+                    HUF_original_DECODE_4X(HUF_original_DECODE_SYMBOLX6_0);
+                    HUF_original_RELOAD_FAST_4X();
+                } while (--nbRounds);
+        }   }
+
+        for ( ; (endSignal==BIT_DStream_unfinished) & (op1 < olimit1) & (op2 < olimit2) & (op3 < olimit3) & (op4 < olimit4) ; ) {
+            HUF_original_DECODE_SYMBOLX6_2(op1, &bitD1);
+            HUF_original_DECODE_SYMBOLX6_2(op2, &bitD2);
+            HUF_original_DECODE_SYMBOLX6_2(op3, &bitD3);
+            HUF_original_DECODE_SYMBOLX6_2(op4, &bitD4);
+            HUF_original_DECODE_SYMBOLX6_1(op1, &bitD1);
+            HUF_original_DECODE_SYMBOLX6_1(op2, &bitD2);
+            HUF_original_DECODE_SYMBOLX6_1(op3, &bitD3);
+            HUF_original_DECODE_SYMBOLX6_1(op4, &bitD4);
+            HUF_original_DECODE_SYMBOLX6_2(op1, &bitD1);
+            HUF_original_DECODE_SYMBOLX6_2(op2, &bitD2);
+            HUF_original_DECODE_SYMBOLX6_2(op3, &bitD3);
+            HUF_original_DECODE_SYMBOLX6_2(op4, &bitD4);
+            HUF_original_DECODE_SYMBOLX6_0(op1, &bitD1);
+            HUF_original_DECODE_SYMBOLX6_0(op2, &bitD2);
+            HUF_original_DECODE_SYMBOLX6_0(op3, &bitD3);
+            HUF_original_DECODE_SYMBOLX6_0(op4, &bitD4);
+
+            endSignal = BIT_reloadDStream(&bitD1) | BIT_reloadDStream(&bitD2) | BIT_reloadDStream(&bitD3) | BIT_reloadDStream(&bitD4);
+        }
+
+        /* check corruption */
+        if (op4 > oend) return ERROR(corruption_detected);   /* only possible when padded */
+
+        /* finish bitStreams one by one */
+        if (HUF_original_decodeStreamX6(op1, &bitD1, opStart2, dd, ds, dtLog, 0) != (size_t)(opStart2-op1)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX6(op2, &bitD2, opStart3, dd, ds, dtLog, 0) != (size_t)(opStart3-op2)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX6(op3, &bitD3, opStart4, dd, ds, dtLog, 0) != (size_t)(opStart4-op3)) return ERROR(corruption_detected);
+        if (HUF_original_decodeStreamX6(op4, &bitD4, oend,     dd, ds, dtLog, padded) != (size_t)(oend-op4))     return ERROR(corruption_detected);
+
+        /* check */
+        { U32 const endCheck = BIT_endOfDStream(&bitD1) & BIT_endOfDStream(&bitD2) & BIT_endOfDStream(&bitD3) & BIT_endOfDStream(&bitD4);
+          if (!endCheck) return ERROR(corruption_detected); }
+
+        /* decoded size */
+        return dstSize;
+    }
+}
+
+HUF_original_DGEN(HUF_original_decompress4X6_usingDTable)
+
+
+size_t HUF_original_decompress4X6_usingDTable(
+          void* dst,  size_t dstSize,
+    const void* cSrc, size_t cSrcSize,
+    const HUF_original_DTable* DTable)
+{
+    DTableDesc dtd = HUF_original_getDTableDesc(DTable);
+    if (dtd.tableType != 2) return ERROR(GENERIC);
+    return HUF_original_decompress4X6_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 0);
+}
+
+
+size_t HUF_original_decompress4X6_DCtx (HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    const BYTE* ip = (const BYTE*) cSrc;
+
+    size_t hSize = HUF_original_readDTableX6 (dctx, cSrc, cSrcSize);
+    if (HUF_original_isError(hSize)) return hSize;
+    if (hSize >= cSrcSize) return ERROR(srcSize_wrong);
+    ip += hSize; cSrcSize -= hSize;
+
+    return HUF_original_decompress4X6_usingDTable_internal(dst, dstSize, ip, cSrcSize, dctx, 0);
+}
+
+size_t HUF_original_decompress4X6 (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    HUF_original_CREATE_STATIC_DTABLEX6(DTable, HUF_original_TABLELOG_MAX);
+    return HUF_original_decompress4X6_DCtx(DTable, dst, dstSize, cSrc, cSrcSize);
+}
+
+
 /* ********************************/
 /* Generic decompression selector */
 /* ********************************/
@@ -779,8 +1713,9 @@ size_t HUF_original_decompress1X_usingDTable(void* dst, size_t maxDstSize,
                                     const HUF_original_DTable* DTable)
 {
     DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
-    return dtd.tableType ? HUF_original_decompress1X4_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable) :
-                           HUF_original_decompress1X2_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable);
+    return (dtd.tableType==2) ? HUF_original_decompress1X6_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable, 0) :
+           dtd.tableType ?      HUF_original_decompress1X4_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable, 0) :
+                                HUF_original_decompress1X2_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable, 0);
 }
 
 size_t HUF_original_decompress4X_usingDTable(void* dst, size_t maxDstSize,
@@ -788,8 +1723,29 @@ size_t HUF_original_decompress4X_usingDTable(void* dst, size_t maxDstSize,
                                     const HUF_original_DTable* DTable)
 {
     DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
-    return dtd.tableType ? HUF_original_decompress4X4_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable) :
-                           HUF_original_decompress4X2_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable);
+    return (dtd.tableType==2) ? HUF_original_decompress4X6_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable, 0) :
+           dtd.tableType ?      HUF_original_decompress4X4_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable, 0) :
+                                HUF_original_decompress4X2_usingDTable_internal(dst, maxDstSize, cSrc, cSrcSize, DTable, 0);
+}
+
+size_t HUF_original_decompress1X_usingDTable_withPadding(void* dst, size_t dstSize,
+                                    const void* cSrc, size_t cSrcSize,
+                                    const HUF_original_DTable* DTable)
+{
+    DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
+    return (dtd.tableType==2) ? HUF_original_decompress1X6_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 1) :
+           dtd.tableType ?      HUF_original_decompress1X4_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 1) :
+                                HUF_original_decompress1X2_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 1);
+}
+
+size_t HUF_original_decompress4X_usingDTable_withPadding(void* dst, size_t dstSize,
+                                    const void* cSrc, size_t cSrcSize,
+                                    const HUF_original_DTable* DTable)
+{
+    DTableDesc const dtd = HUF_original_getDTableDesc(DTable);
+    return (dtd.tableType==2) ? HUF_original_decompress4X6_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 1) :
+           dtd.tableType ?      HUF_original_decompress4X4_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 1) :
+                                HUF_original_decompress4X2_usingDTable_internal(dst, dstSize, cSrc, cSrcSize, DTable, 1);
 }
 
 
@@ -799,37 +1755,94 @@ static const algo_time_t algoTime[16 /* Quantization */][3 /* single, double, qu
     /* single, double, quad */
     {{0,0}, {1,1}, {2,2}},  /* Q==0 : impossible */
     {{0,0}, {1,1}, {2,2}},  /* Q==1 : impossible */
-    {{  38,130}, {1313, 74}, {2151, 38}},   /* Q == 2 : 12-18% */
-    {{ 448,128}, {1353, 74}, {2238, 41}},   /* Q == 3 : 18-25% */
-    {{ 556,128}, {1353, 74}, {2238, 47}},   /* Q == 4 : 25-32% */
-    {{ 714,128}, {1418, 74}, {2436, 53}},   /* Q == 5 : 32-38% */
-    {{ 883,128}, {1437, 74}, {2464, 61}},   /* Q == 6 : 38-44% */
-    {{ 897,128}, {1515, 75}, {2622, 68}},   /* Q == 7 : 44-50% */
-    {{ 926,128}, {1613, 75}, {2730, 75}},   /* Q == 8 : 50-56% */
-    {{ 947,128}, {1729, 77}, {3359, 77}},   /* Q == 9 : 56-62% */
-    {{1107,128}, {2083, 81}, {4006, 84}},   /* Q ==10 : 62-69% */
-    {{1177,128}, {2379, 87}, {4785, 88}},   /* Q ==11 : 69-75% */
-    {{1242,128}, {2415, 93}, {5155, 84}},   /* Q ==12 : 75-81% */
-    {{1349,128}, {2644,106}, {5260,106}},   /* Q ==13 : 81-87% */
-    {{1455,128}, {2422,124}, {4174,124}},   /* Q ==14 : 87-93% */
-    {{ 722,128}, {1891,145}, {1936,146}},   /* Q ==15 : 93-99% */
+    {{  38,130}, { 262, 74}, {2151, 38}},   /* Q == 2 : 12-18% */
+    {{ 448,128}, { 339, 74}, {2238, 41}},   /* Q == 3 : 18-25% */
+    {{ 556,128}, { 333, 74}, {2238, 47}},   /* Q == 4 : 25-32% */
+    {{ 714,128}, { 366, 74}, {2436, 53}},   /* Q == 5 : 32-38% */
+    {{ 883,128}, { 371, 74}, {2464, 61}},   /* Q == 6 : 38-44% */
+    {{ 897,128}, { 461, 75}, {2622, 68}},   /* Q == 7 : 44-50% */
+    {{ 926,128}, { 508, 75}, {2730, 75}},   /* Q == 8 : 50-56% */
+    {{ 947,128}, { 659, 77}, {3359, 77}},   /* Q == 9 : 56-62% */
+    {{1107,128}, {1088, 81}, {4006, 84}},   /* Q ==10 : 62-69% */
+    {{1177,128}, {1089, 87}, {4785, 88}},   /* Q ==11 : 69-75% */
+    {{1242,128}, {1269, 93}, {5155, 84}},   /* Q ==12 : 75-81% */
+    {{1349,128}, {1466,106}, {5260,106}},   /* Q ==13 : 81-87% */
+    {{1455,128}, {1369,124}, {4174,124}},   /* Q ==14 : 87-93% */
+    {{ 722,128}, {1069,145}, {1936,146}},   /* Q ==15 : 93-99% */
 };
 
+/* decoder timings used by HUF_original_selectDecoder() : built-in `algoTime`, or a loaded profile */
+static algo_time_t HUF_original_profileTime[16][3];
+static const algo_time_t (*HUF_original_selectionTime)[3] = algoTime;
+
+#define HUF_original_PROFILE_MAGIC 0x31465048   /* "HPF1" */
+
+size_t HUF_original_saveDecoderProfile(void* dst, size_t dstCapacity)
+{
+    BYTE* op = (BYTE*)dst;
+    U32 q, a;
+    if (dstCapacity < HUF_original_DECODER_PROFILE_SIZE) return ERROR(dstSize_tooSmall);
+    MEM_writeLE32(op, HUF_original_PROFILE_MAGIC); op += 4;
+    for (q=0; q<16; q++) {
+        for (a=0; a<3; a++) {
+            MEM_writeLE32(op, HUF_original_selectionTime[q][a].tableTime); op += 4;
+            MEM_writeLE32(op, HUF_original_selectionTime[q][a].decode256Time); op += 4;
+    }   }
+    return HUF_original_DECODER_PROFILE_SIZE;
+}
+
+size_t HUF_original_loadDecoderProfile(const void* src, size_t srcSize)
+{
+    const BYTE* ip = (const BYTE*)src;
+    algo_time_t timing[16][3];
+    U32 q, a;
+    if (srcSize != HUF_original_DECODER_PROFILE_SIZE) return ERROR(srcSize_wrong);
+    if (MEM_readLE32(ip) != HUF_original_PROFILE_MAGIC) return ERROR(corruption_detected);
+    ip += 4;
+    for (q=0; q<16; q++) {
+        for (a=0; a<3; a++) {
+            timing[q][a].tableTime = MEM_readLE32(ip);
+            timing[q][a].decode256Time = MEM_readLE32(ip+4);
+            if (timing[q][a].decode256Time == 0) return ERROR(corruption_detected);
+            ip += 8;
+    }   }
+    memcpy(HUF_original_profileTime, timing, sizeof(timing));
+    HUF_original_selectionTime = (const algo_time_t (*)[3])HUF_original_profileTime;
+    return 0;
+}
+
+void HUF_original_resetDecoderProfile(void) { HUF_original_selectionTime = algoTime; }
+
+/* HUF_original_selectDecoder_internal() :
+*   @return : 0==X2, 1==X4, 2==X6, among the first `nbCandidates` ones */
+static U32 HUF_original_selectDecoder_internal (size_t dstSize, size_t cSrcSize, U32 nbCandidates)
+{
+    /* decoder timing evaluation */
+    const algo_time_t (* const timing)[3] = HUF_original_selectionTime;
+    U32 const Q = (U32)(cSrcSize * 16 / dstSize);   /* Q < 16 since dstSize > cSrcSize */
+    U64 const D256 = dstSize >> 8;
+    U64 DTime[3];
+    U32 n, algoNb = 0;
+
+    for (n=0; n<nbCandidates; n++)
+        DTime[n] = timing[Q][n].tableTime + (timing[Q][n].decode256Time * D256);   /* U64 : profile timings can be large */
+    /* advantage to algorithms using less memory, for cache eviction; still true for large blocks, as it also slows down decoding loop */
+    DTime[1] += DTime[1] >> 3;
+    if (nbCandidates > 2) DTime[2] += DTime[2] >> 2;   /* X6 table is 1.5x larger than X4 one */
+
+    for (n=1; n<nbCandidates; n++)
+        if (DTime[n] < DTime[algoNb]) algoNb = n;
+    return algoNb;
+}
+
 /** HUF_original_selectDecoder() :
 *   Tells which decoder is likely to decode faster,
 *   based on a set of pre-determined metrics.
 *   @return : 0==HUF_original_decompress4X2, 1==HUF_original_decompress4X4 .
-*   Assumption : 0 < cSrcSize < dstSize <= 128 KB */
+*   Assumption : 0 < cSrcSize < dstSize <= HUF_original_LARGE_BLOCKSIZE_MAX */
 U32 HUF_original_selectDecoder (size_t dstSize, size_t cSrcSize)
 {
-    /* decoder timing evaluation */
-    U32 const Q = (U32)(cSrcSize * 16 / dstSize);   /* Q < 16 since dstSize > cSrcSize */
-    U32 const D256 = (U32)(dstSize >> 8);
-    U32 const DTime0 = algoTime[Q][0].tableTime + (algoTime[Q][0].decode256Time * D256);
-    U32 DTime1 = algoTime[Q][1].tableTime + (algoTime[Q][1].decode256Time * D256);
-    DTime1 += DTime1 >> 3;  /* advantage to algorithm using less memory, for cache eviction */
-
-    return DTime1 < DTime0;
+    return HUF_original_selectDecoder_internal(dstSize, cSrcSize, 2);
 }
 
 
@@ -837,7 +1850,7 @@ typedef size_t (*decompressionAlgo)(void* dst, size_t dstSize, const void* cSrc,
 
 size_t HUF_original_decompress (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
 {
-    static const decompressionAlgo decompress[2] = { HUF_original_decompress4X2, HUF_original_decompress4X4 };
+    static const decompressionAlgo decompress[3] = { HUF_original_decompress4X2, HUF_original_decompress4X4, HUF_original_decompress4X6 };
 
     /* validation checks */
     if (dstSize == 0) return ERROR(dstSize_tooSmall);
@@ -845,7 +1858,7 @@ size_t HUF_original_decompress (void* dst, size_t dstSize, const void* cSrc, siz
     if (cSrcSize == dstSize) { memcpy(dst, cSrc, dstSize); return dstSize; }   /* not compressed */
     if (cSrcSize == 1) { memset(dst, *(const BYTE*)cSrc, dstSize); return dstSize; }   /* RLE */
 
-    {   U32 const algoNb = HUF_original_selectDecoder(dstSize, cSrcSize);
+    {   U32 const algoNb = HUF_original_selectDecoder_internal(dstSize, cSrcSize, 3);   /* own table : X6 is a candidate */
         return decompress[algoNb](dst, dstSize, cSrc, cSrcSize);
     }
 
@@ -853,6 +1866,16 @@ size_t HUF_original_decompress (void* dst, size_t dstSize, const void* cSrc, siz
     //return HUF_original_decompress4X4(dst, dstSize, cSrc, cSrcSize);   /* multi-streams double-symbols decoding */
 }
 
+/* HUF_original_decompressRepeat() :
+   decodes a block which re-uses the table of previous block, still present into `dctx` */
+static size_t HUF_original_decompressRepeat (HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize, unsigned singleStream)
+{
+    DTableDesc const dtd = HUF_original_getDTableDesc(dctx);
+    if (dtd.tableLog == 0) return ERROR(corruption_detected);   /* no previous table */
+    if (singleStream) return HUF_original_decompress1X_usingDTable(dst, dstSize, (const BYTE*)cSrc + 1, cSrcSize - 1, dctx);
+    return HUF_original_decompress4X_usingDTable(dst, dstSize, (const BYTE*)cSrc + 1, cSrcSize - 1, dctx);
+}
+
 size_t HUF_original_decompress4X_DCtx (HUF_original_DTable* dctx, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
 {
     /* validation checks */
@@ -860,6 +1883,7 @@ size_t HUF_original_decompress4X_DCtx (HUF_original_DTable* dctx, void* dst, siz
     if (cSrcSize > dstSize) return ERROR(corruption_detected);   /* invalid */
     if (cSrcSize == dstSize) { memcpy(dst, cSrc, dstSize); return dstSize; }   /* not compressed */
     if (cSrcSize == 1) { memset(dst, *(const BYTE*)cSrc, dstSize); return dstSize; }   /* RLE */
+    if (*(const BYTE*)cSrc == HUF_original_REPEAT_HEADER) return HUF_original_decompressRepeat(dctx, dst, dstSize, cSrc, cSrcSize, 0);
 
     {   U32 const algoNb = HUF_original_selectDecoder(dstSize, cSrcSize);
         return algoNb ? HUF_original_decompress4X4_DCtx(dctx, dst, dstSize, cSrc, cSrcSize) :
@@ -872,6 +1896,7 @@ size_t HUF_original_decompress4X_hufOnly (HUF_original_DTable* dctx, void* dst,
     /* validation checks */
     if (dstSize == 0) return ERROR(dstSize_tooSmall);
     if ((cSrcSize >= dstSize) || (cSrcSize <= 1)) return ERROR(corruption_detected);   /* invalid */
+    if (*(const BYTE*)cSrc == HUF_original_REPEAT_HEADER) return HUF_original_decompressRepeat(dctx, dst, dstSize, cSrc, cSrcSize, 0);
 
     {   U32 const algoNb = HUF_original_selectDecoder(dstSize, cSrcSize);
         return algoNb ? HUF_original_decompress4X4_DCtx(dctx, dst, dstSize, cSrc, cSrcSize) :
@@ -886,9 +1911,165 @@ size_t HUF_original_decompress1X_DCtx (HUF_original_DTable* dctx, void* dst, siz
     if (cSrcSize > dstSize) return ERROR(corruption_detected);   /* invalid */
     if (cSrcSize == dstSize) { memcpy(dst, cSrc, dstSize); return dstSize; }   /* not compressed */
     if (cSrcSize == 1) { memset(dst, *(const BYTE*)cSrc, dstSize); return dstSize; }   /* RLE */
+    if (*(const BYTE*)cSrc == HUF_original_REPEAT_HEADER) return HUF_original_decompressRepeat(dctx, dst, dstSize, cSrc, cSrcSize, 1);
 
     {   U32 const algoNb = HUF_original_selectDecoder(dstSize, cSrcSize);
         return algoNb ? HUF_original_decompress1X4_DCtx(dctx, dst, dstSize, cSrc, cSrcSize) :
                         HUF_original_decompress1X2_DCtx(dctx, dst, dstSize, cSrc, cSrcSize) ;
     }
 }
+
+
+/* ********************************/
+/* Decoding table cache           */
+/* ********************************/
+#define HUF_original_DTABLECACHE_TABLES_MAX 64
+#define HUF_original_HEADER_SIZE_MAX 128   /* 1 + max FSE-compressed weights */
+
+typedef struct {
+    HUF_original_DTable dt[HUF_original_DTABLE_SIZE(HUF_original_TABLELOG_MAX)];
+    BYTE header[HUF_original_HEADER_SIZE_MAX];   /* raw header bytes which generated `dt` */
+    U32 headerSize;   /* 0 : empty entry */
+    U32 hash;
+    U32 lastUse;
+} HUF_original_DTableEntry;
+
+struct HUF_original_DTableCache_s {
+    U32 nbTables;
+    U32 useCount;    /* LRU time stamp */
+    U32 prevTable;   /* table of previous block, for repeat mode */
+    U32 hasTable;
+    U64 hits;
+    U64 misses;
+    HUF_original_DTableEntry tables[1];   /* `nbTables` entries */
+};
+
+HUF_original_DTableCache* HUF_original_createDTableCache(unsigned nbTables)
+{
+    HUF_original_DTableCache* cache;
+    if (nbTables==0) nbTables = 1;
+    if (nbTables > HUF_original_DTABLECACHE_TABLES_MAX) nbTables = HUF_original_DTABLECACHE_TABLES_MAX;
+    cache = (HUF_original_DTableCache*)malloc(sizeof(HUF_original_DTableCache) + (nbTables-1) * sizeof(HUF_original_DTableEntry));
+    if (cache==NULL) return NULL;
+    cache->nbTables = nbTables;
+    HUF_original_resetDTableCache(cache);
+    return cache;
+}
+
+void HUF_original_freeDTableCache(HUF_original_DTableCache* cache) { free(cache); }
+
+void HUF_original_resetDTableCache(HUF_original_DTableCache* cache)
+{
+    U32 n;
+    for (n=0; n<cache->nbTables; n++) cache->tables[n].headerSize = 0;
+    cache->useCount = 0;
+    cache->hasTable = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+void HUF_original_getDTableCacheStats(const HUF_original_DTableCache* cache, unsigned long long* hits, unsigned long long* misses)
+{
+    *hits = cache->hits;
+    *misses = cache->misses;
+}
+
+/* HUF_original_headerSize() :
+   size of weights header, read from its first byte (see HUF_original_readStats()) */
+static size_t HUF_original_headerSize(const BYTE* ip, size_t srcSize)
+{
+    size_t const hSize = 1 + ((ip[0] >= 128) ? (ip[0] - 127 + 1) / 2 : ip[0]);
+    if (hSize >= srcSize) return ERROR(srcSize_wrong);
+    return hSize;
+}
+
+static U32 HUF_original_hashHeader(const BYTE* p, size_t size)
+{
+    U32 h = 2166136261U;   /* FNV-1a */
+    size_t n;
+    for (n=0; n<size; n++) h = (h ^ p[n]) * 16777619U;
+    return h;
+}
+
+/* HUF_original_DTableCache_getTable() :
+   @return : index of table generated by header of `cSrc`, found within cache or built into least recently used entry,
+             or an errorCode. `*hSizePtr` receives header size. */
+static size_t HUF_original_DTableCache_getTable(HUF_original_DTableCache* cache, size_t* hSizePtr,
+                                       size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    const BYTE* const header = (const BYTE*)cSrc;
+    size_t const hSize = HUF_original_headerSize(header, cSrcSize);
+    U32 hash, n, victim = 0, emptyFound = 0;
+
+    cache->hasTable = 0;
+    if (HUF_original_isError(hSize)) return hSize;
+    *hSizePtr = hSize;
+    hash = HUF_original_hashHeader(header, hSize);
+    for (n=0; n<cache->nbTables; n++) {
+        HUF_original_DTableEntry* const entry = cache->tables + n;
+        if (entry->headerSize == 0) {
+            if (!emptyFound) { victim = n; emptyFound = 1; }
+            continue;
+        }
+        if ( (entry->headerSize == hSize) && (entry->hash == hash)
+          && !memcmp(entry->header, header, hSize) ) {
+            cache->hits++;
+            entry->lastUse = ++cache->useCount;
+            cache->prevTable = n; cache->hasTable = 1;
+            return n;
+        }
+        if (!emptyFound && (entry->lastUse < cache->tables[victim].lastUse)) victim = n;
+    }
+
+    cache->misses++;
+    {   HUF_original_DTableEntry* const entry = cache->tables + victim;
+        U32 const algoNb = HUF_original_selectDecoder(dstSize, cSrcSize);
+        size_t readSize;
+        entry->headerSize = 0;
+        entry->dt[0] = (U32)HUF_original_TABLELOG_MAX * 0x1000001;   /* see HUF_original_CREATE_STATIC_DTABLEX4() */
+        readSize = algoNb ? HUF_original_readDTableX4(entry->dt, cSrc, cSrcSize) : HUF_original_readDTableX2(entry->dt, cSrc, cSrcSize);
+        if (HUF_original_isError(readSize)) return readSize;
+        if (readSize != hSize) return ERROR(corruption_detected);
+        memcpy(entry->header, header, hSize);
+        entry->headerSize = (U32)hSize;
+        entry->hash = hash;
+        entry->lastUse = ++cache->useCount;
+    }
+    cache->prevTable = victim; cache->hasTable = 1;
+    return victim;
+}
+
+static size_t HUF_original_decompress_usingDTableCache(HUF_original_DTableCache* cache, void* dst, size_t dstSize,
+                                              const void* cSrc, size_t cSrcSize, unsigned singleStream)
+{
+    const HUF_original_DTable* dt;
+    size_t hSize = 1;
+
+    /* validation checks */
+    if (dstSize == 0) return ERROR(dstSize_tooSmall);
+    if (cSrcSize > dstSize) return ERROR(corruption_detected);   /* invalid */
+    if (cSrcSize == dstSize) { memcpy(dst, cSrc, dstSize); return dstSize; }   /* not compressed */
+    if (cSrcSize == 1) { memset(dst, *(const BYTE*)cSrc, dstSize); return dstSize; }   /* RLE */
+
+    if (*(const BYTE*)cSrc == HUF_original_REPEAT_HEADER) {
+        if (!cache->hasTable) return ERROR(corruption_detected);   /* no previous table */
+        dt = cache->tables[cache->prevTable].dt;
+    } else {
+        size_t const tableNb = HUF_original_DTableCache_getTable(cache, &hSize, dstSize, cSrc, cSrcSize);
+        if (HUF_original_isError(tableNb)) return tableNb;
+        dt = cache->tables[tableNb].dt;
+    }
+
+    if (singleStream) return HUF_original_decompress1X_usingDTable(dst, dstSize, (const BYTE*)cSrc + hSize, cSrcSize - hSize, dt);
+    return HUF_original_decompress4X_usingDTable(dst, dstSize, (const BYTE*)cSrc + hSize, cSrcSize - hSize, dt);
+}
+
+size_t HUF_original_decompress4X_usingDTableCache(HUF_original_DTableCache* cache, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    return HUF_original_decompress_usingDTableCache(cache, dst, dstSize, cSrc, cSrcSize, 0);
+}
+
+size_t HUF_original_decompress1X_usingDTableCache(HUF_original_DTableCache* cache, void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize)
+{
+    return HUF_original_decompress_usingDTableCache(cache, dst, dstSize, cSrc, cSrcSize, 1);
+}
@@ -0,0 +1,145 @@
+/* ******************************************************************
+   threading.h
+   minimal portable thread wrapper (posix threads or Windows threads)
+   Copyright (C) 2013-2016, Yann Collet.
+
+   BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following disclaimer
+   in the documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    You can contact the author at :
+    - FSE source repository : https://github.com/Cyan4973/FiniteStateEntropy
+****************************************************************** */
+#ifndef THREADING_H_MODULE_FSE
+#define THREADING_H_MODULE_FSE
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/*-****************************************
+*  Dependencies
+******************************************/
+#include "mem.h"     /* MEM_STATIC */
+
+
+/*-****************************************
+*  Threads
+******************************************/
+/* Multi-threading is disabled by default.
+ * It's enabled by defining FSE_original_MULTITHREAD at compilation time.
+ * On posix systems, it also requires linking with pthread (typically `-pthread`).
+ * THREAD_SUPPORT tells if threads are available.
+ * Mutexes and condition variables are provided alongside threads, with the same availability. */
+#if defined(FSE_original_MULTITHREAD) && defined(_WIN32)
+
+#  define THREAD_SUPPORT 1
+#  include <windows.h>
+#  include <process.h>   /* _beginthreadex */
+
+typedef struct {
+    HANDLE handle;
+    void* (*start_routine)(void*);
+    void* arg;
+} THREAD_t;
+
+static unsigned __stdcall THREAD_trampoline(void* opaque)
+{
+    THREAD_t* const thread = (THREAD_t*)opaque;
+    thread->start_routine(thread->arg);
+    return 0;
+}
+
+/* note : `thread` must remain valid until THREAD_join() */
+MEM_STATIC int THREAD_create(THREAD_t* thread, void* (*start_routine)(void*), void* arg)
+{
+    thread->start_routine = start_routine;
+    thread->arg = arg;
+    thread->handle = (HANDLE)_beginthreadex(NULL, 0, THREAD_trampoline, thread, 0, NULL);
+    return thread->handle == NULL;
+}
+
+MEM_STATIC int THREAD_join(THREAD_t* thread)
+{
+    if (WaitForSingleObject(thread->handle, INFINITE) != WAIT_OBJECT_0) return 1;
+    CloseHandle(thread->handle);
+    return 0;
+}
+
+/* note : condition variables require Windows Vista or later */
+typedef CRITICAL_SECTION MUTEX_t;
+MEM_STATIC int  MUTEX_init(MUTEX_t* mutex) { InitializeCriticalSection(mutex); return 0; }
+MEM_STATIC void MUTEX_destroy(MUTEX_t* mutex) { DeleteCriticalSection(mutex); }
+MEM_STATIC void MUTEX_lock(MUTEX_t* mutex) { EnterCriticalSection(mutex); }
+MEM_STATIC void MUTEX_unlock(MUTEX_t* mutex) { LeaveCriticalSection(mutex); }
+
+typedef CONDITION_VARIABLE COND_t;
+MEM_STATIC int  COND_init(COND_t* cond) { InitializeConditionVariable(cond); return 0; }
+MEM_STATIC void COND_destroy(COND_t* cond) { (void)cond; }
+MEM_STATIC void COND_wait(COND_t* cond, MUTEX_t* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+MEM_STATIC void COND_signal(COND_t* cond) { WakeConditionVariable(cond); }
+MEM_STATIC void COND_broadcast(COND_t* cond) { WakeAllConditionVariable(cond); }
+
+#elif defined(FSE_original_MULTITHREAD)
+
+#  define THREAD_SUPPORT 1
+#  include <pthread.h>
+
+typedef pthread_t THREAD_t;
+
+MEM_STATIC int THREAD_create(THREAD_t* thread, void* (*start_routine)(void*), void* arg)
+{
+    return pthread_create(thread, NULL, start_routine, arg);
+}
+
+MEM_STATIC int THREAD_join(THREAD_t* thread)
+{
+    return pthread_join(*thread, NULL);
+}
+
+typedef pthread_mutex_t MUTEX_t;
+MEM_STATIC int  MUTEX_init(MUTEX_t* mutex) { return pthread_mutex_init(mutex, NULL); }
+MEM_STATIC void MUTEX_destroy(MUTEX_t* mutex) { pthread_mutex_destroy(mutex); }
+MEM_STATIC void MUTEX_lock(MUTEX_t* mutex) { pthread_mutex_lock(mutex); }
+MEM_STATIC void MUTEX_unlock(MUTEX_t* mutex) { pthread_mutex_unlock(mutex); }
+
+typedef pthread_cond_t COND_t;
+MEM_STATIC int  COND_init(COND_t* cond) { return pthread_cond_init(cond, NULL); }
+MEM_STATIC void COND_destroy(COND_t* cond) { pthread_cond_destroy(cond); }
+MEM_STATIC void COND_wait(COND_t* cond, MUTEX_t* mutex) { pthread_cond_wait(cond, mutex); }
+MEM_STATIC void COND_signal(COND_t* cond) { pthread_cond_signal(cond); }
+MEM_STATIC void COND_broadcast(COND_t* cond) { pthread_cond_broadcast(cond); }
+
+#else
+
+#  define THREAD_SUPPORT 0
+
+#endif
+
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif /* THREADING_H_MODULE_FSE */
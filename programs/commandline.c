@@ -43,6 +43,8 @@
 #include <string.h>   /* strcmp, strcat */
 #include "bench.h"
 #include "fileio.h"   /* FIO_setCompressor */
+#define HUF_STATIC_LINKING_ONLY   /* HUF_calibrateDecoders */
+#include "huf.h"
 
 
 /*-*************************************************
@@ -99,14 +101,39 @@ static int usage(const char* programName)
     DISPLAY(" -h : use HUF\n");
     DISPLAY(" -z : use zlib's huffman\n");
     DISPLAY(" -d : decompression (default for %s extension)\n", FSE_EXTENSION);
+    DISPLAY(" -r : re-use tables between blocks when beneficial (FSE & HUF)\n");
+    DISPLAY(" -a#: adaptive block size, split where statistics change (1:fast (default), 2:thorough)\n");
+    DISPLAY(" -T#: compress or decompress blocks using # threads (default : 1)\n");
+    DISPLAY(" -W#: max nb of blocks in memory with -T# (default : 2 per thread)\n");
+    DISPLAY(" -m : memory-map regular files (zero-copy input and output)\n");
+    DISPLAY(" -s : append a seek table, to decode byte ranges with -R\n");
+    DISPLAY(" -R#,#: decode only range start,size of original file\n");
+    DISPLAY(" -C : calibrate huffman decoder selection on this host\n");
+    DISPLAY(" -P file : load huffman decoder profile from file, or calibrate and save it there\n");
     DISPLAY(" -b : benchmark mode\n");
     DISPLAY(" -i#: iteration loops [1-9](default : 4), benchmark mode only\n");
-    DISPLAY(" -B#: block size (default : 32768), benchmark mode only\n");
+    DISPLAY(" -B#: block size (default : 32K), up to 32M (compression : rounded up to a power of 2)\n");
     DISPLAY(" -H : display help and exit\n");
     return 0;
 }
 
 
+/* readU64FromArgument() :
+   reads the decimal number following current option letter, and moves `*argumentPtr` onto its last digit */
+static unsigned long long readU64FromArgument(const char** argumentPtr)
+{
+    unsigned long long result = 0;
+    while (((*argumentPtr)[1] >= '0') && ((*argumentPtr)[1] <= '9')) {
+        result *= 10;
+        result += (unsigned)((*argumentPtr)[1] - '0');
+        (*argumentPtr)++;
+    }
+    return result;
+}
+
+static unsigned readU32FromArgument(const char** argumentPtr) { return (unsigned)readU64FromArgument(argumentPtr); }
+
+
 static int badusage(const char* programName)
 {
     DISPLAYLEVEL(1, "Incorrect parameters\n");
@@ -115,6 +142,45 @@ static int badusage(const char* programName)
 }
 
 
+/* setHufProfile() :
+   loads huffman decoder profile from `profileName` when it exists,
+   otherwise calibrates decoders on this host, and saves result into `profileName` (if not NULL) */
+static void setHufProfile(const char* profileName)
+{
+    unsigned char profile[HUF_DECODER_PROFILE_SIZE];
+    FILE* f;
+
+    if (profileName) {
+        f = fopen(profileName, "rb");
+        if (f) {
+            size_t const readSize = fread(profile, 1, sizeof(profile), f);
+            fclose(f);
+            if (!HUF_isError(HUF_loadDecoderProfile(profile, readSize))) {
+                DISPLAYLEVEL(3, "Huffman decoder profile loaded from %s \n", profileName);
+                return;
+            }
+            DISPLAYLEVEL(2, "Warning : %s is not a valid huffman decoder profile, recalibrating \n", profileName);
+    }   }
+
+    DISPLAYLEVEL(2, "Calibrating huffman decoders... \r");
+    {   size_t const errorCode = HUF_calibrateDecoders();
+        if (HUF_isError(errorCode)) {
+            DISPLAYLEVEL(1, "Calibration failed : %s \n", HUF_getErrorName(errorCode));
+            return;
+    }   }
+    DISPLAYLEVEL(2, "Huffman decoders calibrated      \n");
+    if (!profileName) return;
+
+    {   size_t const pSize = HUF_saveDecoderProfile(profile, sizeof(profile));
+        f = fopen(profileName, "wb");
+        if ((f==NULL) || HUF_isError(pSize) || (fwrite(profile, 1, pSize, f) != pSize)) {
+            DISPLAYLEVEL(1, "Warning : cannot save huffman decoder profile into %s \n", profileName);
+        }
+        if (f) fclose(f);
+    }
+}
+
+
 static void waitEnter(void)
 {
     int unused;
@@ -135,6 +201,10 @@ int main(int argc, const char** argv)
     const char extension[] = FSE_EXTENSION;
     const char* programName = argv[0];
     FIO_compressor_t compressor = FIO_fse;
+    int   hufCalibrate = 0;
+    int   rangeDecode = 0;
+    unsigned long long rangeStart = 0, rangeSize = 0;
+    const char* hufProfileName = NULL;
 
     DISPLAY(WELCOME_MESSAGE);
     if (argc<2) badusage(programName);
@@ -185,6 +255,49 @@ int main(int argc, const char** argv)
                     compressor = FIO_zlibh;
                     break;
 
+                    // Table repeat mode
+                case 'r': FIO_setRepeatMode(1); break;
+
+                    // Adaptive block splitting
+                case 'a':
+                    {   unsigned mode = 1;
+                        if ((argument[1] >='1') && (argument[1] <='2')) {
+                            mode = argument[1] - '0';
+                            argument++;
+                        }
+                        FIO_setBlockSplit(mode);
+                    }
+                    break;
+
+                    // Multi-threading
+                case 'T': FIO_setNbThreads(readU32FromArgument(&argument)); break;
+                case 'W': FIO_setInFlightBlocks(readU32FromArgument(&argument)); break;
+
+                    // Memory-mapped files
+                case 'm': FIO_setMMapMode(1); break;
+
+                    // Seek table
+                case 's': FIO_setSeekTable(1); break;
+
+                    // Range decoding : -Rstart,size
+                case 'R':
+                    decode=1; bench=0; rangeDecode=1;
+                    rangeStart = readU64FromArgument(&argument);
+                    if (argument[1] != ',') badusage(programName);
+                    argument++;
+                    rangeSize = readU64FromArgument(&argument);
+                    break;
+
+                    // Huffman decoder calibration
+                case 'C': hufCalibrate=1; break;
+
+                    // Huffman decoder profile (file name is next argument)
+                case 'P':
+                    if ((argument[1]!=0) || (i+1 >= argc)) badusage(programName);
+                    hufProfileName = argv[++i];
+                    hufCalibrate = 1;
+                    break;
+
                     // Test
                 case 't': decode=1; output_filename=nulmark; break;
 
@@ -214,6 +327,7 @@ int main(int argc, const char** argv)
                         if (argument[1]=='M') bSize<<=20, argument++;
                         if (argument[1]=='B') argument++;
                         BMK_SetBlocksize(bSize);
+                        FIO_setBlockSize(bSize);
                     }
                     break;
 
@@ -256,6 +370,7 @@ int main(int argc, const char** argv)
     }
 
     /* DISPLAYLEVEL(3, WELCOME_MESSAGE); */
+    FIO_setNotificationLevel((unsigned)displayLevel);
 
     /* No input filename ==> use stdin */
     if(!input_filename) { input_filename=stdinmark; }
@@ -263,6 +378,9 @@ int main(int argc, const char** argv)
     /* Check if input is defined as console; trigger an error in this case */
     if (!strcmp(input_filename, stdinmark) && IS_CONSOLE(stdin) ) badusage(programName);
 
+    /* Huffman decoder selection */
+    if (hufCalibrate) setHufProfile(hufProfileName);
+
     /* Check if benchmark is selected */
     if (bench==1) { BMK_benchFiles(argv+indexFileNames, argc-indexFileNames); goto _end; }
     if (bench==3) { BMK_benchCore_Files(argv+indexFileNames, argc-indexFileNames); goto _end; }   /* no longer possible */
@@ -310,7 +428,8 @@ int main(int argc, const char** argv)
     if (!strcmp(input_filename, stdinmark)  && IS_CONSOLE(stdin) ) badusage(programName);
     if (!strcmp(output_filename,stdoutmark) && IS_CONSOLE(stdout)) badusage(programName);
 
-    if (decode) FIO_decompressFilename(output_filename, input_filename);
+    if (rangeDecode) FIO_decompressRange(output_filename, input_filename, rangeStart, rangeSize);
+    else if (decode) FIO_decompressFilename(output_filename, input_filename);
     else {
         FIO_setCompressor(compressor);
         FIO_compressFilename(output_filename, input_filename);
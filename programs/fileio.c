@@ -42,7 +42,7 @@
 #define GCC_VERSION (__GNUC__ * 100 + __GNUC_MINOR__)
 
 #define _FILE_OFFSET_BITS 64   /* Large file support on 32-bits unix */
-#define _POSIX_SOURCE 1        /* enable fileno() within <stdio.h> on unix */
+#define _POSIX_C_SOURCE 200112L   /* enable fileno() within <stdio.h>, ftruncate(), posix_madvise() on unix */
 
 
 /*-************************************
@@ -53,11 +53,15 @@
 #include <string.h>   /* strcmp, strlen */
 #include <time.h>     /* clock */
 #include "fileio.h"
+#define FSE_STATIC_LINKING_ONLY   /* FSE_CCtx, FSE_findBlockSplit */
 #include "fse.h"
+#define HUF_STATIC_LINKING_ONLY   /* HUF_CCtx, HUF_DTable */
 #include "huf.h"
 #include "zlibh.h"    /*ZLIBH_compress */
 #define XXH_STATIC_LINKING_ONLY
 #include "xxhash.h"
+#include "mem.h"       /* BYTE, U16, U32, S32, U64 */
+#include "threading.h"   /* THREAD_create, MUTEX_t, COND_t */
 
 
 /*-************************************
@@ -71,29 +75,26 @@
 #  endif
 #  define SET_BINARY_MODE(file) { int unused = _setmode(_fileno(file), _O_BINARY); (void)unused; }
 #  define IS_CONSOLE(stdStream) _isatty(_fileno(stdStream))
+#  define LONG_SEEK _fseeki64
 #else
 #  include <unistd.h>   // isatty
 #  define SET_BINARY_MODE(file)
 #  define IS_CONSOLE(stdStream) isatty(fileno(stdStream))
+#  define LONG_SEEK fseeko
 #endif
 
-
-/*-************************************
-*  Basic Types
-**************************************/
-#if defined (__STDC_VERSION__) && __STDC_VERSION__ >= 199901L   /* C99 */
-# include <stdint.h>
-typedef uint8_t  BYTE;
-typedef uint16_t U16;
-typedef uint32_t U32;
-typedef  int32_t S32;
-typedef uint64_t U64;
-#else
-typedef unsigned char       BYTE;
-typedef unsigned short      U16;
-typedef unsigned int        U32;
-typedef   signed int        S32;
-typedef unsigned long long  U64;
+#ifndef FIO_MMAP_SUPPORT
+#  if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#    define FIO_MMAP_SUPPORT 1
+#  else
+#    define FIO_MMAP_SUPPORT 0
+#  endif
+#endif
+#if FIO_MMAP_SUPPORT
+#  include <sys/types.h>  // off_t
+#  include <sys/stat.h>   // fstat
+#  include <sys/mman.h>   // mmap, munmap, posix_madvise
+#  include <fcntl.h>      // posix_fallocate
 #endif
 
 
@@ -111,6 +112,7 @@ typedef unsigned long long  U64;
 #define _6BITS 0x3F
 #define _8BITS 0xFF
 
+#define BIT4  0x10
 #define BIT5  0x20
 #define BIT6  0x40
 #define BIT7  0x80
@@ -118,11 +120,18 @@ typedef unsigned long long  U64;
 #define FIO_magicNumber_fse   0x183E2309
 #define FIO_magicNumber_huf   0x183E3309
 #define FIO_magicNumber_zlibh 0x183E4309
-static const unsigned FIO_maxBlockSizeID = 6;   /* => 64 KB block */
-static const unsigned FIO_maxBlockHeaderSize = 5;
+#define FIO_magicNumber_seekTable 0x183EF309
+static const unsigned FIO_maxBlockSizeID = 15;       /* => 32 MB block */
+static const unsigned FIO_maxBlockSizeID_16bits = 6;  /* => 64 KB block : largest one whose sizes fit into 16-bits block header fields */
+static const unsigned FIO_maxBlockHeaderSize = 9;
 
 #define FIO_FRAMEHEADERSIZE 5        /* as a define, because needed to allocated table on stack */
 #define FIO_BLOCKSIZEID_DEFAULT  5   /* as a define, because needed to init static g_blockSizeId */
+#define FIO_FLAG_REPEAT          BIT4   /* stream descriptor : blocks may re-use previous block's table */
+#define FIO_FLAG_VARSIZES        BIT5   /* stream descriptor : block headers store variable-length sizes (blocks > 64 KB) */
+#define FIO_VARSIZE_MAXBYTES     4      /* => sizes up to 256 MB */
+#define FIO_SEEKENTRYSIZE        12
+#define FIO_SEEKFOOTERSIZE       9
 #define FSE_CHECKSUM_SEED        0
 
 #define CACHELINE 64
@@ -156,6 +165,9 @@ static U32 FIO_readLE32(const void* memPtr)
 /*-************************************
 *  Macros
 **************************************/
+#define MIN(a,b)   ( (a) < (b) ? (a) : (b) )
+#define MAX(a,b)   ( (a) > (b) ? (a) : (b) )
+
 #define DISPLAY(...)         fprintf(stderr, __VA_ARGS__)
 #define DISPLAYLEVEL(l, ...) if (g_displayLevel>=l) { DISPLAY(__VA_ARGS__); }
 static U32 g_displayLevel = 2;   /* 0 : no display;   1: errors;   2 : + result + interaction + warnings;   3 : + progression;   4 : + information */
@@ -173,10 +185,29 @@ static clock_t g_time = 0;
 **************************************/
 static U32 g_overwrite = 0;
 static U32 g_blockSizeId = FIO_BLOCKSIZEID_DEFAULT;
+static U32 g_repeatMode = 0;
+static U32 g_splitMode = 0;
+static U32 g_nbThreads = 1;
+static U32 g_inFlightBlocks = 0;   /* 0 : default, 2 per thread */
+static U32 g_mmapMode = 0;
+static U32 g_seekTable = 0;
 FIO_compressor_t g_compressor = FIO_fse;
 
 void FIO_overwriteMode(void) { g_overwrite=1; }
+void FIO_setNotificationLevel(unsigned level) { g_displayLevel = level; }
 void FIO_setCompressor(FIO_compressor_t c) { g_compressor = c; }
+void FIO_setRepeatMode(unsigned repeat) { g_repeatMode = (repeat!=0); }
+void FIO_setBlockSize(unsigned blockSize)
+{
+    U32 id = 0;
+    while ((id < FIO_maxBlockSizeID) && (((size_t)1 << id) KB < blockSize)) id++;
+    g_blockSizeId = id;
+}
+void FIO_setBlockSplit(unsigned mode) { g_splitMode = (mode > 2) ? 2 : mode; }
+void FIO_setNbThreads(unsigned nbThreads) { g_nbThreads = nbThreads ? nbThreads : 1; }
+void FIO_setInFlightBlocks(unsigned nbBlocks) { g_inFlightBlocks = nbBlocks; }
+void FIO_setMMapMode(unsigned mmapMode) { g_mmapMode = (mmapMode!=0); }
+void FIO_setSeekTable(unsigned seekTable) { g_seekTable = (seekTable!=0); }
 
 
 /*-************************************
@@ -243,7 +274,7 @@ static void get_fileHandle(const char* input_filename, const char* output_filena
                 ch = (char)getchar();
                 if ((ch!='Y') && (ch!='y')) EXM_THROW(11, "Operation aborted : %s already exists", output_filename);
         }   }
-        *pfoutput = fopen( output_filename, "wb" );
+        *pfoutput = fopen( output_filename, g_mmapMode ? "w+b" : "wb" );   /* a writable mapping requires read access */
     }
 
     if ( *pfinput==0 ) EXM_THROW(12, "Pb opening %s", input_filename);
@@ -251,59 +282,605 @@ static void get_fileHandle(const char* input_filename, const char* output_filena
 }
 
 
+/*-************************************
+*  Memory-mapped files
+**************************************/
+/* In mmap mode, regular files are mapped :
+   compression reads blocks directly from mapped input, decompression writes blocks directly into mapped output.
+   Other files (stdin, stdout, pipes, devices), and files which can't be mapped, use stdio. */
+typedef struct {
+    void* start;   /* NULL : not mapped */
+    size_t size;
+} FIO_map_t;
+
+/* FIO_mapInput() :
+   maps the whole content of `finput`, which must not have been read yet */
+static FIO_map_t FIO_mapInput(FILE* finput)
+{
+    FIO_map_t map = { NULL, 0 };
+#if FIO_MMAP_SUPPORT
+    struct stat st;
+    if (fstat(fileno(finput), &st) || !S_ISREG(st.st_mode)) return map;
+    if ((st.st_size <= 0) || ((U64)st.st_size != (size_t)st.st_size)) return map;   /* empty, or larger than address space */
+    map.start = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(finput), 0);
+    if (map.start == MAP_FAILED) { map.start = NULL; return map; }
+    map.size = (size_t)st.st_size;
+    (void)posix_madvise(map.start, map.size, POSIX_MADV_SEQUENTIAL);
+#else
+    (void)finput;
+#endif
+    return map;
+}
+
+/* FIO_mapOutput() :
+   resizes `foutput` to `size` bytes, and maps it for writing.
+   if `foutput` can't be mapped, it is left empty, and must be written through stdio */
+static FIO_map_t FIO_mapOutput(FILE* foutput, U64 size)
+{
+    FIO_map_t map = { NULL, 0 };
+#if FIO_MMAP_SUPPORT
+    int const fd = fileno(foutput);
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) return map;
+    if ((size == 0) || (size != (size_t)size)) return map;
+#  if defined(__linux__)
+    if (posix_fallocate(fd, 0, (off_t)size)) return map;   /* reserve disk space : a full disk can't be reported while writing into a mapping */
+#  else
+    if (ftruncate(fd, (off_t)size)) return map;
+#  endif
+    map.start = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map.start == MAP_FAILED) {
+        int const unused = ftruncate(fd, 0); (void)unused;
+        map.start = NULL;
+        return map;
+    }
+    map.size = (size_t)size;
+#else
+    (void)foutput; (void)size;
+#endif
+    return map;
+}
+
+static void FIO_unmap(FIO_map_t map)
+{
+#if FIO_MMAP_SUPPORT
+    if (map.start) munmap(map.start, map.size);
+#else
+    (void)map;
+#endif
+}
+
+
+#if THREAD_SUPPORT
+
+/*-************************************
+*  Worker pool
+**************************************/
+/* Jobs are posted in sequence by main thread, processed by any worker, then retired in sequence by main thread.
+   Job n uses slot (n % nbJobs), so at most nbJobs jobs (and their buffers) are in flight. */
+typedef struct {
+    char* src;         /* buffers owned by job slot */
+    char* dst;
+    const char* in;    /* job input : `src`, or directly within mapped input */
+    size_t inSize;
+    char* out;         /* job output : `dst`, or directly within mapped output */
+    size_t outSize;
+    size_t result;   /* compressed or regenerated size, or error code */
+    int type;        /* decompression : block type */
+    int done;
+} FIO_job_t;
+
+typedef void (*FIO_jobProcess_t)(FIO_job_t* job, void* workerCtx, const void* sharedCtx);
+
+typedef struct FIO_pool_s FIO_pool_t;
+
+typedef struct {
+    FIO_pool_t* pool;
+    void* ctx;
+    THREAD_t thread;
+} FIO_worker_t;
+
+struct FIO_pool_s {
+    MUTEX_t mutex;
+    COND_t jobPosted;   /* main thread => workers */
+    COND_t jobDone;     /* workers => main thread */
+    FIO_job_t* jobs;
+    unsigned nbJobs;
+    U64 nbPosted;
+    U64 nbTaken;
+    U64 nbRetired;
+    int endOfInput;
+    FIO_jobProcess_t process;
+    const void* sharedCtx;
+    FIO_worker_t* workers;
+    unsigned nbWorkers;
+};
+
+static void* FIO_poolWorker(void* opaque)
+{
+    FIO_worker_t* const worker = (FIO_worker_t*)opaque;
+    FIO_pool_t* const pool = worker->pool;
+    MUTEX_lock(&pool->mutex);
+    while (1) {
+        FIO_job_t* job;
+        while ((pool->nbTaken == pool->nbPosted) && !pool->endOfInput)
+            COND_wait(&pool->jobPosted, &pool->mutex);
+        if (pool->nbTaken == pool->nbPosted) break;   /* no more input */
+        job = pool->jobs + (pool->nbTaken++ % pool->nbJobs);
+        MUTEX_unlock(&pool->mutex);
+
+        pool->process(job, worker->ctx, pool->sharedCtx);
+
+        MUTEX_lock(&pool->mutex);
+        job->done = 1;
+        COND_signal(&pool->jobDone);   /* only main thread waits for jobDone */
+    }
+    MUTEX_unlock(&pool->mutex);
+    return NULL;
+}
+
+/* FIO_createPool() :
+   starts `nbWorkers` threads, each one receiving its own context `workerCtxs[n]` (can be NULL).
+   each job slot owns a `srcCapacity` and a `dstCapacity` buffer (none when capacity is 0, e.g. for mapped files). */
+static FIO_pool_t* FIO_createPool(unsigned nbWorkers, void** workerCtxs, unsigned nbJobs,
+                                  size_t srcCapacity, size_t dstCapacity,
+                                  FIO_jobProcess_t process, const void* sharedCtx)
+{
+    FIO_pool_t* const pool = (FIO_pool_t*)calloc(1, sizeof(FIO_pool_t));
+    if (!pool) EXM_THROW(21, "Allocation error : not enough memory");
+    pool->jobs = (FIO_job_t*)calloc(nbJobs, sizeof(FIO_job_t));
+    pool->workers = (FIO_worker_t*)calloc(nbWorkers, sizeof(FIO_worker_t));
+    if (!pool->jobs || !pool->workers) EXM_THROW(21, "Allocation error : not enough memory");
+    pool->nbJobs = nbJobs;
+    pool->nbWorkers = nbWorkers;
+    pool->process = process;
+    pool->sharedCtx = sharedCtx;
+    {   unsigned n;
+        for (n=0; n<nbJobs; n++) {
+            if (srcCapacity) pool->jobs[n].src = (char*)malloc(srcCapacity);
+            if (dstCapacity) pool->jobs[n].dst = (char*)malloc(dstCapacity);
+            if ((srcCapacity && !pool->jobs[n].src) || (dstCapacity && !pool->jobs[n].dst))
+                EXM_THROW(21, "Allocation error : not enough memory");
+    }   }
+    if (MUTEX_init(&pool->mutex) || COND_init(&pool->jobPosted) || COND_init(&pool->jobDone))
+        EXM_THROW(29, "Thread error : cannot initialize synchronization");
+    {   unsigned t;
+        for (t=0; t<nbWorkers; t++) {
+            pool->workers[t].pool = pool;
+            pool->workers[t].ctx = workerCtxs ? workerCtxs[t] : NULL;
+            if (THREAD_create(&pool->workers[t].thread, FIO_poolWorker, pool->workers+t))
+                EXM_THROW(29, "Thread error : cannot create thread");
+    }   }
+    return pool;
+}
+
+/* FIO_freePool() :
+   waits for workers to complete posted jobs, then releases everything */
+static void FIO_freePool(FIO_pool_t* pool)
+{
+    MUTEX_lock(&pool->mutex);
+    pool->endOfInput = 1;
+    COND_broadcast(&pool->jobPosted);
+    MUTEX_unlock(&pool->mutex);
+    {   unsigned t;
+        for (t=0; t<pool->nbWorkers; t++) THREAD_join(&pool->workers[t].thread);
+    }
+    COND_destroy(&pool->jobDone);
+    COND_destroy(&pool->jobPosted);
+    MUTEX_destroy(&pool->mutex);
+    {   unsigned n;
+        for (n=0; n<pool->nbJobs; n++) { free(pool->jobs[n].src); free(pool->jobs[n].dst); }
+    }
+    free(pool->jobs);
+    free(pool->workers);
+    free(pool);
+}
+
+/* FIO_pool_nextJob() :
+   @return : next job slot to fill, or NULL if all slots are in flight */
+static FIO_job_t* FIO_pool_nextJob(const FIO_pool_t* pool)
+{
+    if (pool->nbPosted - pool->nbRetired >= pool->nbJobs) return NULL;
+    return pool->jobs + (pool->nbPosted % pool->nbJobs);
+}
+
+/* FIO_pool_postJob() :
+   hands job returned by FIO_pool_nextJob() to workers */
+static void FIO_pool_postJob(FIO_pool_t* pool)
+{
+    MUTEX_lock(&pool->mutex);
+    pool->nbPosted++;
+    COND_signal(&pool->jobPosted);
+    MUTEX_unlock(&pool->mutex);
+}
+
+/* FIO_pool_oldestJob() :
+   waits for oldest posted job to be processed.
+   @return : oldest job, or NULL if there is no job in flight */
+static FIO_job_t* FIO_pool_oldestJob(FIO_pool_t* pool)
+{
+    FIO_job_t* const job = pool->jobs + (pool->nbRetired % pool->nbJobs);
+    if (pool->nbRetired == pool->nbPosted) return NULL;
+    MUTEX_lock(&pool->mutex);
+    while (!job->done) COND_wait(&pool->jobDone, &pool->mutex);
+    job->done = 0;
+    MUTEX_unlock(&pool->mutex);
+    return job;
+}
+
+/* FIO_pool_retireJob() :
+   releases slot of job returned by FIO_pool_oldestJob(), so that it can be filled again */
+static void FIO_pool_retireJob(FIO_pool_t* pool) { pool->nbRetired++; }
+
+#endif   /* THREAD_SUPPORT */
+
+
 size_t FIO_ZLIBH_compress(void* dst, size_t dstSize, const void* src, size_t srcSize )
 {
     (void)dstSize;
     return (size_t)ZLIBH_compress((char*)dst, (const char*)src, (int)srcSize);
 }
 
+/* table repeat mode : contexts remember the table of previous block */
+static FSE_CCtx* g_fseCCtx = NULL;
+static HUF_CCtx* g_hufCCtx = NULL;
+
+static size_t FIO_FSE_compressRepeat(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return FSE_compressCCtx_repeat(g_fseCCtx, dst, dstSize, src, srcSize, FSE_MAX_SYMBOL_VALUE, FSE_DEFAULT_TABLELOG);
+}
+
+static size_t FIO_HUF_compressRepeat(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return HUF_compress4X_CCtx_repeat(g_hufCCtx, dst, dstSize, src, srcSize, 255, HUF_TABLELOG_DEFAULT);
+}
+
+static size_t FIO_HUF_compressLarge(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return HUF_compress4X_large(dst, dstSize, src, srcSize, 255, HUF_TABLELOG_DEFAULT);
+}
+
+typedef size_t (*compressor_t) (void* dst, size_t dstSize, const void* src, size_t srcSize);
+
+/* FIO_writeVarSize() :
+   writes `value` as a variable-length size : 7 bits per byte, little endian, high bit set when more bytes follow.
+   @return : nb of bytes written (<= FIO_VARSIZE_MAXBYTES) */
+static size_t FIO_writeVarSize(BYTE* p, size_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80) { p[n++] = (BYTE)(value | 0x80); value >>= 7; }
+    p[n++] = (BYTE)value;
+    return n;
+}
+
+/* FIO_writeBlockHeader() :
+   block sizes are 16-bits fields (big endian), or variable-length sizes if `varSizes`.
+   @return : size of block header written into `header` (<= FIO_maxBlockHeaderSize) */
+static size_t FIO_writeBlockHeader(BYTE* header, bType_t bType, size_t rSize, size_t cSize, size_t blockSize, int varSizes)
+{
+    size_t hSize = 1;
+    header[0] = (BYTE)(bType << 6);
+    if (rSize == blockSize) header[0] += BIT5;   /* full block */
+    else if (varSizes) hSize += FIO_writeVarSize(header+hSize, rSize);
+    else { header[hSize] = (BYTE)(rSize >> 8); header[hSize+1] = (BYTE)rSize; hSize += 2; }
+    if (bType == bt_compressed) {
+        if (varSizes) hSize += FIO_writeVarSize(header+hSize, cSize);
+        else { header[hSize] = (BYTE)(cSize >> 8); header[hSize+1] = (BYTE)cSize; hSize += 2; }
+    }
+    return hSize;
+}
+
+/* FIO_writeBlock() :
+   writes block header and content of a block of `inSize` bytes from `in_buff`, compressed into `cSize` bytes.
+   `out_buff` contains compressed data starting at `out_buff + FIO_maxBlockHeaderSize`.
+   @return : nb of bytes written into `foutput` */
+static size_t FIO_writeBlock(FILE* foutput, char* out_buff, size_t cSize,
+                             const char* in_buff, size_t inSize, size_t inputBlockSize, int varSizes)
+{
+    BYTE header[FIO_VARSIZE_MAXBYTES*2 + 2];   /* block header, followed by rle byte */
+    size_t headerSize;
+    switch(cSize)
+    {
+    case 0: /* raw */
+        headerSize = FIO_writeBlockHeader(header, bt_raw, inSize, inSize, inputBlockSize, varSizes);
+        { size_t const sizeCheck = fwrite(header, 1, headerSize, foutput);
+          if (sizeCheck!=headerSize) EXM_THROW(24, "Write error : cannot write block header"); }
+        { size_t const sizeCheck = fwrite(in_buff, 1, inSize, foutput);
+          if (sizeCheck!=(size_t)(inSize)) EXM_THROW(25, "Write error : cannot write block"); }
+        return inSize + headerSize;
+    case 1: /* rle */
+        headerSize = FIO_writeBlockHeader(header, bt_rle, inSize, 1, inputBlockSize, varSizes);
+        header[headerSize] = (BYTE)in_buff[0];
+        { size_t const sizeCheck = fwrite(header, 1, headerSize+1, foutput);
+          if (sizeCheck!=(headerSize+1)) EXM_THROW(26, "Write error : cannot write rle block"); }
+        return headerSize + 1;
+    default : /* compressed */
+        headerSize = FIO_writeBlockHeader(header, bt_compressed, inSize, cSize, inputBlockSize, varSizes);
+        memcpy(out_buff + FIO_maxBlockHeaderSize - headerSize, header, headerSize);   /* header just before compressed data */
+        { size_t const sizeCheck = fwrite(out_buff + (FIO_maxBlockHeaderSize-headerSize), 1, headerSize+cSize, foutput);
+          if (sizeCheck!=(headerSize+cSize)) EXM_THROW(27, "Write error : cannot write rle block"); }
+        return headerSize + cSize;
+    }
+}
+
+
+/* Input of compression : read from `finput` into block buffers, or accessed directly within mapped input */
+typedef struct {
+    FILE* finput;
+    const char* map;     /* mapped input, or NULL */
+    size_t mapSize;
+    size_t mapPos;
+    const char* carry;   /* stdio : tail of previous block, not yet compressed (block split mode) */
+    size_t carrySize;
+    XXH32_state_t* xxhState;
+    U64 filesize;
+} FIO_cInput_t;
+
+/* FIO_nextBlock() :
+   selects next block of input, updating checksum in sequence.
+   with stdio, block is read into `buffer` (`blockSize` capacity), after the tail of previous block.
+   @return : size of block starting at `*blockPtr`, 0 at end of input */
+static size_t FIO_nextBlock(FIO_cInput_t* input, char* buffer, size_t blockSize, const char** blockPtr)
+{
+    const char* block;
+    size_t inFill, inSize;
+
+    /* Fill input Buffer */
+    if (input->map) {
+        block = input->map + input->mapPos;
+        inFill = MIN(blockSize, input->mapSize - input->mapPos);
+    } else {
+        size_t readSize;
+        if (input->carrySize) memmove(buffer, input->carry, input->carrySize);   /* may overlap */
+        readSize = fread(buffer + input->carrySize, (size_t)1, blockSize - input->carrySize, input->finput);
+        XXH32_update(input->xxhState, buffer + input->carrySize, readSize);
+        input->filesize += readSize;
+        block = buffer;
+        inFill = input->carrySize + readSize;
+    }
+    if (inFill==0) return 0;
+
+    /* Select block size */
+    inSize = inFill;
+    if (g_splitMode) {
+        inSize = FSE_findBlockSplit(block, inFill, FSE_DEFAULT_TABLELOG, g_splitMode==1);
+        if (FSE_isError(inSize)) EXM_THROW(23, "Block splitting error : %s ", FSE_getErrorName(inSize));
+    }
+
+    /* keep remaining input for next block */
+    if (input->map) {
+        XXH32_update(input->xxhState, block, inSize);
+        input->filesize += inSize;
+        input->mapPos += inSize;
+    } else {
+        input->carry = block + inSize;
+        input->carrySize = inFill - inSize;
+    }
+    *blockPtr = block;
+    return inSize;
+}
+
+
+/*-************************************
+*  Seek table
+**************************************/
+/* one entry per block, in frame order; block offsets are sums of previous entries */
+typedef struct {
+    U32 cSize;      /* including block header */
+    U32 rSize;
+    U32 checksum;   /* xxh32() of regenerated block */
+} FIO_seekEntry_t;
+
+typedef struct {
+    FIO_seekEntry_t* entries;
+    size_t nbEntries;
+    size_t capacity;
+} FIO_seekTable_t;
+
+static void FIO_seekTable_add(FIO_seekTable_t* table, size_t cSize, const void* block, size_t rSize)
+{
+    if (table->nbEntries == table->capacity) {
+        size_t const newCapacity = table->capacity ? 2*table->capacity : 256;
+        FIO_seekEntry_t* const newEntries = (FIO_seekEntry_t*)realloc(table->entries, newCapacity * sizeof(FIO_seekEntry_t));
+        if (!newEntries) EXM_THROW(21, "Allocation error : not enough memory");
+        table->entries = newEntries;
+        table->capacity = newCapacity;
+    }
+    table->entries[table->nbEntries].cSize = (U32)cSize;
+    table->entries[table->nbEntries].rSize = (U32)rSize;
+    table->entries[table->nbEntries].checksum = XXH32(block, rSize, FSE_CHECKSUM_SEED);
+    table->nbEntries++;
+}
+
+/* FIO_writeSeekTable() :
+   @return : nb of bytes written into `foutput` */
+static size_t FIO_writeSeekTable(FILE* foutput, const FIO_seekTable_t* table)
+{
+    BYTE buffer[FIO_SEEKENTRYSIZE * 64];
+    size_t n = 0;
+    if ((U64)table->nbEntries > 0xFFFFFFFFU) EXM_THROW(28, "Write error : too many blocks for seek table");
+    while (n < table->nbEntries) {
+        size_t const nbEntries = MIN(table->nbEntries - n, 64);
+        size_t u;
+        for (u=0; u<nbEntries; u++) {
+            FIO_writeLE32(buffer + u*FIO_SEEKENTRYSIZE,     table->entries[n+u].cSize);
+            FIO_writeLE32(buffer + u*FIO_SEEKENTRYSIZE + 4, table->entries[n+u].rSize);
+            FIO_writeLE32(buffer + u*FIO_SEEKENTRYSIZE + 8, table->entries[n+u].checksum);
+        }
+        { size_t const sizeCheck = fwrite(buffer, 1, nbEntries * FIO_SEEKENTRYSIZE, foutput);
+          if (sizeCheck != nbEntries * FIO_SEEKENTRYSIZE) EXM_THROW(28, "Write error : cannot write seek table"); }
+        n += nbEntries;
+    }
+    FIO_writeLE32(buffer, (U32)table->nbEntries);
+    buffer[4] = 0;   /* descriptor : reserved */
+    FIO_writeLE32(buffer+5, FIO_magicNumber_seekTable);
+    { size_t const sizeCheck = fwrite(buffer, 1, FIO_SEEKFOOTERSIZE, foutput);
+      if (sizeCheck != FIO_SEEKFOOTERSIZE) EXM_THROW(28, "Write error : cannot write seek table"); }
+    return table->nbEntries * FIO_SEEKENTRYSIZE + FIO_SEEKFOOTERSIZE;
+}
+
+
+#if THREAD_SUPPORT
+
+/* Multi-threaded compression :
+   main thread reads blocks (selecting block sizes and updating checksum in sequence),
+   workers compress them, then main thread writes them in their original order.
+   Since blocks are independent, and cut exactly as in single-thread mode, output is identical. */
+typedef struct {
+    compressor_t compressor;
+    size_t dstCapacity;
+} FIO_cParams_t;
+
+static void FIO_compressJob(FIO_job_t* job, void* workerCtx, const void* sharedCtx)
+{
+    const FIO_cParams_t* const params = (const FIO_cParams_t*)sharedCtx;
+    (void)workerCtx;
+    job->result = params->compressor(job->out + FIO_maxBlockHeaderSize, params->dstCapacity, job->in, job->inSize);
+}
+
+/* FIO_compressBlocks_mt() :
+   compresses all blocks of `input` into `foutput`, using `nbThreads` workers.
+   blocks are recorded into `seekTable`, unless it is NULL.
+   @return : nb of bytes written into `foutput` */
+static U64 FIO_compressBlocks_mt(FILE* foutput, FIO_cInput_t* input, FIO_seekTable_t* seekTable,
+                                 compressor_t compressor, size_t inputBlockSize, int varSizes, unsigned nbThreads)
+{
+    FIO_cParams_t params;
+    FIO_pool_t* pool;
+    unsigned const nbJobs = g_inFlightBlocks ? g_inFlightBlocks : 2*nbThreads;
+    U64 compressedSize = 0;
+    int endOfInput = 0;
+
+    params.compressor = compressor;
+    params.dstCapacity = FSE_compressBound(inputBlockSize);
+    pool = FIO_createPool(nbThreads, NULL, nbJobs,
+                          input->map ? 0 : inputBlockSize, FSE_compressBound(inputBlockSize) + FIO_maxBlockHeaderSize,
+                          FIO_compressJob, &params);
+
+    /* Main loop */
+    while (1) {
+        FIO_job_t* job;
+
+        /* read and post blocks, as long as slots are available */
+        while (!endOfInput && ((job = FIO_pool_nextJob(pool)) != NULL)) {
+            job->inSize = FIO_nextBlock(input, job->src, inputBlockSize, &job->in);
+            if (job->inSize==0) { endOfInput = 1; break; }
+            DISPLAYUPDATE(2, "\rRead : %u MB   ", (U32)(input->filesize>>20));
+            job->out = job->dst;
+            FIO_pool_postJob(pool);
+        }
+
+        /* write oldest block */
+        job = FIO_pool_oldestJob(pool);
+        if (job == NULL) break;   /* all blocks written */
+        if (FSE_isError(job->result)) EXM_THROW(23, "Compression error : %s ", FSE_getErrorName(job->result));
+        {   size_t const writtenSize = FIO_writeBlock(foutput, job->out, job->result, job->in, job->inSize, inputBlockSize, varSizes);
+            if (seekTable) FIO_seekTable_add(seekTable, writtenSize, job->in, job->inSize);
+            compressedSize += writtenSize;
+        }
+        FIO_pool_retireJob(pool);
+        DISPLAYUPDATE(2, "\rRead : %u MB  ==> %.2f%%   ", (U32)(input->filesize>>20), (double)compressedSize/input->filesize*100);
+    }
+
+    FIO_freePool(pool);
+    return compressedSize;
+}
+
+#endif   /* THREAD_SUPPORT */
+
+
 /*
-Compressed format : MAGICNUMBER - STREAMDESCRIPTOR - ( BLOCKHEADER - COMPRESSEDBLOCK ) - STREAMCRC
+Compressed format : MAGICNUMBER - STREAMDESCRIPTOR - ( BLOCKHEADER - COMPRESSEDBLOCK ) - STREAMCRC - [SEEKTABLE]
 MAGICNUMBER - 4 bytes - Designates compression algo
 STREAMDESCRIPTOR - 1 byte
-    bits 0-3 : max block size, 2^value from 0 to 0xA; min 0=>1KB, max 0x6=>64KB, typical 5=>32 KB
-    bits 4-7 = 0 : reserved;
-BLOCKHEADER - 1-5 bytes
+    bits 0-3 : max block size, 2^value KB; min 0=>1KB, max 0xF=>32MB, typical 5=>32 KB
+    bit 4 : table repeat : a compressed block may re-use the table of previous compressed block
+    bit 5 : variable-length block sizes; mandatory for block size > 0x6 (64KB)
+    bits 6-7 = 0 : reserved;
+BLOCKHEADER - 1-5 bytes (1-9 bytes with variable-length sizes)
     1st byte :
     bits 6-7 : blockType (compressed, raw, rle, crc (end of Frame)
     bit 5 : full block
     ** if not full block **
-    2nd & 3rd byte : regenerated size of block (big endian); note : 0 = 64 KB
+    regenerated size of block
     ** if blockType==compressed **
-    next 2 bytes : compressed size of block
+    compressed size of block
+    sizes are 2 bytes (big endian), or with variable-length sizes, 1-4 bytes :
+    7 bits per byte, little endian, high bit set when more bytes follow
 COMPRESSEDBLOCK
     the compressed data itself.
 STREAMCRC - 3 bytes (including 1-byte blockheader)
     22 bits (xxh32() >> 5) checksum of the original data, big endian
+SEEKTABLE - optional, after end of frame, so that sequential decoders ignore it
+    ( BLOCKENTRY ) - 12 bytes per block, little endian
+        4 bytes : compressed size of block, including block header
+        4 bytes : regenerated size of block
+        4 bytes : xxh32() of regenerated block
+    4 bytes : nb of blocks
+    1 byte : descriptor, 0 (reserved)
+    4 bytes : seek table magic number
 */
 unsigned long long FIO_compressFilename(const char* output_filename, const char* input_filename)
 {
-    U64 filesize = 0;
     U64 compressedfilesize = 0;
     FILE* finput;
     FILE* foutput;
-    size_t const inputBlockSize = FIO_blockID_to_blockSize(g_blockSizeId);
+    U32 const blockSizeId = ((g_compressor == FIO_zlibh) && (g_blockSizeId > FIO_maxBlockSizeID_16bits)) ?
+                            FIO_maxBlockSizeID_16bits : g_blockSizeId;   /* zlibh is limited to 64 KB blocks */
+    size_t const inputBlockSize = FIO_blockID_to_blockSize(blockSizeId);
+    int const varSizes = (blockSizeId > FIO_maxBlockSizeID_16bits);
     char* const in_buff = (char*)malloc(inputBlockSize);
-    char* const out_buff = (char*)malloc(FSE_compressBound(inputBlockSize) + 5);
+    char* const out_buff = (char*)malloc(FSE_compressBound(inputBlockSize) + FIO_maxBlockHeaderSize);
     XXH32_state_t xxhState;
-    typedef size_t (*compressor_t) (void* dst, size_t dstSize, const void* src, size_t srcSize);
+    FIO_cInput_t input;
+    FIO_map_t inMap = { NULL, 0 };
+    FIO_seekTable_t table = { NULL, 0, 0 };
+    FIO_seekTable_t* const seekTable = g_seekTable ? &table : NULL;
     compressor_t compressor;
     unsigned magicNumber;
+    unsigned const repeatMode = g_repeatMode && !g_seekTable;
+    unsigned repeat = 0;
+    unsigned nbThreads = g_nbThreads;
 
 
     /* Init */
     if (!in_buff || !out_buff) EXM_THROW(21, "Allocation error : not enough memory");
     XXH32_reset (&xxhState, FSE_CHECKSUM_SEED);
     get_fileHandle(input_filename, output_filename, &finput, &foutput);
+    if (g_mmapMode) inMap = FIO_mapInput(finput);
+    if (inMap.start) DISPLAYLEVEL(4, "Using memory-mapped input \n");
+    memset(&input, 0, sizeof(input));
+    input.finput = finput;
+    input.map = (const char*)inMap.start;
+    input.mapSize = inMap.size;
+    input.xxhState = &xxhState;
+    if (blockSizeId != g_blockSizeId)
+        DISPLAYLEVEL(2, "Warning : zlibh is limited to %u KB blocks \n", (unsigned)(inputBlockSize >> 10));
+    if (g_repeatMode && g_seekTable)
+        DISPLAYLEVEL(2, "Warning : seek table requires independent blocks, table repeat mode disabled \n");
     switch (g_compressor)
     {
     case FIO_fse:
         compressor = FSE_compress;
         magicNumber = FIO_magicNumber_fse;
+        if (repeatMode) {
+            g_fseCCtx = FSE_createCCtx();
+            if (!g_fseCCtx) EXM_THROW(21, "Allocation error : not enough memory");
+            compressor = FIO_FSE_compressRepeat;
+            repeat = 1;
+        }
         break;
     case FIO_huf:
-        compressor = HUF_compress;
+        compressor = (inputBlockSize > HUF_BLOCKSIZE_MAX) ? FIO_HUF_compressLarge : HUF_compress;
         magicNumber = FIO_magicNumber_huf;
+        if (repeatMode && (inputBlockSize > HUF_BLOCKSIZE_MAX)) {
+            DISPLAYLEVEL(2, "Warning : HUF table repeat mode is limited to %u KB blocks, disabled \n", HUF_BLOCKSIZE_MAX >> 10);
+        } else if (repeatMode) {
+            g_hufCCtx = HUF_createCCtx();
+            if (!g_hufCCtx) EXM_THROW(21, "Allocation error : not enough memory");
+            compressor = FIO_HUF_compressRepeat;
+            repeat = 1;
+        }
         break;
     case FIO_zlibh:
         compressor = FIO_ZLIBH_compress;
@@ -312,84 +889,47 @@ unsigned long long FIO_compressFilename(const char* output_filename, const char*
     default :
         EXM_THROW(20, "unknown compressor selection");
     }
+    if (nbThreads > 1) {
+        if (!THREAD_SUPPORT) {
+            DISPLAYLEVEL(2, "Warning : multi-threading not enabled (FSE_original_MULTITHREAD), using a single thread \n");
+            nbThreads = 1;
+        } else if (repeat) {
+            DISPLAYLEVEL(2, "Warning : table repeat mode chains blocks, using a single thread \n");
+            nbThreads = 1;
+    }   }
 
     /* Write Frame Header */
     FIO_writeLE32(out_buff, magicNumber);
-    out_buff[4] = (char)g_blockSizeId;          /* Max Block Size descriptor */
+    out_buff[4] = (char)(blockSizeId + (repeat ? FIO_FLAG_REPEAT : 0) + (varSizes ? FIO_FLAG_VARSIZES : 0));   /* Max Block Size descriptor */
     { size_t const sizeCheck = fwrite(out_buff, 1, FIO_FRAMEHEADERSIZE, foutput);
       if (sizeCheck!=FIO_FRAMEHEADERSIZE) EXM_THROW(22, "Write error : cannot write header"); }
     compressedfilesize += FIO_FRAMEHEADERSIZE;
 
+#if THREAD_SUPPORT
+    if (nbThreads > 1) {
+        DISPLAYLEVEL(4, "Compressing with %u threads \n", nbThreads);
+        compressedfilesize += FIO_compressBlocks_mt(foutput, &input, seekTable, compressor, inputBlockSize, varSizes, nbThreads);
+    } else
+#endif
     /* Main compression loop */
     while (1) {
-        /* Fill input Buffer */
+        const char* block;
         size_t cSize;
-        size_t const inSize = fread(in_buff, (size_t)1, (size_t)inputBlockSize, finput);
+        size_t const inSize = FIO_nextBlock(&input, in_buff, inputBlockSize, &block);
         if (inSize==0) break;
-        filesize += inSize;
-        XXH32_update(&xxhState, in_buff, inSize);
-        DISPLAYUPDATE(2, "\rRead : %u MB   ", (U32)(filesize>>20));
+        DISPLAYUPDATE(2, "\rRead : %u MB   ", (U32)(input.filesize>>20));
 
         /* Compress Block */
-        cSize = compressor(out_buff + FIO_maxBlockHeaderSize, FSE_compressBound(inputBlockSize), in_buff, inSize);
+        cSize = compressor(out_buff + FIO_maxBlockHeaderSize, FSE_compressBound(inputBlockSize), block, inSize);
         if (FSE_isError(cSize)) EXM_THROW(23, "Compression error : %s ", FSE_getErrorName(cSize));
 
         /* Write cBlock */
-        switch(cSize)
-        {
-        size_t headerSize;
-        case 0: /* raw */
-            if (inSize == inputBlockSize) {
-                out_buff[0] = (BYTE)((bt_raw << 6) + BIT5);
-                headerSize = 1;
-            } else {
-                out_buff[2] = (BYTE)inSize;
-                out_buff[1] = (BYTE)(inSize >> 8);
-                out_buff[0] = (BYTE)(bt_raw << 6);
-                headerSize = 3;
-            }
-            { size_t const sizeCheck = fwrite(out_buff, 1, headerSize, foutput);
-              if (sizeCheck!=headerSize) EXM_THROW(24, "Write error : cannot write block header"); }
-            { size_t const sizeCheck = fwrite(in_buff, 1, inSize, foutput);
-              if (sizeCheck!=(size_t)(inSize)) EXM_THROW(25, "Write error : cannot write block"); }
-            compressedfilesize += inSize + headerSize;
-            break;
-        case 1: /* rle */
-            if (inSize == inputBlockSize) {
-                out_buff[0] = (BYTE)((bt_rle << 6) + BIT5);
-                headerSize = 1;
-            } else {
-                out_buff[2] = (BYTE)inSize;
-                out_buff[1] = (BYTE)(inSize >> 8);
-                out_buff[0] = (BYTE)(bt_rle << 6);
-                headerSize = 3;
-            }
-            out_buff[headerSize] = in_buff[0];
-            { size_t const sizeCheck = fwrite(out_buff, 1, headerSize+1, foutput);
-              if (sizeCheck!=(headerSize+1)) EXM_THROW(26, "Write error : cannot write rle block"); }
-            compressedfilesize += headerSize + 1;
-            break;
-        default : /* compressed */
-            if (inSize == inputBlockSize) {
-                out_buff[2] = (BYTE)((bt_compressed << 6) + BIT5);
-                out_buff[3] = (BYTE)(cSize >> 8);
-                out_buff[4] = (BYTE)cSize;
-                headerSize = 3;
-            } else {
-                out_buff[0] = (BYTE)(bt_compressed << 6);
-                out_buff[1] = (BYTE)(inSize >> 8);
-                out_buff[2] = (BYTE)inSize;
-                out_buff[3] = (BYTE)(cSize >> 8);
-                out_buff[4] = (BYTE)cSize;
-                headerSize = FIO_maxBlockHeaderSize;
-            }
-            { size_t const sizeCheck = fwrite(out_buff+(FIO_maxBlockHeaderSize-headerSize), 1, headerSize+cSize, foutput);
-              if (sizeCheck!=(headerSize+cSize)) EXM_THROW(27, "Write error : cannot write rle block"); }
-            compressedfilesize += headerSize + cSize;
-            break;
+        {   size_t const writtenSize = FIO_writeBlock(foutput, out_buff, cSize, block, inSize, inputBlockSize, varSizes);
+            if (seekTable) FIO_seekTable_add(seekTable, writtenSize, block, inSize);
+            compressedfilesize += writtenSize;
         }
 
-        DISPLAYUPDATE(2, "\rRead : %u MB  ==> %.2f%%   ", (U32)(filesize>>20), (double)compressedfilesize/filesize*100);
+        DISPLAYUPDATE(2, "\rRead : %u MB  ==> %.2f%%   ", (U32)(input.filesize>>20), (double)compressedfilesize/input.filesize*100);
     }
 
     /* Checksum */
@@ -403,14 +943,21 @@ unsigned long long FIO_compressFilename(const char* output_filename, const char*
         compressedfilesize += 3;
     }
 
+    /* Seek table : after frame end, so that it is ignored by decoders reading the frame sequentially */
+    if (seekTable) compressedfilesize += FIO_writeSeekTable(foutput, seekTable);
+
     /* Status */
     DISPLAYLEVEL(2, "\r%79s\r", "");
     DISPLAYLEVEL(2,"Compressed %llu bytes into %llu bytes ==> %.2f%%\n",
-        (unsigned long long) filesize, (unsigned long long) compressedfilesize, (double)compressedfilesize/filesize*100);
+        (unsigned long long) input.filesize, (unsigned long long) compressedfilesize, (double)compressedfilesize/input.filesize*100);
 
     /* clean */
+    FIO_unmap(inMap);
+    free(table.entries);
     free(in_buff);
     free(out_buff);
+    FSE_freeCCtx(g_fseCCtx); g_fseCCtx = NULL;
+    HUF_freeCCtx(g_hufCCtx); g_hufCCtx = NULL;
     fclose(finput);
     fclose(foutput);
 
@@ -425,177 +972,693 @@ size_t FIO_ZLIBH_decompress(void* dst, size_t dstSize, const void* src, size_t s
     return (size_t) ZLIBH_decompress ((char*)dst, (const char*)src);
 }
 
+/* decoding tables are kept into contexts : they are needed by table repeat mode, and cached for identical headers.
+   each decoding thread owns its context */
+#define FIO_DTABLE_CACHE_SIZE 4
+typedef struct {
+    U32 magicNumber;
+    FSE_DCtx* fseDCtx;
+    HUF_DTableCache* hufDCache;
+} FIO_dCtx_t;
+
+static void FIO_initDCtx(FIO_dCtx_t* dctx, U32 magicNumber)
+{
+    memset(dctx, 0, sizeof(*dctx));
+    dctx->magicNumber = magicNumber;
+    switch(magicNumber)
+    {
+    case FIO_magicNumber_fse:
+        dctx->fseDCtx = FSE_createDCtx_advanced(FIO_DTABLE_CACHE_SIZE);
+        if (!dctx->fseDCtx) EXM_THROW(33, "Allocation error : not enough memory");
+        break;
+    case FIO_magicNumber_huf:
+        dctx->hufDCache = HUF_createDTableCache(FIO_DTABLE_CACHE_SIZE);
+        if (!dctx->hufDCache) EXM_THROW(33, "Allocation error : not enough memory");
+        break;
+    default:   /* FIO_magicNumber_zlibh : no context */
+        break;
+    }
+}
+
+static void FIO_freeDCtx(FIO_dCtx_t* dctx)
+{
+    FSE_freeDCtx(dctx->fseDCtx);
+    HUF_freeDTableCache(dctx->hufDCache);
+    memset(dctx, 0, sizeof(*dctx));
+}
+
+static size_t FIO_decompressBlock(FIO_dCtx_t* dctx, void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    switch(dctx->magicNumber)
+    {
+    case FIO_magicNumber_fse: return FSE_decompressDCtx(dctx->fseDCtx, dst, dstSize, src, srcSize);
+    case FIO_magicNumber_huf: return HUF_decompress4X_usingDTableCache(dctx->hufDCache, dst, dstSize, src, srcSize);
+    default: return FIO_ZLIBH_decompress(dst, dstSize, src, srcSize);
+    }
+}
+
+static void FIO_addDCtxCacheStats(const FIO_dCtx_t* dctx, unsigned long long* hits, unsigned long long* misses)
+{
+    unsigned long long h = 0, m = 0;
+    if (dctx->fseDCtx) FSE_getDCtxCacheStats(dctx->fseDCtx, &h, &m);
+    if (dctx->hufDCache) HUF_getDTableCacheStats(dctx->hufDCache, &h, &m);
+    *hits += h; *misses += m;
+}
+
+/* Input of decompression : read from `finput`, or accessed directly within mapped input */
+typedef struct {
+    FILE* finput;
+    const BYTE* map;   /* mapped input, or NULL */
+    size_t mapSize;
+    size_t mapPos;
+    int varSizes;      /* block headers store variable-length sizes (set by FIO_readFrameHeader()) */
+} FIO_dInput_t;
+
+/* FIO_readInput() :
+   @return : pointer to next `size` bytes of input, either within mapped input, or read into `buffer`;
+             NULL if input is too short */
+static const BYTE* FIO_readInput(FIO_dInput_t* input, void* buffer, size_t size)
+{
+    if (input->map) {
+        const BYTE* const p = input->map + input->mapPos;
+        if (size > input->mapSize - input->mapPos) return NULL;
+        input->mapPos += size;
+        return p;
+    }
+    if (fread(buffer, 1, size, input->finput) != size) return NULL;
+    return (const BYTE*)buffer;
+}
+
+/* FIO_seekInput() :
+   moves to `offset` bytes from start of input, or from its end if `fromEnd`.
+   @return : 0 on success, non-zero if input is not seekable or too short */
+static int FIO_seekInput(FIO_dInput_t* input, U64 offset, int fromEnd)
+{
+    if (input->map) {
+        if (offset > input->mapSize) return 1;
+        input->mapPos = fromEnd ? input->mapSize - (size_t)offset : (size_t)offset;
+        return 0;
+    }
+    if (offset > (U64)0x7FFFFFFFFFFFFFFFULL) return 1;
+    return LONG_SEEK(input->finput, fromEnd ? -(S64)offset : (S64)offset, fromEnd ? SEEK_END : SEEK_SET);
+}
+
+/* Output of decompression : written into `foutput`, or directly into mapped output */
+typedef struct {
+    FILE* foutput;
+    BYTE* map;          /* mapped output, pre-sized to frame content, or NULL */
+    size_t mapSize;
+    size_t reserved;    /* mapped output : start of next block */
+    XXH32_state_t* xxhState;
+    U64 filesize;
+} FIO_dOutput_t;
+
+/* FIO_reserveOutput() :
+   @return : where to decode next block of `size` bytes : either within mapped output, or `buffer` */
+static BYTE* FIO_reserveOutput(FIO_dOutput_t* output, BYTE* buffer, size_t size)
+{
+    BYTE* op;
+    if (!output->map) return buffer;
+    if (size > output->mapSize - output->reserved) EXM_THROW(45, "Corrupted frame : content larger than announced by block headers");
+    op = output->map + output->reserved;
+    output->reserved += size;
+    return op;
+}
+
+/* FIO_commitOutput() :
+   writes `block` (unless already within mapped output), and updates checksum; blocks must be committed in sequence */
+static void FIO_commitOutput(FIO_dOutput_t* output, const void* block, size_t size)
+{
+    if (!output->map) {
+        size_t const writeSizeCheck = fwrite(block, 1, size, output->foutput);
+        if (writeSizeCheck != size) EXM_THROW(41, "Write error : unable to write data block to destination file");
+    }
+    XXH32_update(output->xxhState, block, size);
+    output->filesize += size;
+}
+
+/* FIO_readBlockSize() :
+   reads a size field of block header : 16-bits big endian, or variable-length size.
+   throws `errorCode` if input is too short */
+static size_t FIO_readBlockSize(FIO_dInput_t* input, int errorCode)
+{
+    BYTE buffer[2];
+    const BYTE* p;
+    if (!input->varSizes) {
+        p = FIO_readInput(input, buffer, 2);
+        if (p == NULL) EXM_THROW(errorCode, "Read error : cannot read header\n");
+        return ((size_t)p[0]<<8) + p[1];
+    }
+    {   size_t value = 0;
+        unsigned n;
+        for (n=0; n<FIO_VARSIZE_MAXBYTES; n++) {
+            p = FIO_readInput(input, buffer, 1);
+            if (p == NULL) EXM_THROW(errorCode, "Read error : cannot read header\n");
+            value += (size_t)(p[0] & 0x7F) << (7*n);
+            if (!(p[0] & 0x80)) return value;
+        }
+        EXM_THROW(errorCode, "Corrupted block header : size field too long\n");
+    }
+}
+
+/* FIO_readBlockHeader() :
+   `bHeader` is 1st byte of block header, already read; reads the rest of block header from `input`.
+   sizes are checked against `blockSize`, so that block content fits into block-sized buffers.
+   @return : block type; for bt_crc, *rSizePtr and *cSizePtr are not modified */
+static bType_t FIO_readBlockHeader(FIO_dInput_t* input, BYTE bHeader, size_t blockSize, size_t* rSizePtr, size_t* cSizePtr)
+{
+    bType_t const bType = (bType_t)((bHeader & (BIT7+BIT6)) >> 6);
+    size_t rSize = blockSize;
+    if (bType == bt_crc) return bt_crc;   /* end - frame content CRC */
+    if (!(bHeader & BIT5)) {   /* non full block */
+        rSize = FIO_readBlockSize(input, 35);
+        if (rSize > blockSize) EXM_THROW(35, "Corrupted block header : block too large\n");
+    }
+
+    switch(bType)
+    {
+      case bt_compressed :
+        *cSizePtr = FIO_readBlockSize(input, 36);
+        if (*cSizePtr > blockSize) EXM_THROW(36, "Corrupted block header : block too large\n");
+        break;
+      case bt_raw :
+        *cSizePtr = rSize;
+        break;
+      case bt_rle :
+        *cSizePtr = 1;
+        break;
+      case bt_crc :
+      default :
+        EXM_THROW(37, "unknown block header");   /* should not happen */
+    }
+    *rSizePtr = rSize;
+    return bType;
+}
+
+/* FIO_readFrameHeader() :
+   reads and checks frame header.
+   @return : magic number, designating compression algo */
+static U32 FIO_readFrameHeader(FIO_dInput_t* input, U32* blockSizePtr, U32* repeatPtr)
+{
+    U32   header32[(FIO_FRAMEHEADERSIZE+3) >> 2];
+    const BYTE* const header = FIO_readInput(input, header32, FIO_FRAMEHEADERSIZE);
+    U32 magicNumber;
+    if (header == NULL) EXM_THROW(30, "Read error : cannot read header\n");
+
+    {   U32 const blockSizeId = header[4] & 15;
+        U32 const flags = header[4] - blockSizeId;
+        if (flags & ~(FIO_FLAG_REPEAT | FIO_FLAG_VARSIZES)) EXM_THROW(32, "Wrong version : unknown header flags\n");
+        input->varSizes = (flags & FIO_FLAG_VARSIZES) != 0;
+        if ((blockSizeId > FIO_maxBlockSizeID_16bits) && !input->varSizes) EXM_THROW(32, "Wrong version : unknown header flags\n");
+        *repeatPtr = (flags & FIO_FLAG_REPEAT) != 0;
+        *blockSizePtr = FIO_blockID_to_blockSize(blockSizeId);
+    }
+
+    magicNumber = FIO_readLE32(header);
+    switch(magicNumber)
+    {
+    case FIO_magicNumber_fse:
+    case FIO_magicNumber_huf:
+        break;
+    case FIO_magicNumber_zlibh:
+        if (*repeatPtr || input->varSizes) EXM_THROW(32, "Wrong version : unknown header flags\n");
+        break;
+    default :
+        EXM_THROW(31, "Wrong file type : unknown header\n");
+    }
+    return magicNumber;
+}
+
+/* FIO_frameContentSize() :
+   walks block headers of mapped `input`, starting with 1st byte `bHeader`, without decoding.
+   @return : total regenerated size of frame */
+static U64 FIO_frameContentSize(FIO_dInput_t input, BYTE bHeader, size_t blockSize)
+{
+    U64 contentSize = 0;
+    while (1) {
+        size_t rSize, cSize;
+        const BYTE* cBlock;
+        bType_t const bType = FIO_readBlockHeader(&input, bHeader, blockSize, &rSize, &cSize);
+        if (bType == bt_crc) break;
+        cBlock = FIO_readInput(&input, NULL, cSize+1);   /* mapped : no buffer needed */
+        if (cBlock == NULL) EXM_THROW(38, "Read error");
+        bHeader = cBlock[cSize];
+        contentSize += rSize;
+    }
+    return contentSize;
+}
+
+
+/* FIO_decompressBlocks() :
+   decodes all blocks of `input` into `output`, in a single thread.
+   `bHeader` is 1st byte of first block header.
+   @return : 1st byte of frame CRC header */
+static BYTE FIO_decompressBlocks(FIO_dOutput_t* output, FIO_dInput_t* input, BYTE bHeader,
+                                 U32 magicNumber, size_t blockSize)
+{
+    BYTE* const in_buff  = (BYTE*)malloc(blockSize + FIO_maxBlockHeaderSize);
+    BYTE* const out_buff = (BYTE*)malloc(blockSize);
+    FIO_dCtx_t dctx;
+
+    if (!in_buff || !out_buff) EXM_THROW(33, "Allocation error : not enough memory");
+    FIO_initDCtx(&dctx, magicNumber);
+
+    /* Main Loop */
+    while (1) {
+        size_t rSize, cSize;
+        const BYTE* cBlock;
+        const BYTE* block;
+        bType_t const bType = FIO_readBlockHeader(input, bHeader, blockSize, &rSize, &cSize);
+        if (bType == bt_crc) break;   /* end - frame content CRC */
+
+        /* Fill input buffer, followed by next block header */
+        cBlock = FIO_readInput(input, in_buff, cSize+1);
+        if (cBlock == NULL) EXM_THROW(38, "Read error");
+        bHeader = cBlock[cSize];
+
+        /* Decode block */
+        switch(bType)
+        {
+          case bt_compressed :
+            {   BYTE* const op = FIO_reserveOutput(output, out_buff, rSize);
+                rSize = FIO_decompressBlock(&dctx, op, rSize, cBlock, cSize);
+                if (FSE_isError(rSize)) EXM_THROW(39, "Decoding error : %s", FSE_getErrorName(rSize));
+                block = op;
+                break;
+            }
+          case bt_raw :
+            block = cBlock;   /* stdio : written directly from input */
+            if (output->map) {
+                BYTE* const op = FIO_reserveOutput(output, out_buff, rSize);
+                memcpy(op, cBlock, rSize);
+                block = op;
+            }
+            break;
+          case bt_rle :
+            {   BYTE* const op = FIO_reserveOutput(output, out_buff, rSize);
+                memset(op, cBlock[0], rSize);
+                block = op;
+                break;
+            }
+          case bt_crc :
+          default :
+            EXM_THROW(40, "unknown block header");   /* should not happen */
+        }
+
+        /* Write block */
+        FIO_commitOutput(output, block, rSize);
+    }
+
+    {   unsigned long long hits = 0, misses = 0;
+        FIO_addDCtxCacheStats(&dctx, &hits, &misses);
+        DISPLAYLEVEL(4, "Decoding tables : %llu built, %llu found in cache\n", misses, hits);
+    }
+
+    /* clean */
+    FIO_freeDCtx(&dctx);
+    free(in_buff);
+    free(out_buff);
+    return bHeader;
+}
+
+
+#if THREAD_SUPPORT
+
+/* Multi-threaded decompression :
+   main thread reads block headers and payloads, workers decode blocks,
+   then main thread writes them in their original order, updating checksum.
+   Only possible when blocks are independent, hence not with table repeat mode. */
+static void FIO_decompressJob(FIO_job_t* job, void* workerCtx, const void* sharedCtx)
+{
+    FIO_dCtx_t* const dctx = (FIO_dCtx_t*)workerCtx;
+    (void)sharedCtx;
+    switch(job->type)
+    {
+      case bt_compressed :
+        job->result = FIO_decompressBlock(dctx, job->out, job->outSize, job->in, job->inSize);
+        break;
+      case bt_rle :
+        memset(job->out, job->in[0], job->outSize);
+        job->result = job->outSize;
+        break;
+      case bt_raw :   /* stdio (no `out`) : will be written directly from `in` */
+      default :
+        if (job->out) memcpy(job->out, job->in, job->inSize);
+        job->result = job->inSize;
+        break;
+    }
+}
+
+/* FIO_decompressBlocks_mt() :
+   decodes all blocks of `input` into `output`, using `nbThreads` workers.
+   `bHeader` is 1st byte of first block header.
+   @return : 1st byte of frame CRC header */
+static BYTE FIO_decompressBlocks_mt(FIO_dOutput_t* output, FIO_dInput_t* input, BYTE bHeader,
+                                    U32 magicNumber, size_t blockSize, unsigned nbThreads)
+{
+    FIO_dCtx_t* const dctxs = (FIO_dCtx_t*)malloc(nbThreads * sizeof(FIO_dCtx_t));
+    void** const dctxPtrs = (void**)malloc(nbThreads * sizeof(void*));
+    unsigned const nbJobs = g_inFlightBlocks ? g_inFlightBlocks : 2*nbThreads;
+    FIO_pool_t* pool;
+    int endOfFrame = 0;
+
+    if (!dctxs || !dctxPtrs) EXM_THROW(33, "Allocation error : not enough memory");
+    {   unsigned t;
+        for (t=0; t<nbThreads; t++) { FIO_initDCtx(dctxs+t, magicNumber); dctxPtrs[t] = dctxs+t; }
+    }
+    pool = FIO_createPool(nbThreads, dctxPtrs, nbJobs,
+                          input->map ? 0 : blockSize+1, output->map ? 0 : blockSize,
+                          FIO_decompressJob, NULL);
+
+    /* Main loop */
+    while (1) {
+        FIO_job_t* job;
+
+        /* read and post blocks, as long as slots are available */
+        while (!endOfFrame && ((job = FIO_pool_nextJob(pool)) != NULL)) {
+            size_t rSize, cSize;
+            const BYTE* cBlock;
+            bType_t const bType = FIO_readBlockHeader(input, bHeader, blockSize, &rSize, &cSize);
+            if (bType == bt_crc) { endOfFrame = 1; break; }
+
+            /* read block content, followed by next block header */
+            cBlock = FIO_readInput(input, job->src, cSize+1);
+            if (cBlock == NULL) EXM_THROW(38, "Read error");
+            bHeader = cBlock[cSize];
+            job->type = (int)bType;
+            job->in = (const char*)cBlock;
+            job->inSize = cSize;
+            job->out = ((bType == bt_raw) && !output->map) ? NULL : (char*)FIO_reserveOutput(output, (BYTE*)job->dst, rSize);
+            job->outSize = rSize;
+            FIO_pool_postJob(pool);
+        }
+
+        /* write oldest block */
+        job = FIO_pool_oldestJob(pool);
+        if (job == NULL) break;   /* all blocks written */
+        if (FSE_isError(job->result)) EXM_THROW(39, "Decoding error : %s", FSE_getErrorName(job->result));
+        FIO_commitOutput(output, job->out ? job->out : job->in, job->result);
+        FIO_pool_retireJob(pool);
+    }
+
+    FIO_freePool(pool);
+    {   unsigned long long hits = 0, misses = 0;
+        unsigned t;
+        for (t=0; t<nbThreads; t++) { FIO_addDCtxCacheStats(dctxs+t, &hits, &misses); FIO_freeDCtx(dctxs+t); }
+        DISPLAYLEVEL(4, "Decoding tables : %llu built, %llu found in cache\n", misses, hits);
+    }
+    free(dctxPtrs);
+    free(dctxs);
+    return bHeader;
+}
+
+#endif   /* THREAD_SUPPORT */
+
 /*
-Compressed format : MAGICNUMBER - STREAMDESCRIPTOR - ( BLOCKHEADER - COMPRESSEDBLOCK ) - STREAMCRC
+Compressed format : MAGICNUMBER - STREAMDESCRIPTOR - ( BLOCKHEADER - COMPRESSEDBLOCK ) - STREAMCRC - [SEEKTABLE]
 MAGICNUMBER - 4 bytes - Designates compression algo
 STREAMDESCRIPTOR - 1 byte
-    bits 0-3 : max block size, 2^value from 0 to 0xA; min 0=>1KB, max 0x6=>64KB, typical 5=>32 KB
-    bits 4-7 = 0 : reserved;
-BLOCKHEADER - 1-5 bytes
+    bits 0-3 : max block size, 2^value KB; min 0=>1KB, max 0xF=>32MB, typical 5=>32 KB
+    bit 4 : table repeat : a compressed block may re-use the table of previous compressed block
+    bit 5 : variable-length block sizes; mandatory for block size > 0x6 (64KB)
+    bits 6-7 = 0 : reserved;
+BLOCKHEADER - 1-5 bytes (1-9 bytes with variable-length sizes)
     1st byte :
     bits 6-7 : blockType (compressed, raw, rle, crc (end of Frame)
     bit 5 : full block
     ** if not full block **
-    2nd & 3rd byte : regenerated size of block (big endian); note : 0 = 64 KB
+    regenerated size of block
     ** if blockType==compressed **
-    next 2 bytes : compressed size of block
+    compressed size of block
+    sizes are 2 bytes (big endian), or with variable-length sizes, 1-4 bytes :
+    7 bits per byte, little endian, high bit set when more bytes follow
 COMPRESSEDBLOCK
     the compressed data itself.
 STREAMCRC - 3 bytes (including 1-byte blockheader)
     22 bits (xxh32() >> 5) checksum of the original data, big endian
+SEEKTABLE - optional, after end of frame, so that sequential decoders ignore it
+    ( BLOCKENTRY ) - 12 bytes per block, little endian
+        4 bytes : compressed size of block, including block header
+        4 bytes : regenerated size of block
+        4 bytes : xxh32() of regenerated block
+    4 bytes : nb of blocks
+    1 byte : descriptor, 0 (reserved)
+    4 bytes : seek table magic number
 */
 unsigned long long FIO_decompressFilename(const char* output_filename, const char* input_filename)
 {
     FILE* finput, *foutput;
-    U64   filesize = 0;
-    BYTE* in_buff;
-    BYTE* out_buff;
-    BYTE* ip;
+    BYTE  bHeader;
     U32   blockSize;
+    U32   repeat;
+    U32   magicNumber;
+    unsigned nbThreads = g_nbThreads;
     XXH32_state_t xxhState;
-    typedef size_t (*decompressor_t) (void* dst, size_t dstSize, const void* src, size_t srcSize);
-    decompressor_t decompressor = FSE_decompress;
+    FIO_dInput_t input;
+    FIO_dOutput_t output;
+    FIO_map_t inMap = { NULL, 0 };
+    FIO_map_t outMap = { NULL, 0 };
 
     /* Init */
     XXH32_reset(&xxhState, FSE_CHECKSUM_SEED);
     get_fileHandle(input_filename, output_filename, &finput, &foutput);
+    if (g_mmapMode) inMap = FIO_mapInput(finput);
+    memset(&input, 0, sizeof(input));
+    input.finput = finput;
+    input.map = (const BYTE*)inMap.start;
+    input.mapSize = inMap.size;
+    memset(&output, 0, sizeof(output));
+    output.foutput = foutput;
+    output.xxhState = &xxhState;
 
     /* check header */
-    {   U32   header32[(FIO_FRAMEHEADERSIZE+3) >> 2];
-        BYTE* const header = (BYTE*)header32;
+    magicNumber = FIO_readFrameHeader(&input, &blockSize, &repeat);
+    if (nbThreads > 1) {
+        if (!THREAD_SUPPORT) {
+            DISPLAYLEVEL(2, "Warning : multi-threading not enabled (FSE_original_MULTITHREAD), using a single thread \n");
+            nbThreads = 1;
+        } else if (repeat) {
+            DISPLAYLEVEL(2, "Warning : blocks re-use tables of previous blocks, using a single thread \n");
+            nbThreads = 1;
+    }   }
 
-        { size_t const sizeCheck = fread(header, (size_t)1, FIO_FRAMEHEADERSIZE, finput);
-          if (sizeCheck != FIO_FRAMEHEADERSIZE) EXM_THROW(30, "Read error : cannot read header\n"); }
+    /* read first bHeader */
+    {   const BYTE* const p = FIO_readInput(&input, &bHeader, 1);
+        if (p == NULL) EXM_THROW(34, "Read error : cannot read header\n");
+        bHeader = *p;
+    }
 
-        switch(FIO_readLE32(header))   /* magic number */
-        {
-        case FIO_magicNumber_fse:
-            decompressor = FSE_decompress;
-            break;
-        case FIO_magicNumber_huf:
-            decompressor = HUF_decompress;
-            break;
-        case FIO_magicNumber_zlibh:
-            decompressor = FIO_ZLIBH_decompress;
-            break;
-        default :
-            EXM_THROW(31, "Wrong file type : unknown header\n");
-        }
+    /* mapped input : frame content size is known before decoding, so output can be mapped too */
+    if (input.map) {
+        U64 const contentSize = FIO_frameContentSize(input, bHeader, blockSize);
+        outMap = FIO_mapOutput(foutput, contentSize);
+        output.map = (BYTE*)outMap.start;
+        output.mapSize = outMap.size;
+        DISPLAYLEVEL(4, "Using memory-mapped input%s \n", output.map ? " and output" : "");
+    }
 
-        {   U32 const blockSizeId = header[4];
-            if (blockSizeId > FIO_maxBlockSizeID) EXM_THROW(32, "Wrong version : unknown header flags\n");
-            blockSize = FIO_blockID_to_blockSize(blockSizeId);
-    }   }
+    /* decode blocks */
+#if THREAD_SUPPORT
+    if (nbThreads > 1) {
+        DISPLAYLEVEL(4, "Decoding with %u threads \n", nbThreads);
+        bHeader = FIO_decompressBlocks_mt(&output, &input, bHeader, magicNumber, blockSize, nbThreads);
+    } else
+#endif
+    bHeader = FIO_decompressBlocks(&output, &input, bHeader, magicNumber, blockSize);
+    if (output.map && (output.filesize != output.mapSize))
+        EXM_THROW(45, "Corrupted frame : content smaller than announced by block headers");
 
-    /* Allocate Memory */
-    in_buff  = (BYTE*)malloc(blockSize + FIO_maxBlockHeaderSize);
-    out_buff = (BYTE*)malloc(blockSize);
-    if (!in_buff || !out_buff) EXM_THROW(33, "Allocation error : not enough memory");
-    ip = in_buff;
+    /* CRC verification */
+    {   BYTE crcBuffer[2];
+        const BYTE* const crc = FIO_readInput(&input, crcBuffer, 2);
+        if (crc == NULL) EXM_THROW(43, "Read error");
+        {   U32 const CRCsaved = crc[1] + (crc[0]<<8) + ((bHeader & _6BITS) << 16);
+            U32 const CRCcalculated = (XXH32_digest(&xxhState) >> 5) & ((1U<<22)-1);
+            if (CRCsaved != CRCcalculated) EXM_THROW(44, "CRC error : wrong checksum, corrupted data");
+    }   }
 
-    /* read first bHeader */
-    { size_t const sizeCheck = fread(in_buff, 1, 1, finput);
-      if (sizeCheck != 1) EXM_THROW(34, "Read error : cannot read header\n"); }
+    DISPLAYLEVEL(2, "\r%79s\r", "");
+    DISPLAYLEVEL(2, "Decoded %llu bytes\n", (long long unsigned)output.filesize);
 
-    /* Main Loop */
-    while (1) {
-        size_t readSize, bType, rSize=0, cSize;
+    /* clean */
+    FIO_unmap(outMap);
+    FIO_unmap(inMap);
+    fclose(finput);
+    fclose(foutput);
 
-        //static U32 blockNb=0;
-        //printf("blockNb = %u \n", ++blockNb);
+    return output.filesize;
+}
 
-        /* Decode header */
-        bType = (ip[0] & (BIT7+BIT6)) >> 6;
-        if (bType == bt_crc) break;   /* end - frame content CRC */
-        rSize = blockSize;
-        if (!(ip[0] & BIT5)) {   /* non full block */
-            size_t const sizeCheck = fread(in_buff, 1, 2, finput);
-            if (sizeCheck != 2) EXM_THROW(35, "Read error : cannot read header\n");
-            rSize = (in_buff[0]<<8) + in_buff[1];
-        }
 
-        switch(bType)
-        {
-          case bt_compressed :
-            {   size_t const sizeCheck = fread(in_buff, 1, 2, finput);
-                if (sizeCheck != 2) EXM_THROW(36, "Read error : cannot read header\n");
-                cSize = (in_buff[0]<<8) + in_buff[1];
-                break;
+/* FIO_readSeekTable() :
+   looks for a seek table at end of `input`, and checks it against `blockSize`.
+   input position is left after frame header.
+   @return : table (to be freed), or NULL if input has no seek table or is not seekable */
+static FIO_seekEntry_t* FIO_readSeekTable(FIO_dInput_t* input, size_t blockSize, size_t* nbEntriesPtr)
+{
+    BYTE buffer[FIO_SEEKENTRYSIZE * 64];
+    FIO_seekEntry_t* table = NULL;
+    size_t nbEntries = 0;
+    if (FIO_seekInput(input, FIO_SEEKFOOTERSIZE, 1)) return NULL;   /* not seekable, or too short */
+    {   const BYTE* const footer = FIO_readInput(input, buffer, FIO_SEEKFOOTERSIZE);
+        if ( (footer != NULL) && (FIO_readLE32(footer+5) == FIO_magicNumber_seekTable) && (footer[4] == 0) ) {
+            U32 const nbBlocks = FIO_readLE32(footer);
+            U64 const tableSize = (U64)nbBlocks * sizeof(FIO_seekEntry_t) + 1;
+            if ( (tableSize == (size_t)tableSize)   /* fits into address space */
+              && !FIO_seekInput(input, (U64)nbBlocks * FIO_SEEKENTRYSIZE + FIO_SEEKFOOTERSIZE, 1) ) {   /* input holds announced table */
+                nbEntries = nbBlocks;
+                table = (FIO_seekEntry_t*)malloc((size_t)tableSize);
+                if (!table) EXM_THROW(33, "Allocation error : not enough memory");
+    }   }   }
+    if (table) {
+        size_t n = 0;
+        while (n < nbEntries) {
+            size_t const toRead = MIN(nbEntries - n, 64);
+            const BYTE* const entries = FIO_readInput(input, buffer, toRead * FIO_SEEKENTRYSIZE);
+            size_t u;
+            if (entries == NULL) EXM_THROW(43, "Read error : cannot read seek table");
+            for (u=0; u<toRead; u++) {
+                table[n+u].cSize    = FIO_readLE32(entries + u*FIO_SEEKENTRYSIZE);
+                table[n+u].rSize    = FIO_readLE32(entries + u*FIO_SEEKENTRYSIZE + 4);
+                table[n+u].checksum = FIO_readLE32(entries + u*FIO_SEEKENTRYSIZE + 8);
+                if ((table[n+u].rSize > blockSize) || (table[n+u].cSize > blockSize + FIO_maxBlockHeaderSize))
+                    EXM_THROW(46, "Corrupted seek table : block too large");
             }
-          case bt_raw :
-            cSize = rSize;
-            break;
-          case bt_rle :
-            cSize = 1;
-            break;
-          default :
-            EXM_THROW(37, "unknown block header");   /* should not happen */
-        }
+            n += toRead;
+    }   }
+    if (FIO_seekInput(input, FIO_FRAMEHEADERSIZE, 0)) EXM_THROW(43, "Read error : cannot seek into input");
+    *nbEntriesPtr = nbEntries;
+    return table;
+}
 
-        /* Fill input buffer */
-        {   size_t const toReadSize = cSize + 1;
-            readSize = fread(in_buff, 1, toReadSize, finput);
-            if (readSize != toReadSize)
-                EXM_THROW(38, "Read error");
-            ip = in_buff + cSize;
-        }
+/* FIO_readDecodeBlock() :
+   reads the block at current input position, and decodes it.
+   @return : regenerated block, either `out_buff` or within `in_buff` / mapped input (raw block),
+             NULL at end of frame ; *rSizePtr is its size */
+static const BYTE* FIO_readDecodeBlock(FIO_dCtx_t* dctx, FIO_dInput_t* input, size_t blockSize,
+                                       BYTE* in_buff, BYTE* out_buff, size_t* rSizePtr)
+{
+    size_t rSize, cSize;
+    const BYTE* cBlock;
+    const BYTE* const bHeader = FIO_readInput(input, in_buff, 1);
+    bType_t bType;
+    if (bHeader == NULL) EXM_THROW(34, "Read error : cannot read header\n");
+    bType = FIO_readBlockHeader(input, *bHeader, blockSize, &rSize, &cSize);
+    if (bType == bt_crc) return NULL;   /* end - frame content CRC */
+    cBlock = FIO_readInput(input, in_buff, cSize);
+    if (cBlock == NULL) EXM_THROW(38, "Read error");
+
+    switch(bType)
+    {
+      case bt_compressed :
+        rSize = FIO_decompressBlock(dctx, out_buff, rSize, cBlock, cSize);
+        if (FSE_isError(rSize)) EXM_THROW(39, "Decoding error : %s", FSE_getErrorName(rSize));
+        break;
+      case bt_raw :
+        *rSizePtr = rSize;
+        return cBlock;
+      case bt_rle :
+        memset(out_buff, cBlock[0], rSize);
+        break;
+      case bt_crc :
+      default :
+        EXM_THROW(40, "unknown block header");   /* should not happen */
+    }
+    *rSizePtr = rSize;
+    return out_buff;
+}
 
-        /* Decode block */
-        switch(bType)
-        {
-          case bt_compressed :
-            rSize = decompressor(out_buff, rSize, in_buff, cSize);
-            if (FSE_isError(rSize)) EXM_THROW(39, "Decoding error : %s", FSE_getErrorName(rSize));
-            break;
-          case bt_raw :
-            /* will read directly from in_buff, so no need to memcpy */
-            break;
-          case bt_rle :
-            memset(out_buff, in_buff[0], rSize);
-            break;
-          default :
-            EXM_THROW(40, "unknown block header");   /* should not happen */
-        }
+/* FIO_writeRange() :
+   writes the part of `block`, starting at `blockStart` within frame content, which is within [start, end[.
+   @return : nb of bytes written */
+static size_t FIO_writeRange(FILE* foutput, const BYTE* block, U64 blockStart, size_t blockSize, U64 start, U64 end)
+{
+    U64 const from = MAX(start, blockStart);
+    U64 const to   = MIN(end, blockStart + blockSize);
+    size_t writeSize;
+    if (from >= to) return 0;
+    writeSize = (size_t)(to - from);
+    { size_t const writeSizeCheck = fwrite(block + (from - blockStart), 1, writeSize, foutput);
+      if (writeSizeCheck != writeSize) EXM_THROW(41, "Write error : unable to write data block to destination file"); }
+    return writeSize;
+}
 
-        /* Write block */
-        switch(bType)
-        {
-          case bt_compressed :
-          case bt_rle :
-            { size_t const writeSizeCheck = fwrite(out_buff, 1, rSize, foutput);
-              if (writeSizeCheck != rSize) EXM_THROW(41, "Write error : unable to write data block to destination file"); }
-            XXH32_update(&xxhState, out_buff, rSize);
-            filesize += rSize;
-            break;
-          case bt_raw :
-            { size_t const writeSizeCheck = fwrite(in_buff, 1, cSize, foutput);
-              if (writeSizeCheck != cSize) EXM_THROW(42, "Write error : unable to write data block to destination file"); }
-            XXH32_update(&xxhState, in_buff, cSize);
-            filesize += cSize;
-            break;
-          default :
-            EXM_THROW(41, "unknown block header");   /* should not happen */
-        }
-    }
+/* Range decoding :
+   with a seek table, only blocks overlapping the range are read and decoded, and their checksums are verified.
+   otherwise, blocks are decoded from start of frame up to end of range, without verification */
+unsigned long long FIO_decompressRange(const char* output_filename, const char* input_filename,
+                                       unsigned long long start, unsigned long long size)
+{
+    FILE* finput, *foutput;
+    U32   blockSize;
+    U32   repeat;
+    U32   magicNumber;
+    U64 const end = (size > (U64)-1 - start) ? (U64)-1 : start + size;
+    U64   filesize = 0;
+    FIO_dInput_t input;
+    FIO_map_t inMap = { NULL, 0 };
+    FIO_dCtx_t dctx;
+    FIO_seekEntry_t* table = NULL;
+    size_t nbEntries = 0;
+    BYTE* in_buff;
+    BYTE* out_buff;
 
-    /* CRC verification */
-    { size_t const sizeCheck = fread(ip+1, 1, 2, finput);
-      if (sizeCheck != 2) EXM_THROW(43, "Read error"); }
-    {   U32 const CRCsaved = ip[2] + (ip[1]<<8) + ((ip[0] & _6BITS) << 16);
-        U32 const CRCcalculated = (XXH32_digest(&xxhState) >> 5) & ((1U<<22)-1);
-        if (CRCsaved != CRCcalculated) EXM_THROW(44, "CRC error : wrong checksum, corrupted data");
+    /* Init */
+    get_fileHandle(input_filename, output_filename, &finput, &foutput);
+    if (g_mmapMode) inMap = FIO_mapInput(finput);
+    memset(&input, 0, sizeof(input));
+    input.finput = finput;
+    input.map = (const BYTE*)inMap.start;
+    input.mapSize = inMap.size;
+    magicNumber = FIO_readFrameHeader(&input, &blockSize, &repeat);
+    if (!repeat) table = FIO_readSeekTable(&input, blockSize, &nbEntries);
+    in_buff  = (BYTE*)malloc(blockSize + FIO_maxBlockHeaderSize);
+    out_buff = (BYTE*)malloc(blockSize);
+    if (!in_buff || !out_buff) EXM_THROW(33, "Allocation error : not enough memory");
+    FIO_initDCtx(&dctx, magicNumber);
+
+    if (table) {
+        U64 cPos = FIO_FRAMEHEADERSIZE;
+        U64 rPos = 0;
+        size_t n;
+        for (n=0; (n<nbEntries) && (rPos + table[n].rSize <= start); n++) {   /* skip blocks before range */
+            cPos += table[n].cSize;
+            rPos += table[n].rSize;
+        }
+        DISPLAYLEVEL(4, "Seek table : %u blocks, range starts in block %u \n", (U32)nbEntries, (U32)n);
+        if ((n < nbEntries) && FIO_seekInput(&input, cPos, 0)) EXM_THROW(43, "Read error : cannot seek into input");
+        for ( ; (n<nbEntries) && (rPos < end); n++) {   /* blocks are contiguous : read sequentially */
+            size_t rSize;
+            const BYTE* const block = FIO_readDecodeBlock(&dctx, &input, blockSize, in_buff, out_buff, &rSize);
+            if ( (block == NULL) || (rSize != table[n].rSize)
+              || (XXH32(block, rSize, FSE_CHECKSUM_SEED) != table[n].checksum) )
+                EXM_THROW(44, "CRC error : block %u does not match seek table, corrupted data", (U32)n);
+            filesize += FIO_writeRange(foutput, block, rPos, rSize, start, end);
+            rPos += rSize;
+        }
+    } else {
+        U64 rPos = 0;
+        DISPLAYLEVEL(2, "Warning : no seek table, decoding from start of frame, without checksum \n");
+        while (rPos < end) {
+            size_t rSize;
+            const BYTE* const block = FIO_readDecodeBlock(&dctx, &input, blockSize, in_buff, out_buff, &rSize);
+            if (block == NULL) break;   /* end of frame */
+            filesize += FIO_writeRange(foutput, block, rPos, rSize, start, end);
+            rPos += rSize;
+        }
     }
 
     DISPLAYLEVEL(2, "\r%79s\r", "");
     DISPLAYLEVEL(2, "Decoded %llu bytes\n", (long long unsigned)filesize);
 
     /* clean */
+    FIO_freeDCtx(&dctx);
+    free(table);
     free(in_buff);
     free(out_buff);
+    FIO_unmap(inMap);
     fclose(finput);
     fclose(foutput);
 
     return filesize;
 }
-
-
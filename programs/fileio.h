@@ -48,6 +48,14 @@ static char const stdoutmark[] = "stdout";
 typedef enum { FIO_fse, FIO_huf, FIO_zlibh } FIO_compressor_t;
 void FIO_setCompressor(FIO_compressor_t c);
 void FIO_overwriteMode(void);
+void FIO_setNotificationLevel(unsigned level);   /* 0 : no display; 1: errors; 2 : + result (default); 3 : + progression; 4 : + information */
+void FIO_setRepeatMode(unsigned repeat);   /* 1 : compressed blocks may re-use previous block's table (FSE & HUF only) */
+void FIO_setBlockSize(unsigned blockSize); /* rounded up to a power of 2, from 1 KB to 32 MB (default : 32 KB) */
+void FIO_setBlockSplit(unsigned mode);     /* 0 : fixed block size; 1 : split blocks where statistics change (fast); 2 : same, thorough */
+void FIO_setNbThreads(unsigned nbThreads);    /* >1 : blocks are compressed or decoded in parallel, output is unchanged (requires FSE_original_MULTITHREAD; not with repeat mode) */
+void FIO_setInFlightBlocks(unsigned nbBlocks); /* multi-threaded mode : max nb of blocks in memory; 0 : default (2 per thread) */
+void FIO_setMMapMode(unsigned mmapMode);       /* 1 : memory-map regular files, instead of reading and writing them through buffers (unix only) */
+void FIO_setSeekTable(unsigned seekTable);     /* 1 : append a block index to compressed files, for FIO_decompressRange() (disables repeat mode) */
 
 
 /**************************************
@@ -55,12 +63,19 @@ void FIO_overwriteMode(void);
 **************************************/
 unsigned long long FIO_compressFilename (const char* outfilename, const char* infilename);
 unsigned long long FIO_decompressFilename (const char* outfilename, const char* infilename);
+unsigned long long FIO_decompressRange (const char* outfilename, const char* infilename,
+                                        unsigned long long start, unsigned long long size);
 /*
 FIO_compressFilename :
     result : size of compressed file
 
 FIO_decompressFilename :
     result : size of regenerated file
+
+FIO_decompressRange :
+    regenerates only `size` bytes, starting at offset `start` of original file.
+    only blocks overlapping the range are decoded, provided compressed file has a seek table (see FIO_setSeekTable()).
+    result : nb of bytes regenerated (less than `size` if range goes beyond end of file)
 */
 
 
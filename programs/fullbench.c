@@ -30,6 +30,7 @@
 #include <stdio.h>       /* fprintf, fopen, ftello64 */
 #include <string.h>      /* strcmp */
 #include <time.h>        /* clock_t, clock, CLOCKS_PER_SEC */
+#include <sys/timeb.h>   /* timeb, ftime : wall clock, for multi-threaded benchmarks */
 
 #include "mem.h"
 #define FSE_STATIC_LINKING_ONLY
@@ -37,6 +38,7 @@
 #define HUF_STATIC_LINKING_ONLY
 #include "huf.h"
 #include "xxhash.h"
+#include "threading.h"   /* THREAD_SUPPORT */
 
 
 /*_************************************
@@ -75,6 +77,7 @@
 *  Benchmark Parameters
 ***************************************/
 static U32 no_prompt = 0;
+static U32 g_nbThreadsMax = 4;
 
 
 /*_*******************************************************
@@ -85,6 +88,20 @@ static clock_t BMK_clockSpan( clock_t clockStart )
     return clock() - clockStart;   /* works even if overflow, span limited to <= ~30mn */
 }
 
+static U32 BMK_getMilliStart(void)
+{
+    struct timeb tb;
+    ftime( &tb );
+    return (U32)(tb.millitm + (tb.time & 0xfffff) * 1000);
+}
+
+static U32 BMK_getMilliSpan(U32 milliStart)
+{
+    U32 const nCurrent = BMK_getMilliStart();
+    if (nCurrent < milliStart) return nCurrent + 0x100000 * 1000 - milliStart;
+    return nCurrent - milliStart;
+}
+
 static U32 BMK_rand (U32* seed)
 {
     *seed =  ( (*seed) * PRIME1) + PRIME2;
@@ -678,26 +695,50 @@ static int local_FSE_compress(void* dst, size_t dstSize, const void* src, size_t
     return (int)FSE_compress(dst, dstSize, src, srcSize);
 }
 
+static int local_FSE_compress4X(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return (int)FSE_compress4X(dst, dstSize, src, srcSize, 0, 0);
+}
+
 static int local_HUF_compress(void* dst, size_t dstSize, const void* src, size_t srcSize)
 {
     return (int)HUF_compress(dst, dstSize, src, srcSize);
 }
 
+static U32 g_fseWorkSpace[FSE_WKSP_SIZE_U32(FSE_MAX_TABLELOG, FSE_MAX_SYMBOL_VALUE)];
+static U32 g_hufWorkSpace[HUF_WORKSPACE_SIZE_U32];
+
+static int local_FSE_compress_wksp(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return (int)FSE_compress_wksp(dst, dstSize, src, srcSize, 0, 0, g_fseWorkSpace, sizeof(g_fseWorkSpace));
+}
+
+static int local_HUF_compress4X_wksp(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return (int)HUF_compress4X_wksp(dst, dstSize, src, srcSize, 255, HUF_TABLELOG_DEFAULT, g_hufWorkSpace, sizeof(g_hufWorkSpace));
+}
+
+static int local_HUF_compress8X_wksp(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return (int)HUF_compress8X_wksp(dst, dstSize, src, srcSize, 255, HUF_TABLELOG_DEFAULT, g_hufWorkSpace, sizeof(g_hufWorkSpace));
+}
+
 static U32 fakeTree[256];
 static void* const g_treeVoidPtr = fakeTree;
 static HUF_CElt* g_tree;
+static U32 g_pairTable[HUF_PAIRTABLE_SIZE_U32];
 
 static short  g_normTable[256];
 static U32    g_countTable[256];
 static U32    g_tableLog;
-static U32    g_CTable[2350];
+static U32    g_CTable[FSE_CTABLE_SIZE_U32(FSE_MAX_TABLELOG, FSE_MAX_SYMBOL_VALUE)];
 static U32    g_DTable[FSE_DTABLE_SIZE_U32(12)];
 static U32    g_max;
 static size_t g_skip;
 static size_t g_cSize;
 static size_t g_oSize;
 #define DTABLE_LOG 12
-HUF_CREATE_STATIC_DTABLEX4(g_huff_dtable, DTABLE_LOG);
+HUF_CREATE_STATIC_DTABLEX6(g_huff_dtable, DTABLE_LOG);   /* large enough for all table types */
 
 static void BMK_init(void) { g_tree = (HUF_CElt*) g_treeVoidPtr; }
 
@@ -718,6 +759,17 @@ static int local_HUF_compress4x_usingCTable(void* dst, size_t dstSize, const voi
     return (int)HUF_compress4X_usingCTable(dst, dstSize, src, srcSize, g_tree);
 }
 
+static int local_HUF_buildPairTable(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    (void)dst; (void)dstSize; (void)src; (void)srcSize;
+    return (int)HUF_buildPairTable(g_pairTable, g_tree, g_max);
+}
+
+static int local_HUF_compress4x_usingPairTable(void* dst, size_t dstSize, const void* src, size_t srcSize)
+{
+    return (int)HUF_compress4X_usingPairTable(dst, dstSize, src, srcSize, g_tree, g_pairTable);
+}
+
 static int local_FSE_normalizeCount(void* dst, size_t dstSize, const void* src, size_t srcSize)
 {
     (void)dst; (void)dstSize; (void)src;
@@ -780,6 +832,20 @@ static int local_FSE_buildDTable_raw(void* dst, size_t dstSize, const void* src,
     return (int)FSE_buildDTable_raw(g_DTable, 6);
 }
 
+/* fill g_normTable for `tableLog`.
+ * noLowProba : turn low proba (-1) symbols into regular 1-cell ones, so that table builders use their fast spreading path */
+static void BMK_prepareNormTable(const void* src, size_t srcSize, U32 tableLog, int noLowProba)
+{
+    g_max=255;
+    FSE_count(g_countTable, &g_max, (const unsigned char*)src, srcSize);
+    g_tableLog = FSE_optimalTableLog(tableLog, srcSize, g_max);
+    FSE_normalizeCount(g_normTable, g_tableLog, g_countTable, srcSize, g_max);
+    if (noLowProba) {
+        U32 s;
+        for (s=0; s<=g_max; s++) if (g_normTable[s]==-1) g_normTable[s]=1;   /* same nb of cells */
+    }
+}
+
 static int local_FSE_decompress_usingDTable(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
 {
     (void)srcSize;
@@ -792,6 +858,18 @@ static int local_FSE_decompress(void* dst, size_t maxDstSize, const void* src, s
     return (int)FSE_decompress(dst, maxDstSize, src, g_cSize);
 }
 
+static int local_FSE_decompress4X_usingDTable(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)srcSize; (void)maxDstSize;
+    return (int)FSE_decompress4X_usingDTable(dst, g_oSize, (const BYTE*)src + g_skip, g_cSize, g_DTable);
+}
+
+static int local_FSE_decompress4X(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)srcSize; (void)maxDstSize;
+    return (int)FSE_decompress4X(dst, g_oSize, src, g_cSize);
+}
+
 
 static int local_HUF_decompress(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
 {
@@ -811,6 +889,12 @@ static int local_HUF_decompress4X4(void* dst, size_t maxDstSize, const void* src
     return (int)HUF_decompress4X4(dst, g_oSize, src, g_cSize);
 }
 
+static int local_HUF_decompress4X6(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)srcSize; (void)maxDstSize;
+    return (int)HUF_decompress4X6(dst, g_oSize, src, g_cSize);
+}
+
 static int local_HUF_decompress1X2(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
 {
     (void)srcSize; (void)maxDstSize;
@@ -829,6 +913,12 @@ static int local_HUF_readDTableX4(void* dst, size_t maxDstSize, const void* src,
     return (int)HUF_readDTableX4(g_huff_dtable, src, g_cSize);
 }
 
+static int local_HUF_readDTableX6(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)dst; (void)maxDstSize; (void)srcSize;
+    return (int)HUF_readDTableX6(g_huff_dtable, src, g_cSize);
+}
+
 static int local_HUF_readDTable(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
 {
     return local_HUF_readDTableX4(dst, maxDstSize, src, srcSize);
@@ -850,6 +940,12 @@ static int local_HUF_decompress_usingDTable(void* dst, size_t maxDstSize, const
     return local_HUF_decompress4X4_usingDTable(dst, maxDstSize, src, srcSize);
 }
 
+static int local_HUF_decompress4X6_usingDTable(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)srcSize; (void)maxDstSize;
+    return (int)HUF_decompress4X6_usingDTable(dst, g_oSize, src, g_cSize, g_huff_dtable);
+}
+
 static int local_HUF_decompress4X2_usingDTable(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
 {
     (void)srcSize; (void)maxDstSize;
@@ -868,6 +964,68 @@ static int local_HUF_decompress1X4_usingDTable(void* dst, size_t maxDstSize, con
     return (int)HUF_decompress1X4_usingDTable(dst, g_oSize, src, g_cSize, g_huff_dtable);
 }
 
+static int local_FSE_decompress_usingDTable_withPadding(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)srcSize; (void)maxDstSize;
+    return (int)FSE_decompress_usingDTable_withPadding(dst, g_oSize, (const BYTE*)src + g_skip, g_cSize, g_DTable);
+}
+
+static int local_FSE_decompress4X_usingDTable_withPadding(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)srcSize; (void)maxDstSize;
+    return (int)FSE_decompress4X_usingDTable_withPadding(dst, g_oSize, (const BYTE*)src + g_skip, g_cSize, g_DTable);
+}
+
+static int local_HUF_decompress4X_usingDTable_withPadding(void* dst, size_t maxDstSize, const void* src, size_t srcSize)
+{
+    (void)srcSize; (void)maxDstSize;
+    return (int)HUF_decompress4X_usingDTable_withPadding(dst, g_oSize, src, g_cSize, g_huff_dtable);
+}
+
+
+/* FSE_count_mt() scaling : measured using wall clock, since clock() adds up time spent in all threads */
+static int BMK_benchCountMT(const void* src, size_t srcSize, U32 nbBenchs)
+{
+    U32 refCount[256];
+    U32 refMax = 255;
+    size_t const refResult = FSE_count(refCount, &refMax, src, srcSize);
+    double baseSpeed = 0.;
+    U32 nbThreads = 1;
+
+    if (!THREAD_SUPPORT) DISPLAY("note : multi-threading not enabled (FSE_original_MULTITHREAD) \n");
+    while (nbThreads <= g_nbThreadsMax) {
+        double bestTime = 999.;
+        U32 benchNb;
+        for (benchNb=1; benchNb <= nbBenchs; benchNb++) {
+            U32 count[256];
+            U32 max = 255;
+            size_t result = 0;
+            U32 loopNb;
+            U32 milliStart = BMK_getMilliStart();
+            while (BMK_getMilliStart() == milliStart);
+            milliStart = BMK_getMilliStart();
+            for (loopNb=0; BMK_getMilliSpan(milliStart) < TIMELOOP_S * 1000; loopNb++) {
+                max = 255;
+                result = FSE_count_mt(count, &max, src, srcSize, nbThreads);
+            }
+            if ((result != refResult) || (max != refMax) || memcmp(count, refCount, (max+1) * sizeof(*count))) {
+                DISPLAY("Error : FSE_count_mt(%u threads) result differs from FSE_count() \n", nbThreads);
+                return 1;
+            }
+            {   double const averageTime = (double)BMK_getMilliSpan(milliStart) / 1000. / loopNb;
+                if (averageTime < bestTime) bestTime = averageTime;
+            }
+            DISPLAY("%2u-FSE_count_mt(%2u threads)%-10s : %8.1f MB/s \r", benchNb+1, nbThreads, "", (double)srcSize / (1 MB) / bestTime);
+        }
+        {   double const speed = (double)srcSize / (1 MB) / bestTime;
+            if (nbThreads==1) baseSpeed = speed;
+            DISPLAY("%2u-FSE_count_mt(%2u threads)%-10s : %8.1f MB/s  (x%.2f) \n", 10, nbThreads, "", speed, speed / baseSpeed);
+        }
+        if ((nbThreads < g_nbThreadsMax) && (nbThreads*2 > g_nbThreadsMax)) nbThreads = g_nbThreadsMax;   /* always measure max */
+        else nbThreads *= 2;
+    }
+    return 0;
+}
 
 
 int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
@@ -959,6 +1117,14 @@ int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
         func = local_FSE_compress;
         break;
 
+    case 10:
+        {
+            int const result = BMK_benchCountMT(oBuffer, benchedSize, nbBenchs);   /* reports its own results */
+            free(oBuffer);
+            free(cBuffer);
+            return result;
+        }
+
     case 11:
         {
             FSE_compress(cBuffer, cBuffSize, oBuffer, benchedSize);
@@ -1000,6 +1166,40 @@ int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
             break;
         }
 
+    case 15:
+        funcName = "FSE_compress4X";
+        func = local_FSE_compress4X;
+        break;
+
+    case 16:
+        {
+            g_oSize = benchedSize;
+            g_cSize = FSE_compress4X(cBuffer, cBuffSize, oBuffer, benchedSize, 0, 0);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            g_max = 255;
+            g_skip = FSE_readNCount(g_normTable, &g_max, &g_tableLog, oBuffer, g_cSize);
+            g_cSize -= g_skip;
+            FSE_buildDTable (g_DTable, g_normTable, g_max, g_tableLog);
+            funcName = "FSE_decompress4X_usingDTable";
+            func = local_FSE_decompress4X_usingDTable;
+            break;
+        }
+
+    case 17:
+        {
+            g_oSize = benchedSize;
+            g_cSize = FSE_compress4X(cBuffer, cBuffSize, oBuffer, benchedSize, 0, 0);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            funcName = "FSE_decompress4X";
+            func = local_FSE_decompress4X;
+            break;
+        }
+
+    case 18:
+        funcName = "FSE_compress_wksp";
+        func = local_FSE_compress_wksp;
+        break;
+
     case 20:
         funcName = "HUF_compress";
         func = local_HUF_compress;
@@ -1034,6 +1234,37 @@ int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
             break;
         }
 
+    case 24:
+        funcName = "HUF_compress4X_wksp";
+        func = local_HUF_compress4X_wksp;
+        break;
+
+    case 25:
+        funcName = "HUF_compress8X_wksp";
+        func = local_HUF_compress8X_wksp;
+        break;
+
+    case 26:
+        {
+            g_max=255;
+            FSE_count(g_countTable, &g_max, (const unsigned char*)oBuffer, benchedSize);
+            g_tableLog = (U32)HUF_buildCTable(g_tree, g_countTable, g_max, 0);
+            funcName = "HUF_buildPairTable";
+            func = local_HUF_buildPairTable;
+            break;
+        }
+
+    case 27:
+        {
+            g_max=255;
+            FSE_count(g_countTable, &g_max, (const unsigned char*)oBuffer, benchedSize);
+            g_tableLog = (U32)HUF_buildCTable(g_tree, g_countTable, g_max, 0);
+            HUF_buildPairTable(g_pairTable, g_tree, g_max);
+            funcName = "HUF_compress4x_usingPairTable";
+            func = local_HUF_compress4x_usingPairTable;
+            break;
+        }
+
     case 30:
         {
             g_oSize = benchedSize;
@@ -1132,6 +1363,29 @@ int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
         }
 
 
+    case 45:
+        {
+            g_oSize = benchedSize;
+            g_cSize = HUF_compress8X(cBuffer, cBuffSize, oBuffer, benchedSize, 255, HUF_TABLELOG_DEFAULT);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            funcName = "HUF_decompress8X2";
+            func = local_HUF_decompress4X2;
+            break;
+        }
+
+    case 46:
+        {
+            size_t hSize;
+            g_oSize = benchedSize;
+            g_cSize = HUF_compress8X(cBuffer, cBuffSize, oBuffer, benchedSize, 255, HUF_TABLELOG_DEFAULT);
+            hSize = HUF_readDTableX2(g_huff_dtable, cBuffer, g_cSize);
+            g_cSize -= hSize;
+            memcpy(oBuffer, ((char*)cBuffer)+hSize, g_cSize);
+            funcName = "HUF_decompress8X2_usingDTable";
+            func = local_HUF_decompress4X2_usingDTable;
+            break;
+        }
+
     case 50:
         {
             g_oSize = benchedSize;
@@ -1196,6 +1450,114 @@ int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
             break;
         }
 
+    /* padded destination : cBuffer is always larger than g_oSize + padding */
+    case 55:
+        {
+            g_oSize = benchedSize;
+            g_cSize = HUF_compress8X(cBuffer, cBuffSize, oBuffer, benchedSize, 255, HUF_TABLELOG_DEFAULT);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            funcName = "HUF_decompress8X4";
+            func = local_HUF_decompress4X4;
+            break;
+        }
+
+    case 56:
+        {
+            size_t hSize;
+            g_oSize = benchedSize;
+            g_cSize = HUF_compress8X(cBuffer, cBuffSize, oBuffer, benchedSize, 255, HUF_TABLELOG_DEFAULT);
+            hSize = HUF_readDTableX4(g_huff_dtable, cBuffer, g_cSize);
+            g_cSize -= hSize;
+            memcpy(oBuffer, ((char*)cBuffer)+hSize, g_cSize);
+            funcName = "HUF_decompress8X4_usingDTable";
+            func = local_HUF_decompress4X4_usingDTable;
+            break;
+        }
+
+    case 57:
+        {
+            g_oSize = benchedSize;
+            g_cSize = HUF_compress(cBuffer, cBuffSize, oBuffer, benchedSize);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            funcName = "HUF_decompress4X6";
+            func = local_HUF_decompress4X6;
+            break;
+        }
+
+    case 58:
+        {
+            g_cSize = HUF_compress(cBuffer, cBuffSize, oBuffer, benchedSize);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            funcName = "HUF_readDTableX6";
+            func = local_HUF_readDTableX6;
+            break;
+        }
+
+    case 59:
+        {
+            size_t hSize;
+            g_oSize = benchedSize;
+            g_cSize = HUF_compress(cBuffer, cBuffSize, oBuffer, benchedSize);
+            hSize = HUF_readDTableX6(g_huff_dtable, cBuffer, g_cSize);
+            g_cSize -= hSize;
+            memcpy(oBuffer, ((char*)cBuffer)+hSize, g_cSize);
+            funcName = "HUF_decompress4X6_usingDTable";
+            func = local_HUF_decompress4X6_usingDTable;
+            break;
+        }
+
+    case 60:
+    case 61:
+        {
+            g_oSize = benchedSize;
+            g_cSize = (algNb==60) ? FSE_compress(cBuffer, cBuffSize, oBuffer, benchedSize)
+                                  : FSE_compress4X(cBuffer, cBuffSize, oBuffer, benchedSize, 0, 0);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            g_max = 255;
+            g_skip = FSE_readNCount(g_normTable, &g_max, &g_tableLog, oBuffer, g_cSize);
+            g_cSize -= g_skip;
+            FSE_buildDTable (g_DTable, g_normTable, g_max, g_tableLog);
+            funcName = (algNb==60) ? "FSE_decompress_usingDTable_withPadding" : "FSE_decompress4X_usingDTable_withPadding";
+            func = (algNb==60) ? local_FSE_decompress_usingDTable_withPadding : local_FSE_decompress4X_usingDTable_withPadding;
+            break;
+        }
+
+    case 62:
+    case 63:
+    case 64:
+        {
+            size_t hSize;
+            g_oSize = benchedSize;
+            g_cSize = HUF_compress(cBuffer, cBuffSize, oBuffer, benchedSize);
+            hSize = (algNb==62) ? HUF_readDTableX2(g_huff_dtable, cBuffer, g_cSize) :
+                    (algNb==63) ? HUF_readDTableX4(g_huff_dtable, cBuffer, g_cSize) :
+                                  HUF_readDTableX6(g_huff_dtable, cBuffer, g_cSize);
+            g_cSize -= hSize;
+            memcpy(oBuffer, ((char*)cBuffer)+hSize, g_cSize);
+            funcName = (algNb==62) ? "HUF_decompress4X2_withPadding" :
+                       (algNb==63) ? "HUF_decompress4X4_withPadding" : "HUF_decompress4X6_withPadding";
+            func = local_HUF_decompress4X_usingDTable_withPadding;
+            break;
+        }
+
+    /* X4 table construction, from headers of various depths */
+    case 65:
+    case 66:
+    case 67:
+        {
+            static const U32 maxNbBits[] = { 9, 11, 12 };
+            static char name[40];
+            g_max = 255;
+            FSE_count(g_countTable, &g_max, (const unsigned char*)oBuffer, benchedSize);
+            g_tableLog = (U32)HUF_buildCTable(g_tree, g_countTable, g_max, maxNbBits[algNb-65]);
+            g_cSize = HUF_writeCTable(cBuffer, cBuffSize, g_tree, g_max, g_tableLog);
+            memcpy(oBuffer, cBuffer, g_cSize);
+            sprintf(name, "HUF_readDTableX4(%u)", g_tableLog);
+            funcName = name;
+            func = local_HUF_readDTableX4;
+            break;
+        }
+
     case 70:
         {
             funcName = "FSE_buildCTable_raw(6)";
@@ -1203,6 +1565,23 @@ int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
             break;
         }
 
+    case 71:
+    case 72:
+    case 73:
+    case 74:
+    case 75:
+    case 76:
+        {
+            static const U32 tableLogs[] = { 9, 11, 12 };
+            static char name[40];
+            U32 const noLowProba = (algNb >= 74);
+            BMK_prepareNormTable(oBuffer, benchedSize, tableLogs[(algNb-71) % 3], noLowProba);
+            sprintf(name, "FSE_buildCTable(%u%s)", g_tableLog, noLowProba ? ",noLowProba" : "");
+            funcName = name;
+            func = local_FSE_buildCTable;
+            break;
+        }
+
     case 80:
         {
             g_max=255;
@@ -1232,6 +1611,21 @@ int runBench(const void* buffer, size_t blockSize, U32 algNb, U32 nbBenchs)
             break;
         }
 
+    case 83:
+    case 84:
+    case 85:
+    case 86:
+        {
+            static const U32 tableLogs[] = { 12, 9, 11, 12 };
+            static char name[40];
+            U32 const noLowProba = (algNb >= 84);
+            BMK_prepareNormTable(oBuffer, benchedSize, tableLogs[algNb-83], noLowProba);
+            sprintf(name, "FSE_buildDTable(%u%s)", g_tableLog, noLowProba ? ",noLowProba" : "");
+            funcName = name;
+            func = local_FSE_buildDTable;
+            break;
+        }
+
     case 132:  // unimplemented yet
         {
             size_t hhsize;
@@ -1396,6 +1790,7 @@ static int usage_advanced(const char* exename)
     DISPLAY( " -i#    : iteration loops [1-9] (default : %i)\n", NBLOOPS);
     DISPLAY( " -B#    : block size, in bytes (default : %i)\n", DEFAULT_BLOCKSIZE);
     DISPLAY( " -P#    : probability curve, in %% (default : %i%%)\n", DEFAULT_PROBA);
+    DISPLAY( " -T#    : max nb of threads for FSE_count_mt() scaling, test 10 (default : %u)\n", g_nbThreadsMax);
     return 0;
 }
 
@@ -1476,6 +1871,14 @@ int main(int argc, const char** argv)
                     if (argument[0]=='B') argument++;
                     break;
 
+                    // Modify max nb of threads
+                case 'T':
+                    argument++;
+                    g_nbThreadsMax=0;
+                    while ((*argument >='0') && (*argument <='9')) g_nbThreadsMax*=10, g_nbThreadsMax += *argument++ - '0';
+                    if (g_nbThreadsMax==0) g_nbThreadsMax=1;
+                    break;
+
                     // Pause at the end (hidden option)
                 case 'p':
                     pause=1;
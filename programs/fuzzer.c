@@ -145,6 +145,25 @@ static int FUZ_checkCount (short* normalizedCount, int tableLog, int maxSV)
 }
 
 
+/* decodes a block produced by FSE_compress() or FSE_compress4X(), using *_withPadding() variants.
+ * `dst` must be writable up to `dstSize + FSE_DECODE_PADDING` */
+static size_t FUZ_decompressWithPadding (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize, unsigned fourStreams)
+{
+    short norm[FSE_MAX_SYMBOL_VALUE+1];
+    unsigned maxSV = FSE_MAX_SYMBOL_VALUE, tableLog;
+    FSE_DTable dt[FSE_DTABLE_SIZE_U32(FSE_MAX_TABLELOG)];
+    size_t const hSize = FSE_readNCount (norm, &maxSV, &tableLog, cSrc, cSrcSize);
+    if (FSE_isError(hSize)) return hSize;
+    {   size_t const errorCode = FSE_buildDTable (dt, norm, maxSV, tableLog);
+        if (FSE_isError(errorCode)) return errorCode; }
+    {   const BYTE* const ip = (const BYTE*)cSrc + hSize;
+        size_t const ipSize = cSrcSize - hSize;   /* readNCount never reads beyond cSrcSize */
+        if (fourStreams) return FSE_decompress4X_usingDTable_withPadding (dst, dstSize, ip, ipSize, dt);
+        return FSE_decompress_usingDTable_withPadding (dst, dstSize, ip, ipSize, dt);
+    }
+}
+
+
 #define CHECK(cond, ...) if (cond) { DISPLAY("Error => "); DISPLAY(__VA_ARGS__); \
                          DISPLAY(" (seed %u, test nb %u)  \n", seed, testNb); exit(-1); }
 
@@ -157,12 +176,15 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
     BYTE* bufferP100  = (BYTE*) malloc (BUFFERSIZE+64);
     BYTE* bufferDst   = (BYTE*) malloc (BUFFERSIZE+64);
     BYTE* bufferVerif = (BYTE*) malloc (BUFFERSIZE+64);
+    FSE_CCtx* const cctx = FSE_createCCtx();
     size_t bufferDstSize = BUFFERSIZE+64;
-    unsigned testNb, maxSV, tableLog;
+    unsigned testNb = startTestNb, maxSV, tableLog;
     const size_t maxTestSizeMask = 0x1FFFF;
     U32 rootSeed = seed;
     U32 time = FUZ_GetMilliStart();
 
+    CHECK(cctx==NULL, "Not enough memory for FSE_CCtx");
+
     generateNoise (bufferP0, BUFFERSIZE, &rootSeed);
     generate (bufferP1  , BUFFERSIZE, 0.01, &rootSeed);
     generate (bufferP15 , BUFFERSIZE, 0.15, &rootSeed);
@@ -216,6 +238,13 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
             sizeCompressed = FSE_compress (bufferDst, bufferDstSize, bufferTest, sizeOrig);
             CHECK(FSE_isError(sizeCompressed), "Compression failed !");
 
+            /* context compression must generate same data */
+            {
+                size_t const cctxSize = FSE_compressCCtx (cctx, bufferVerif, bufferDstSize, bufferTest, sizeOrig, FSE_MAX_SYMBOL_VALUE, FSE_DEFAULT_TABLELOG);
+                CHECK(cctxSize != sizeCompressed, "FSE_compressCCtx : wrong compressed size");
+                CHECK((sizeCompressed > 1) && memcmp(bufferVerif, bufferDst, sizeCompressed), "FSE_compressCCtx : different compressed data");   /* rle : nothing written */
+            }
+
             if (sizeCompressed > 1)   /* don't check uncompressed & rle corner cases */
             {
                 /* failed compression test*/
@@ -238,6 +267,38 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
                     hashEnd = XXH32 (bufferVerif, sizeOrig, 0);
                     CHECK(hashEnd != hashOrig, "Decompressed data corrupted");
                 }
+
+                /* padded decompression test */
+                {
+                    U32 hashEnd;
+                    BYTE saved = (bufferVerif[sizeOrig + FSE_DECODE_PADDING] = 251);
+                    size_t result = FUZ_decompressWithPadding (bufferVerif, sizeOrig, bufferDst, sizeCompressed, 0);
+                    CHECK(bufferVerif[sizeOrig + FSE_DECODE_PADDING] != saved, "Output buffer overrun (bufferVerif) : write beyond padding");
+                    CHECK(result != sizeOrig, "Padded decompression failed");
+                    hashEnd = XXH32 (bufferVerif, sizeOrig, 0);
+                    CHECK(hashEnd != hashOrig, "Padded decompressed data corrupted");
+                }
+            }
+
+            /* 4-streams round trip */
+            sizeCompressed = FSE_compress4X (bufferDst, bufferDstSize, bufferTest, sizeOrig, 0, 0);
+            CHECK(FSE_isError(sizeCompressed), "4-streams compression failed !");
+            if (sizeCompressed > 1)
+            {
+                U32 hashEnd;
+                BYTE saved = (bufferVerif[sizeOrig] = 252);
+                size_t result = FSE_decompress4X (bufferVerif, sizeOrig, bufferDst, sizeCompressed);
+                CHECK(bufferVerif[sizeOrig] != saved, "Output buffer overrun (bufferVerif) : 4-streams write beyond specified end");
+                CHECK(FSE_isError(result), "4-streams decompression failed");
+                hashEnd = XXH32 (bufferVerif, sizeOrig, 0);
+                CHECK(hashEnd != hashOrig, "4-streams decompressed data corrupted");
+
+                saved = (bufferVerif[sizeOrig + FSE_DECODE_PADDING] = 250);
+                result = FUZ_decompressWithPadding (bufferVerif, sizeOrig, bufferDst, sizeCompressed, 1);
+                CHECK(bufferVerif[sizeOrig + FSE_DECODE_PADDING] != saved, "Output buffer overrun (bufferVerif) : 4-streams write beyond padding");
+                CHECK(result != sizeOrig, "4-streams padded decompression failed");
+                hashEnd = XXH32 (bufferVerif, sizeOrig, 0);
+                CHECK(hashEnd != hashOrig, "4-streams padded decompressed data corrupted");
             }
         }
 
@@ -268,6 +329,16 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
             result = FSE_decompress (bufferDst, maxDstSize, bufferTest, sizeCompressed);
             CHECK(!FSE_isError(result) && (result > maxDstSize), "Decompression overran output buffer");
             CHECK(bufferDst[maxDstSize] != saved, "FSE_decompress on bogus data : bufferDst write overflow");
+            result = FSE_decompress4X (bufferDst, maxDstSize, bufferTest, sizeCompressed);
+            CHECK(!FSE_isError(result) && (result != maxDstSize), "4-streams decompression : wrong regenerated size");
+            CHECK(bufferDst[maxDstSize] != saved, "FSE_decompress4X on bogus data : bufferDst write overflow");
+            saved = (bufferDst[maxDstSize + FSE_DECODE_PADDING] = 249);
+            result = FUZ_decompressWithPadding (bufferDst, maxDstSize, bufferTest, sizeCompressed, 0);
+            CHECK(!FSE_isError(result) && (result > maxDstSize), "Padded decompression overran output buffer");
+            CHECK(bufferDst[maxDstSize + FSE_DECODE_PADDING] != saved, "Padded decompression on bogus data : write beyond padding");
+            result = FUZ_decompressWithPadding (bufferDst, maxDstSize, bufferTest, sizeCompressed, 1);
+            CHECK(!FSE_isError(result) && (result != maxDstSize), "4-streams padded decompression : wrong regenerated size");
+            CHECK(bufferDst[maxDstSize + FSE_DECODE_PADDING] != saved, "4-streams padded decompression on bogus data : write beyond padding");
         }
     }
 
@@ -279,6 +350,7 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
     free (bufferP100);
     free (bufferDst);
     free (bufferVerif);
+    FSE_freeCCtx(cctx);
 }
 
 
@@ -321,6 +393,47 @@ static void unitTest(void)
         CHECK(FSE_isError(errorCode), "Error : FSE_count() should have worked");
     }
 
+    /* FSE_count & FSE_countFast : compare with reference */
+    {
+        U32 n, i;
+        for (n=0; n<200; n++) {
+            U32 refCount[256] = { 0 };
+            U32 refMax = 0, refMaxSV = 0, max, s;
+            size_t const testSize = FUZ_rand(&lseed) % (TBSIZE-32);
+            size_t const offset = FUZ_rand(&lseed) & 31;   /* unaligned input */
+            BYTE const mask = (BYTE)((FUZ_rand(&lseed) & 1) ? 255 : 31);
+            for (i=0; i<testSize; i++) { testBuff[offset+i] = (BYTE)(FUZ_rand(&lseed) & mask); refCount[testBuff[offset+i]]++; }
+            for (s=0; s<256; s++) { if (refCount[s]) refMaxSV = s; if (refCount[s] > refMax) refMax = refCount[s]; }
+
+            max = 255;
+            errorCode = (n & 1) ? FSE_countFast(count, &max, testBuff+offset, testSize) : FSE_count(count, &max, testBuff+offset, testSize);
+            CHECK(FSE_isError(errorCode), "Error : FSE_count() should have worked");
+            CHECK(errorCode != refMax, "Error : FSE_count() : wrong max count");
+            CHECK(max != refMaxSV, "Error : FSE_count() : wrong maxSymbolValue");
+            for (s=0; s<=max; s++) CHECK(count[s] != refCount[s], "Error : FSE_count() : wrong count for symbol %u", s);
+    }   }
+
+    /* FSE_count_mt : must be identical to FSE_count */
+    {
+        size_t const largeSize = (2 MB) + 7;
+        BYTE* const largeBuff = (BYTE*)malloc(largeSize);
+        U32 nbThreads, i;
+        CHECK(largeBuff==NULL, "Not enough memory for FSE_count_mt test");
+        for (i=0; i<largeSize; i++) largeBuff[i] = (BYTE)((FUZ_rand(&lseed) & 127) + ((i>>20) & 1));
+        for (nbThreads=1; nbThreads<=5; nbThreads++) {
+            U32 refCount[256], refMax = 255, max = 255;
+            size_t const refResult = FSE_count(refCount, &refMax, largeBuff, largeSize);
+            errorCode = FSE_count_mt(count, &max, largeBuff, largeSize, nbThreads);
+            CHECK(errorCode != refResult, "Error : FSE_count_mt() : wrong max count");
+            CHECK(max != refMax, "Error : FSE_count_mt() : wrong maxSymbolValue");
+            CHECK(memcmp(count, refCount, (max+1) * sizeof(*count)), "Error : FSE_count_mt() : wrong counts");
+            max = 100;
+            errorCode = FSE_count_mt(count, &max, largeBuff, largeSize, nbThreads);
+            CHECK(!FSE_isError(errorCode), "Error : FSE_count_mt() should have failed : value > max");
+        }
+        free(largeBuff);
+    }
+
     /* FSE_optimalTableLog */
     {
         U32 max, i, tableLog=12;
@@ -446,6 +559,159 @@ static void unitTest(void)
         CHECK(crcOrig != crcVerif, "Raw regenerated data is corrupted");
     }
 
+    /* FSE_compress_wksp */
+    {
+        U32 wksp[FSE_WKSP_SIZE_U32(FSE_MAX_TABLELOG, 255)];
+        size_t refSize, cSize;
+        U32 i;
+        for (i=0; i< TBSIZE; i++) testBuff[i] = (BYTE)(FUZ_rand(&lseed) & 127);
+        refSize = FSE_compress2(verifBuff, TBSIZE, testBuff, TBSIZE, 255, 5);
+        CHECK(FSE_isError(refSize), "FSE_compress2 should have worked");
+
+        /* tableLog 5 is too small for 128 symbols : it gets increased, so does table size */
+        cSize = FSE_compress_wksp(cBuff, FSE_COMPRESSBOUND(TBSIZE), testBuff, TBSIZE, 255, 5, wksp, sizeof(wksp));
+        CHECK(cSize != refSize, "FSE_compress_wksp : wrong compressed size");
+        CHECK(memcmp(cBuff, verifBuff, cSize), "FSE_compress_wksp : different compressed data");
+
+        cSize = FSE_compress_wksp(cBuff, FSE_COMPRESSBOUND(TBSIZE), testBuff, TBSIZE, 255, 5, wksp, FSE_COUNT_WKSP_SIZE_U32 * sizeof(U32));
+        CHECK(!FSE_isError(cSize), "FSE_compress_wksp should have failed (workspace too small)");
+    }
+
+    /* FSE_compress4X : large blocks, with streams larger than 64 KB */
+    {
+        size_t const largeSize = 1 MB + 3;
+        BYTE* const largeBuff = (BYTE*)malloc(largeSize);
+        BYTE* const largeCBuff = (BYTE*)malloc(FSE_COMPRESSBOUND(largeSize));
+        BYTE* const largeVerif = (BYTE*)malloc(largeSize);
+        size_t cSize, rSize;
+        CHECK(!largeBuff || !largeCBuff || !largeVerif, "not enough memory !");
+        generate(largeBuff, largeSize, 0.05, &lseed);
+        cSize = FSE_compress4X(largeCBuff, FSE_COMPRESSBOUND(largeSize), largeBuff, largeSize, 0, 0);
+        CHECK(FSE_isError(cSize) || (cSize<=1), "FSE_compress4X() of large block should have worked");
+        rSize = FSE_decompress4X(largeVerif, largeSize, largeCBuff, cSize);
+        CHECK(rSize != largeSize, "FSE_decompress4X() of large block failed : %s", FSE_getErrorName(rSize));
+        CHECK(memcmp(largeBuff, largeVerif, largeSize), "FSE_compress4X large block : regenerated data is corrupted");
+        free(largeBuff);
+        free(largeCBuff);
+        free(largeVerif);
+    }
+
+    /* FSE table repeat mode */
+    {
+        FSE_CCtx* const cctx = FSE_createCCtx();
+        FSE_DCtx* const dctx = FSE_createDCtx();
+#       define REPEAT_BLOCKSIZE (TBSIZE/8)
+        size_t cSizes[TBSIZE/REPEAT_BLOCKSIZE];
+        size_t cPos = 0;
+        U32 nbRepeats = 0, b;
+        CHECK((cctx==NULL) || (dctx==NULL), "Not enough memory for FSE contexts");
+        for (b=0; b < TBSIZE; b++) testBuff[b] = (BYTE)((FUZ_rand(&lseed) & 7) + (FUZ_rand(&lseed) & 7));   /* same small alphabet in all blocks */
+        for (b=0; b < TBSIZE/REPEAT_BLOCKSIZE; b++) {
+            BYTE* const cBlock = cBuff + cPos;
+            cSizes[b] = FSE_compressCCtx_repeat(cctx, cBlock, FSE_COMPRESSBOUND(TBSIZE) - cPos, testBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, 255, 10);
+            CHECK(FSE_isError(cSizes[b]) || (cSizes[b] <= 1), "FSE_compressCCtx_repeat should have compressed block %u", b);
+            nbRepeats += (cBlock[0] == FSE_REPEAT_HEADER);
+            cPos += cSizes[b];
+        }
+        CHECK(nbRepeats == 0, "FSE_compressCCtx_repeat : similar blocks should re-use previous table");
+        CHECK(cBuff[0] == FSE_REPEAT_HEADER, "FSE_compressCCtx_repeat : first block can't re-use a table");
+        for (cPos=0, b=0; b < TBSIZE/REPEAT_BLOCKSIZE; cPos += cSizes[b], b++) {
+            size_t const rSize = FSE_decompressDCtx(dctx, verifBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, cBuff + cPos, cSizes[b]);
+            CHECK(rSize != REPEAT_BLOCKSIZE, "FSE_decompressDCtx failed decoding block %u", b);
+        }
+        CHECK(memcmp(testBuff, verifBuff, TBSIZE), "FSE table repeat mode : regenerated data is corrupted");
+        for (cPos=cSizes[0], b=1; b < TBSIZE/REPEAT_BLOCKSIZE; cPos += cSizes[b], b++) {
+            if (cBuff[cPos] != FSE_REPEAT_HEADER) continue;
+            errorCode = FSE_decompress(verifBuff, REPEAT_BLOCKSIZE, cBuff + cPos, cSizes[b]);
+            CHECK(!FSE_isError(errorCode), "FSE_decompress should have failed (block re-uses previous table)");
+            FSE_resetDCtx(dctx);
+            errorCode = FSE_decompressDCtx(dctx, verifBuff, REPEAT_BLOCKSIZE, cBuff + cPos, cSizes[b]);
+            CHECK(!FSE_isError(errorCode), "FSE_decompressDCtx should have failed (no previous table)");
+            break;
+        }
+        FSE_freeCCtx(cctx);
+        FSE_freeDCtx(dctx);
+    }
+
+    /* FSE decoding table cache */
+    {
+        size_t const blockSize = TBSIZE/2;
+        BYTE* const cBlock2 = cBuff + FSE_COMPRESSBOUND(blockSize);
+        size_t cSize1, cSize2;
+        U32 nbTables;
+        generate(testBuff, blockSize, 0.2, &lseed);
+        generate(testBuff + blockSize, blockSize, 0.6, &lseed);
+        cSize1 = FSE_compress(cBuff, FSE_COMPRESSBOUND(blockSize), testBuff, blockSize);
+        cSize2 = FSE_compress(cBlock2, FSE_COMPRESSBOUND(blockSize), testBuff + blockSize, blockSize);
+        CHECK(FSE_isError(cSize1) || FSE_isError(cSize2) || (cSize1<=1) || (cSize2<=1), "FSE_compress() should have compressed both blocks");
+        for (nbTables=1; nbTables<=2; nbTables++) {
+            FSE_DCtx* const dctx = FSE_createDCtx_advanced(nbTables);
+            unsigned long long hits, misses;
+            U32 b;
+            CHECK(dctx==NULL, "Not enough memory for FSE_DCtx");
+            for (b=0; b<5; b++) {   /* alternate both headers */
+                size_t const rSize = (b&1) ? FSE_decompressDCtx(dctx, verifBuff + blockSize, blockSize, cBlock2, cSize2)
+                                           : FSE_decompressDCtx(dctx, verifBuff, blockSize, cBuff, cSize1);
+                CHECK(rSize != blockSize, "FSE_decompressDCtx() failed decoding block %u", b);
+            }
+            CHECK(memcmp(testBuff, verifBuff, TBSIZE), "FSE decoding table cache : regenerated data is corrupted");
+            FSE_getDCtxCacheStats(dctx, &hits, &misses);
+            CHECK((nbTables==1) && ((hits!=0) || (misses!=5)), "FSE decoding table cache : wrong stats (%u hits, %u misses)", (U32)hits, (U32)misses);
+            CHECK((nbTables==2) && ((hits!=3) || (misses!=2)), "FSE decoding table cache : wrong stats (%u hits, %u misses)", (U32)hits, (U32)misses);
+            FSE_freeDCtx(dctx);
+        }
+    }
+
+    /* FSE_estimateCompressedSize */
+    {
+        U32 n;
+        for (n=0; n<50; n++) {
+            U32 ct[FSE_CTABLE_SIZE_U32(FSE_MAX_TABLELOG, 255)];
+            short norm[256];
+            U32 max = 255;
+            size_t const testSize = 100 + (FUZ_rand(&lseed) % (TBSIZE-100));
+            double const p = (double)((FUZ_rand(&lseed) % 90) + 5) / 100;
+            unsigned tableLog;
+            size_t cSize, eSize;
+            generate(testBuff, testSize, p, &lseed);
+            errorCode = FSE_count(count, &max, testBuff, testSize);
+            CHECK(FSE_isError(errorCode), "FSE_count() should have worked");
+            if (errorCode == testSize) continue;   /* rle */
+            tableLog = FSE_optimalTableLog(0, testSize, max);
+            errorCode = FSE_normalizeCount(norm, tableLog, count, testSize, max);
+            CHECK(FSE_isError(errorCode), "FSE_normalizeCount() should have worked");
+            errorCode = FSE_buildCTable(ct, norm, max, tableLog);
+            CHECK(FSE_isError(errorCode), "FSE_buildCTable() should have worked");
+            cSize = FSE_compress_usingCTable(cBuff, FSE_COMPRESSBOUND(TBSIZE), testBuff, testSize, ct);
+            CHECK(FSE_isError(cSize) || (cSize==0), "FSE_compress_usingCTable() should have worked");
+            eSize = FSE_estimateCompressedSize(norm, count, max, tableLog);
+            CHECK(FSE_isError(eSize), "FSE_estimateCompressedSize() should have worked");
+            CHECK((eSize > cSize + cSize/100 + 8) || (eSize + cSize/100 + 8 < cSize),
+                  "FSE_estimateCompressedSize() : estimation %u too far from %u", (U32)eSize, (U32)cSize);
+            norm[testBuff[0]] = 0;
+            errorCode = FSE_estimateCompressedSize(norm, count, max, tableLog);
+            CHECK(!FSE_isError(errorCode), "FSE_estimateCompressedSize() should have failed (symbol without probability)");
+        }
+    }
+
+    /* FSE_findBlockSplit */
+    {
+        U32 fast;
+        for (fast=0; fast<2; fast++) {
+            size_t const chunkSize = fast ? 4 KB : 1 KB;
+            size_t splitPos;
+            generate(testBuff, TBSIZE, 0.2, &lseed);
+            splitPos = FSE_findBlockSplit(testBuff, TBSIZE, 0, fast);
+            CHECK(splitPos != TBSIZE, "FSE_findBlockSplit() : homogeneous input should not be split (%u)", (U32)splitPos);
+            generateNoise(testBuff + TBSIZE/2, TBSIZE/2, &lseed);
+            splitPos = FSE_findBlockSplit(testBuff, TBSIZE, 0, fast);
+            CHECK((splitPos + chunkSize < TBSIZE/2) || (splitPos > TBSIZE/2 + chunkSize),
+                  "FSE_findBlockSplit() : split at %u instead of %u", (U32)splitPos, (U32)(TBSIZE/2));
+            splitPos = FSE_findBlockSplit(testBuff, chunkSize + 1, 0, fast);
+            CHECK(splitPos != chunkSize + 1, "FSE_findBlockSplit() : input too small to be split");
+        }
+    }
+
     /* known corner case */
     {
         BYTE sample8[8] = { 0, 0, 0, 2, 0, 0, 0, 0 };
@@ -41,6 +41,7 @@ You can contact the author at :
 #include "mem.h"
 #define HUF_STATIC_LINKING_ONLY
 #include "huf.h"
+#include "fse.h"      /* FSE_count */
 #include "xxhash.h"
 
 
@@ -144,6 +145,23 @@ static void findDifferentByte(const void* buf1, size_t buf1Size,
 #define CHECK(cond, ...) if (cond) { DISPLAY("Error => "); DISPLAY(__VA_ARGS__); \
                          DISPLAY(" (seed %u, test nb %u)  \n", seed, testNb); exit(-1); }
 
+/* decodes a block made of a Huffman table followed by 1 or 4 streams, using *_withPadding() variants.
+ * `dst` must be writable up to `dstSize + HUF_DECODE_PADDING` */
+static size_t FUZ_decompressWithPadding (void* dst, size_t dstSize, const void* cSrc, size_t cSrcSize,
+                                         unsigned singleStream, unsigned tableType)
+{
+    HUF_CREATE_STATIC_DTABLEX6(dt, HUF_TABLELOG_MAX);   /* large enough for all table types */
+    size_t const hSize = (tableType==2) ? HUF_readDTableX6(dt, cSrc, cSrcSize) :
+                         (tableType==1) ? HUF_readDTableX4(dt, cSrc, cSrcSize) :
+                                          HUF_readDTableX2(dt, cSrc, cSrcSize);
+    if (HUF_isError(hSize)) return hSize;
+    {   const BYTE* const ip = (const BYTE*)cSrc + hSize;
+        size_t const ipSize = cSrcSize - hSize;   /* readDTable never reads beyond cSrcSize */
+        if (singleStream) return HUF_decompress1X_usingDTable_withPadding(dst, dstSize, ip, ipSize, dt);
+        return HUF_decompress4X_usingDTable_withPadding(dst, dstSize, ip, ipSize, dt);
+    }
+}
+
 static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
 {
     BYTE* bufferP0    = (BYTE*) malloc (BUFFERSIZE+64);
@@ -153,6 +171,7 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
     BYTE* bufferP100  = (BYTE*) malloc (BUFFERSIZE+64);
     BYTE* bufferDst   = (BYTE*) malloc (BUFFERSIZE+64);
     BYTE* bufferVerif = (BYTE*) malloc (BUFFERSIZE+64);
+    HUF_CCtx* const cctx = HUF_createCCtx();
     size_t const bufferDstSize = BUFFERSIZE+64;
     unsigned testNb;
     size_t const maxTestSizeMask = 0x1FFFF;   /* 128 KB - 1 */
@@ -203,6 +222,14 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
             /* compression test */
             sizeCompressed = HUF_compress (bufferDst, bufferDstSize, bufferTest, sizeOrig);
             CHECK(HUF_isError(sizeCompressed), "HUF_compress failed");
+
+            /* context compression must generate same data */
+            {   size_t const cctxSize = HUF_compress4X_CCtx (cctx, bufferVerif, bufferDstSize, bufferTest, sizeOrig, 255, HUF_TABLELOG_DEFAULT);
+                CHECK(cctx==NULL, "not enough memory !");
+                CHECK(cctxSize != sizeCompressed, "HUF_compress4X_CCtx : wrong compressed size (%u != %u)", (U32)cctxSize, (U32)sizeCompressed);
+                CHECK(memcmp(bufferVerif, bufferDst, sizeCompressed), "HUF_compress4X_CCtx : different compressed data");
+            }
+
             if (sizeCompressed > 1) {   /* don't check uncompressed & rle corner cases */
                 /* failed compression test */
                 {   BYTE const saved = bufferVerif[sizeCompressed-1] = 253;
@@ -221,9 +248,16 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
                         CHECK(hashEnd != hashOrig, "HUF_decompress : Decompressed data corrupted");
                 }   }
 
-                /* quad decoder test (more fragile) */
-                /*
-                if (sizeOrig > 64)
+                /* padded decompression test */
+                {   BYTE const saved = bufferVerif[sizeOrig + HUF_DECODE_PADDING] = 252;
+                    size_t const result = FUZ_decompressWithPadding (bufferVerif, sizeOrig, bufferDst, sizeCompressed, 0, testNb % 3);
+                    CHECK(bufferVerif[sizeOrig + HUF_DECODE_PADDING] != saved, "padded decompression : write beyond padding");
+                    CHECK(result != sizeOrig, "padded decompression failed : %s", HUF_getErrorName(result));
+                    {   U32 const hashEnd = XXH32 (bufferVerif, sizeOrig, 0);
+                        CHECK(hashEnd != hashOrig, "padded decompression : Decompressed data corrupted");
+                }   }
+
+                /* quad decoder test */
                 {   BYTE const saved = bufferVerif[sizeOrig] = 253;
                     size_t const result = HUF_decompress4X6 (bufferVerif, sizeOrig, bufferDst, sizeCompressed);
                     CHECK(bufferVerif[sizeOrig] != saved, "HUF_decompress4X6 : bufferVerif overflow");
@@ -232,7 +266,6 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
                         if (hashEnd!=hashOrig) findDifferentByte(bufferVerif, sizeOrig, bufferTest, sizeOrig);
                         CHECK(hashEnd != hashOrig, "HUF_decompress4X6 : Decompressed data corrupted");
                 }   }
-                */
 
                 /* truncated src decompression test */
                 if (sizeCompressed>4) {
@@ -245,7 +278,41 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
                     { size_t const errorCode = HUF_decompress(bufferVerif, sizeOrig, cBufferTooSmall, tooSmallSize);
                       CHECK(!HUF_isError(errorCode) && (errorCode!=sizeOrig), "HUF_decompress should have failed ! (truncated src buffer)"); }
                     free(cBufferTooSmall);
-            }   }
+                }
+
+                /* single stream padded round trip */
+                {   size_t const cSize1X = HUF_compress1X (bufferDst, bufferDstSize, bufferTest, sizeOrig, 255, HUF_TABLELOG_DEFAULT);
+                    CHECK(HUF_isError(cSize1X), "HUF_compress1X failed");
+                    if (cSize1X > 1) {
+                        BYTE const saved = bufferVerif[sizeOrig + HUF_DECODE_PADDING] = 251;
+                        size_t const result = FUZ_decompressWithPadding (bufferVerif, sizeOrig, bufferDst, cSize1X, 1, testNb % 3);
+                        CHECK(bufferVerif[sizeOrig + HUF_DECODE_PADDING] != saved, "1X padded decompression : write beyond padding");
+                        CHECK(result != sizeOrig, "1X padded decompression failed : %s", HUF_getErrorName(result));
+                        {   U32 const hashEnd = XXH32 (bufferVerif, sizeOrig, 0);
+                            CHECK(hashEnd != hashOrig, "1X padded decompression : Decompressed data corrupted");
+                }   }   }
+
+                /* 8 streams round trip, recognized by 4-streams decoders */
+                {   size_t const cSize8X = HUF_compress8X (bufferDst, bufferDstSize, bufferTest, sizeOrig, 255, HUF_TABLELOG_DEFAULT);
+                    CHECK(HUF_isError(cSize8X), "HUF_compress8X failed");
+                    if (cSize8X > 1) {
+                        BYTE const saved = bufferVerif[sizeOrig + HUF_DECODE_PADDING] = 250;
+                        size_t const result = (testNb & 2) ?
+                                              FUZ_decompressWithPadding (bufferVerif, sizeOrig, bufferDst, cSize8X, 0, testNb % 3) :
+                                              HUF_decompress (bufferVerif, sizeOrig, bufferDst, cSize8X);
+                        CHECK(bufferVerif[sizeOrig + HUF_DECODE_PADDING] != saved, "8X decompression : write beyond padding");
+                        CHECK(result != sizeOrig, "8X decompression failed : %s", HUF_getErrorName(result));
+                        {   U32 const hashEnd = XXH32 (bufferVerif, sizeOrig, 0);
+                            CHECK(hashEnd != hashOrig, "8X decompression : Decompressed data corrupted");
+                        }
+                        /* corrupted 8X block must not overflow */
+                        bufferDst[FUZ_rand(&roundSeed) % cSize8X] ^= (BYTE)(FUZ_rand(&roundSeed) | 1);
+                        bufferVerif[sizeOrig] = 249;
+                        {   size_t const errorCode = HUF_decompress (bufferVerif, sizeOrig, bufferDst, cSize8X);
+                            CHECK(!HUF_isError(errorCode) && (errorCode!=sizeOrig), "8X corrupted decompression : wrong regenerated size");
+                            CHECK(bufferVerif[sizeOrig] != 249, "8X corrupted decompression : bufferVerif overflow");
+                }   }   }
+            }
         }   /* Compression / Decompression tests */
 
         /* Attempt decompression on bogus data */
@@ -257,6 +324,11 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
             result = HUF_decompress (bufferDst, maxDstSize, bufferTest, sizeCompressed);
             CHECK(!HUF_isError(result) && (result > maxDstSize), "Decompression overran output buffer");
             CHECK(bufferDst[maxDstSize] != saved, "HUF_decompress noise : bufferDst overflow");
+            {   BYTE const savedP = (bufferDst[maxDstSize + HUF_DECODE_PADDING] = 252);
+                result = FUZ_decompressWithPadding (bufferDst, maxDstSize, bufferTest, sizeCompressed, testNb & 4, testNb % 3);
+                CHECK(!HUF_isError(result) && (result != maxDstSize), "padded decompression of noise : wrong regenerated size");
+                CHECK(bufferDst[maxDstSize + HUF_DECODE_PADDING] != savedP, "padded decompression of noise : write beyond padding");
+            }
         }
     }   /* for (testNb=startTestNb; testNb<totalTest; testNb++) */
 
@@ -268,6 +340,7 @@ static void FUZ_tests (U32 seed, U32 totalTest, U32 startTestNb)
     free (bufferP100);
     free (bufferDst);
     free (bufferVerif);
+    HUF_freeCCtx(cctx);
 }
 
 
@@ -279,7 +352,7 @@ static void unitTest(void)
 {
     BYTE* testBuff = (BYTE*)malloc(TBSIZE);
     BYTE* cBuff = (BYTE*)malloc(HUF_COMPRESSBOUND(TBSIZE));
-    BYTE* verifBuff = (BYTE*)malloc(TBSIZE);
+    BYTE* verifBuff = (BYTE*)malloc(HUF_COMPRESSBOUND(TBSIZE));
 
     if ((!testBuff) || (!cBuff) || (!verifBuff)) {
         DISPLAY("Not enough memory, exiting ... \n");
@@ -297,6 +370,297 @@ static void unitTest(void)
     {
     }
 
+    /* Table repeat mode */
+    {
+        HUF_CCtx* const cctx = HUF_createCCtx();
+        HUF_CREATE_STATIC_DTABLEX4(dctx, HUF_TABLELOG_MAX);
+#       define REPEAT_BLOCKSIZE (TBSIZE/8)
+        size_t cSizes[TBSIZE/REPEAT_BLOCKSIZE];
+        size_t cPos = 0;
+        U32 seed = 0, testNb = 0, nbRepeats = 0, b;
+        CHECK(cctx==NULL, "not enough memory !");
+        for (b=0; b < TBSIZE; b++) testBuff[b] = (BYTE)((FUZ_rand(&seed) & 7) + (FUZ_rand(&seed) & 7));   /* same small alphabet in all blocks */
+        for (b=0; b < TBSIZE/REPEAT_BLOCKSIZE; b++) {
+            BYTE* const cBlock = cBuff + cPos;
+            cSizes[b] = HUF_compress4X_CCtx_repeat(cctx, cBlock, HUF_COMPRESSBOUND(TBSIZE) - cPos, testBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, 255, HUF_TABLELOG_DEFAULT);
+            CHECK(HUF_isError(cSizes[b]) || (cSizes[b] <= 1), "HUF_compress4X_CCtx_repeat should have compressed block %u", b);
+            nbRepeats += (cBlock[0] == HUF_REPEAT_HEADER);
+            cPos += cSizes[b];
+        }
+        CHECK(nbRepeats == 0, "HUF_compress4X_CCtx_repeat : similar blocks should re-use previous table");
+        CHECK(cBuff[0] == HUF_REPEAT_HEADER, "HUF_compress4X_CCtx_repeat : first block can't re-use a table");
+        for (cPos=0, b=0; b < TBSIZE/REPEAT_BLOCKSIZE; cPos += cSizes[b], b++) {
+            size_t const rSize = HUF_decompress4X_DCtx(dctx, verifBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, cBuff + cPos, cSizes[b]);
+            CHECK(rSize != REPEAT_BLOCKSIZE, "HUF_decompress4X_DCtx failed decoding block %u", b);
+        }
+        CHECK(memcmp(testBuff, verifBuff, TBSIZE), "HUF table repeat mode : regenerated data is corrupted");
+        for (cPos=cSizes[0], b=1; b < TBSIZE/REPEAT_BLOCKSIZE; cPos += cSizes[b], b++) {
+            if (cBuff[cPos] != HUF_REPEAT_HEADER) continue;
+            {   size_t const errorCode = HUF_decompress(verifBuff, REPEAT_BLOCKSIZE, cBuff + cPos, cSizes[b]);
+                CHECK(!HUF_isError(errorCode), "HUF_decompress should have failed (block re-uses previous table)"); }
+            break;
+        }
+        HUF_freeCCtx(cctx);
+    }
+
+    /* Caller-held table repeat mode */
+    {
+        U32* const workSpace = (U32*)malloc(HUF_WORKSPACE_PAIRS_SIZE);
+        HUF_CREATE_STATIC_CTABLE(hufTable, HUF_SYMBOLVALUE_MAX);
+        HUF_CREATE_STATIC_DTABLEX4(dctx, HUF_TABLELOG_MAX);
+        size_t cSizes[TBSIZE/REPEAT_BLOCKSIZE];
+        size_t cPos = 0;
+        U32 seed = 0, testNb = 0, nbRepeats = 0, b;
+        HUF_repeat repeat = HUF_repeat_none;
+        CHECK(workSpace==NULL, "not enough memory !");
+        memset(hufTable, 0, HUF_CTABLE_SIZE(HUF_SYMBOLVALUE_MAX));
+        for (b=0; b < TBSIZE; b++) testBuff[b] = (BYTE)((FUZ_rand(&seed) & 7) + (FUZ_rand(&seed) & 7));   /* same small alphabet in all blocks */
+
+        /* checked re-use : first block sends its table */
+        for (b=0; b < TBSIZE/REPEAT_BLOCKSIZE; b++) {
+            BYTE* const cBlock = cBuff + cPos;
+            cSizes[b] = HUF_compress4X_repeat(cBlock, HUF_COMPRESSBOUND(TBSIZE) - cPos, testBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, 255, HUF_TABLELOG_DEFAULT,
+                                              workSpace, HUF_WORKSPACE_PAIRS_SIZE, hufTable, &repeat, 0);
+            CHECK(HUF_isError(cSizes[b]) || (cSizes[b] <= 1), "HUF_compress4X_repeat should have compressed block %u", b);
+            CHECK(repeat != HUF_repeat_check, "HUF_compress4X_repeat : table should be saved after block %u", b);
+            nbRepeats += (cBlock[0] == HUF_REPEAT_HEADER);
+            cPos += cSizes[b];
+        }
+        CHECK(nbRepeats == 0, "HUF_compress4X_repeat : similar blocks should re-use previous table");
+        CHECK(cBuff[0] == HUF_REPEAT_HEADER, "HUF_compress4X_repeat : first block can't re-use a table");
+        for (cPos=0, b=0; b < TBSIZE/REPEAT_BLOCKSIZE; cPos += cSizes[b], b++) {
+            size_t const rSize = HUF_decompress4X_DCtx(dctx, verifBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, cBuff + cPos, cSizes[b]);
+            CHECK(rSize != REPEAT_BLOCKSIZE, "HUF_decompress4X_DCtx failed decoding block %u", b);
+        }
+        CHECK(memcmp(testBuff, verifBuff, TBSIZE), "HUF_compress4X_repeat : regenerated data is corrupted");
+
+        /* pre-built table, trusted : all blocks re-use it */
+        {   U32 count[256];
+            U32 max = 255;
+            size_t hSize, errorCode;
+            errorCode = FSE_count(count, &max, testBuff, TBSIZE);
+            CHECK(FSE_isError(errorCode), "FSE_count() should have worked");
+            memset(hufTable, 0, HUF_CTABLE_SIZE(HUF_SYMBOLVALUE_MAX));   /* symbols beyond max are absent */
+            errorCode = HUF_buildCTable(hufTable, count, max, HUF_TABLELOG_DEFAULT);
+            CHECK(HUF_isError(errorCode), "HUF_buildCTable() should have worked");
+            hSize = HUF_writeCTable(cBuff, HUF_COMPRESSBOUND(TBSIZE), hufTable, max, (U32)errorCode);
+            CHECK(HUF_isError(hSize), "HUF_writeCTable() should have worked");
+            errorCode = HUF_readDTableX4(dctx, cBuff, hSize);
+            CHECK(errorCode != hSize, "HUF_readDTableX4() should have read table header");
+        }
+        repeat = HUF_repeat_valid;
+        for (cPos=0, b=0; b < TBSIZE/REPEAT_BLOCKSIZE; b++) {
+            BYTE* const cBlock = cBuff + cPos;
+            cSizes[b] = HUF_compress4X_repeat(cBlock, HUF_COMPRESSBOUND(TBSIZE) - cPos, testBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, 255, HUF_TABLELOG_DEFAULT,
+                                              workSpace, HUF_WORKSPACE_PAIRS_SIZE, hufTable, &repeat, 1);
+            CHECK(HUF_isError(cSizes[b]) || (cSizes[b] <= 1), "HUF_compress4X_repeat should have compressed block %u", b);
+            CHECK(cBlock[0] != HUF_REPEAT_HEADER, "HUF_compress4X_repeat : trusted table should be re-used by block %u", b);
+            CHECK(repeat != HUF_repeat_valid, "HUF_compress4X_repeat : re-used table should remain valid");
+            cPos += cSizes[b];
+        }
+        for (cPos=0, b=0; b < TBSIZE/REPEAT_BLOCKSIZE; cPos += cSizes[b], b++) {
+            size_t const rSize = HUF_decompress4X_DCtx(dctx, verifBuff + b*REPEAT_BLOCKSIZE, REPEAT_BLOCKSIZE, cBuff + cPos, cSizes[b]);
+            CHECK(rSize != REPEAT_BLOCKSIZE, "HUF_decompress4X_DCtx failed decoding block %u", b);
+        }
+        CHECK(memcmp(testBuff, verifBuff, TBSIZE), "HUF_compress4X_repeat : regenerated data is corrupted (pre-built table)");
+
+        /* pre-built table, checked : a symbol beyond its maxSymbolValue forces a new table */
+        repeat = HUF_repeat_check;
+        testBuff[REPEAT_BLOCKSIZE/2] = 200;
+        cSizes[0] = HUF_compress4X_repeat(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, REPEAT_BLOCKSIZE, 255, HUF_TABLELOG_DEFAULT,
+                                          workSpace, HUF_WORKSPACE_PAIRS_SIZE, hufTable, &repeat, 0);
+        CHECK(HUF_isError(cSizes[0]) || (cSizes[0] <= 1), "HUF_compress4X_repeat should have compressed block");
+        CHECK(cBuff[0] == HUF_REPEAT_HEADER, "HUF_compress4X_repeat : table can't represent symbol 200, it must not be re-used");
+        {   size_t const rSize = HUF_decompress4X_DCtx(dctx, verifBuff, REPEAT_BLOCKSIZE, cBuff, cSizes[0]);
+            CHECK(rSize != REPEAT_BLOCKSIZE, "HUF_decompress4X_DCtx failed decoding block with new symbol");
+            CHECK(memcmp(testBuff, verifBuff, REPEAT_BLOCKSIZE), "HUF_compress4X_repeat : regenerated data is corrupted (new symbol)");
+        }
+        free(workSpace);
+    }
+
+    /* Decoding table cache */
+    {
+        size_t const blockSize = TBSIZE/2;
+        BYTE* const cBlock2 = cBuff + HUF_COMPRESSBOUND(blockSize);
+        size_t cSize1, cSize2;
+        U32 seed = 2, testNb = 0, nbTables;
+        generate(testBuff, blockSize, 0.2, &seed);
+        generate(testBuff + blockSize, blockSize, 0.6, &seed);
+        cSize1 = HUF_compress(cBuff, HUF_COMPRESSBOUND(blockSize), testBuff, blockSize);
+        cSize2 = HUF_compress(cBlock2, HUF_COMPRESSBOUND(blockSize), testBuff + blockSize, blockSize);
+        CHECK(HUF_isError(cSize1) || HUF_isError(cSize2) || (cSize1<=1) || (cSize2<=1), "HUF_compress() should have compressed both blocks");
+        for (nbTables=1; nbTables<=2; nbTables++) {
+            HUF_DTableCache* const cache = HUF_createDTableCache(nbTables);
+            unsigned long long hits, misses;
+            U32 b;
+            CHECK(cache==NULL, "not enough memory !");
+            for (b=0; b<5; b++) {   /* alternate both headers */
+                size_t const rSize = (b&1) ? HUF_decompress4X_usingDTableCache(cache, verifBuff + blockSize, blockSize, cBlock2, cSize2)
+                                           : HUF_decompress4X_usingDTableCache(cache, verifBuff, blockSize, cBuff, cSize1);
+                CHECK(rSize != blockSize, "HUF_decompress4X_usingDTableCache() failed decoding block %u", b);
+            }
+            CHECK(memcmp(testBuff, verifBuff, TBSIZE), "HUF decoding table cache : regenerated data is corrupted");
+            HUF_getDTableCacheStats(cache, &hits, &misses);
+            CHECK((nbTables==1) && ((hits!=0) || (misses!=5)), "HUF decoding table cache : wrong stats (%u hits, %u misses)", (U32)hits, (U32)misses);
+            CHECK((nbTables==2) && ((hits!=3) || (misses!=2)), "HUF decoding table cache : wrong stats (%u hits, %u misses)", (U32)hits, (U32)misses);
+            HUF_freeDTableCache(cache);
+        }
+    }
+
+    /* Large blocks */
+    {
+        size_t const largeSize = 3 MB + 7;
+        BYTE* const largeBuff = (BYTE*)malloc(largeSize);
+        BYTE* const largeCBuff = (BYTE*)malloc(HUF_COMPRESSBOUND(largeSize));
+        BYTE* const largeVerif = (BYTE*)malloc(largeSize + HUF_DECODE_PADDING);
+        U32 seed = 3, testNb = 0;
+        size_t cSize, rSize;
+        CHECK(!largeBuff || !largeCBuff || !largeVerif, "not enough memory !");
+        generate(largeBuff, largeSize, 0.3, &seed);
+        cSize = HUF_compress2(largeCBuff, HUF_COMPRESSBOUND(largeSize), largeBuff, largeSize, 255, HUF_TABLELOG_DEFAULT);
+        CHECK(!HUF_isError(cSize), "HUF_compress2() should have refused a block > HUF_BLOCKSIZE_MAX");
+        cSize = HUF_compress4X_large(largeCBuff, HUF_COMPRESSBOUND(largeSize), largeBuff, largeSize, 255, HUF_TABLELOG_DEFAULT);
+        CHECK(HUF_isError(cSize) || (cSize<=1), "HUF_compress4X_large() should have worked");
+        rSize = HUF_decompress(largeVerif, largeSize, largeCBuff, cSize);
+        CHECK(rSize != largeSize, "HUF_decompress() of large block failed : %s", HUF_getErrorName(rSize));
+        CHECK(memcmp(largeBuff, largeVerif, largeSize), "HUF large block : regenerated data is corrupted");
+        rSize = FUZ_decompressWithPadding(largeVerif, largeSize, largeCBuff, cSize, 0, 1);
+        CHECK(rSize != largeSize, "padded decompression of large block failed : %s", HUF_getErrorName(rSize));
+        CHECK(memcmp(largeBuff, largeVerif, largeSize), "HUF large block : padded regenerated data is corrupted");
+        rSize = HUF_decompress4X6(largeVerif, largeSize, largeCBuff, cSize);
+        CHECK(rSize != largeSize, "HUF_decompress4X6() of large block failed : %s", HUF_getErrorName(rSize));
+        CHECK(memcmp(largeBuff, largeVerif, largeSize), "HUF large block : quad-symbols regenerated data is corrupted");
+        free(largeBuff);
+        free(largeCBuff);
+        free(largeVerif);
+    }
+
+    /* Decoder profile */
+    {
+        BYTE builtIn[HUF_DECODER_PROFILE_SIZE];
+        BYTE profile[HUF_DECODER_PROFILE_SIZE];
+        U32 seed = 4, testNb = 0, q;
+        size_t errorCode = HUF_saveDecoderProfile(builtIn, sizeof(builtIn));
+        CHECK(errorCode != HUF_DECODER_PROFILE_SIZE, "HUF_saveDecoderProfile() failed : %s", HUF_getErrorName(errorCode));
+        CHECK(!HUF_isError(HUF_saveDecoderProfile(profile, sizeof(profile)-1)), "HUF_saveDecoderProfile() should have failed (dst too small)");
+        memcpy(profile, builtIn, sizeof(profile));
+        for (q=0; q<16; q++) MEM_writeLE32(profile + 4 + q*24 + 4, 1<<30);   /* X2 made very slow : X4 must be selected */
+        CHECK(!HUF_isError(HUF_loadDecoderProfile(profile, sizeof(profile)-1)), "HUF_loadDecoderProfile() should have failed (wrong size)");
+        profile[0]++;
+        CHECK(!HUF_isError(HUF_loadDecoderProfile(profile, sizeof(profile))), "HUF_loadDecoderProfile() should have failed (wrong magic)");
+        profile[0]--;
+        errorCode = HUF_loadDecoderProfile(profile, sizeof(profile));
+        CHECK(HUF_isError(errorCode), "HUF_loadDecoderProfile() failed : %s", HUF_getErrorName(errorCode));
+        CHECK(HUF_selectDecoder(64 KB, 32 KB) != 1, "HUF_selectDecoder() should follow loaded profile");
+        errorCode = HUF_calibrateDecoders();
+        CHECK(HUF_isError(errorCode), "HUF_calibrateDecoders() failed : %s", HUF_getErrorName(errorCode));
+        errorCode = HUF_saveDecoderProfile(profile, sizeof(profile));
+        CHECK(errorCode != HUF_DECODER_PROFILE_SIZE, "HUF_saveDecoderProfile() failed : %s", HUF_getErrorName(errorCode));
+        errorCode = HUF_loadDecoderProfile(profile, sizeof(profile));
+        CHECK(HUF_isError(errorCode), "HUF_loadDecoderProfile() should accept a calibrated profile : %s", HUF_getErrorName(errorCode));
+        generate(testBuff, TBSIZE, 0.3, &seed);
+        errorCode = HUF_compress(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, TBSIZE);
+        CHECK(HUF_isError(errorCode) || (errorCode<=1), "HUF_compress() should have worked");
+        errorCode = HUF_decompress(verifBuff, TBSIZE, cBuff, errorCode);
+        CHECK(errorCode != TBSIZE, "HUF_decompress() failed with calibrated profile : %s", HUF_getErrorName(errorCode));
+        CHECK(memcmp(testBuff, verifBuff, TBSIZE), "HUF calibrated profile : regenerated data is corrupted");
+        HUF_resetDecoderProfile();
+        HUF_saveDecoderProfile(profile, sizeof(profile));
+        CHECK(memcmp(builtIn, profile, sizeof(profile)), "HUF_resetDecoderProfile() should restore built-in metrics");
+    }
+
+    /* HUF_estimateCompressedSize */
+    {
+        U32 seed = 1, testNb = 0, n;
+        for (n=0; n<50; n++) {
+            HUF_CREATE_STATIC_CTABLE(ct, 255);
+            U32 count[256];
+            U32 max = 255;
+            size_t const testSize = 100 + (FUZ_rand(&seed) % (TBSIZE-100));
+            double const p = (double)((FUZ_rand(&seed) % 90) + 5) / 100;
+            size_t errorCode, cSize, eSize;
+            generate(testBuff, testSize, p, &seed);
+            errorCode = FSE_count(count, &max, testBuff, testSize);
+            CHECK(FSE_isError(errorCode), "FSE_count() should have worked");
+            if (errorCode == testSize) continue;   /* rle */
+            errorCode = HUF_buildCTable(ct, count, max, HUF_TABLELOG_DEFAULT);
+            CHECK(HUF_isError(errorCode), "HUF_buildCTable() should have worked");
+            cSize = HUF_compress1X_usingCTable(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, testSize, ct);
+            CHECK(HUF_isError(cSize) || (cSize==0), "HUF_compress1X_usingCTable() should have worked");
+            eSize = HUF_estimateCompressedSize(ct, count, max);
+            CHECK(eSize != cSize, "HUF_estimateCompressedSize() : estimation %u different from %u", (U32)eSize, (U32)cSize);
+            cSize = HUF_compress4X_usingCTable(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, testSize, ct);
+            CHECK(HUF_isError(cSize) || (cSize==0), "HUF_compress4X_usingCTable() should have worked");
+            CHECK((cSize < eSize+6) || (cSize > eSize+9), "HUF_estimateCompressedSize() : 4-streams size %u out of bounds (%u)", (U32)cSize, (U32)eSize);
+            if (cSize+16 < testSize) {   /* tight budget : streams encoded one after another, same output expected */
+                size_t const sSize = HUF_compress4X_usingCTable(verifBuff, cSize+16, testBuff, testSize, ct);
+                CHECK(sSize != cSize, "HUF_compress4X_usingCTable() : tight budget size %u different from %u", (U32)sSize, (U32)cSize);
+                CHECK(memcmp(verifBuff, cBuff, cSize), "HUF_compress4X_usingCTable() : interleaved and serial outputs differ");
+            }
+        }
+    }
+
+    /* symbol pairs encoding */
+    {
+        U32* const pairTable = (U32*)malloc(HUF_PAIRTABLE_SIZE_U32 * sizeof(U32));
+        U32 seed = 1, testNb = 0, n;
+        for (n=0; n<20; n++) {
+            HUF_CREATE_STATIC_CTABLE(ct, 255);
+            U32 count[256];
+            U32 max = 255;
+            size_t const testSize = 100 + (FUZ_rand(&seed) % (TBSIZE-100));
+            double const p = (double)((FUZ_rand(&seed) % 90) + 5) / 100;
+            size_t errorCode, cSize, pSize;
+            generate(testBuff, testSize, p, &seed);
+            errorCode = FSE_count(count, &max, testBuff, testSize);
+            CHECK(FSE_isError(errorCode), "FSE_count() should have worked");
+            if (errorCode == testSize) continue;   /* rle */
+            errorCode = HUF_buildCTable(ct, count, max, HUF_TABLELOG_DEFAULT);
+            CHECK(HUF_isError(errorCode), "HUF_buildCTable() should have worked");
+            errorCode = HUF_buildPairTable(pairTable, ct, max);
+            CHECK(HUF_isError(errorCode), "HUF_buildPairTable() should have worked");
+            cSize = HUF_compress1X_usingCTable(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, testSize, ct);
+            pSize = HUF_compress1X_usingPairTable(verifBuff, TBSIZE, testBuff, testSize, ct, pairTable);
+            CHECK((pSize != cSize) || memcmp(verifBuff, cBuff, cSize), "HUF_compress1X_usingPairTable() : output differs");
+            cSize = HUF_compress4X_usingCTable(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, testSize, ct);
+            pSize = HUF_compress4X_usingPairTable(verifBuff, TBSIZE, testBuff, testSize, ct, pairTable);
+            CHECK((pSize != cSize) || memcmp(verifBuff, cBuff, cSize), "HUF_compress4X_usingPairTable() : output differs");
+        }
+        free(pairTable);
+    }
+
+    /* skewed last segment : 4th stream is much larger than the first 3 ones */
+    {
+        U32* const pairTable = (U32*)malloc(HUF_PAIRTABLE_SIZE_U32 * sizeof(U32));
+        HUF_CREATE_STATIC_CTABLE(ct, 255);
+        U32 count[256];
+        U32 max = 255;
+        U32 seed = 1, testNb = 0;
+        size_t const lastStart = TBSIZE - TBSIZE/4;
+        size_t errorCode, cSize, sSize, pSize, i;
+        memset(testBuff, 'a', lastStart);
+        generateNoise(testBuff + lastStart, TBSIZE - lastStart, &seed);
+        for (i=lastStart; i<TBSIZE; i++) if (testBuff[i]=='a') testBuff[i] = 'b';   /* rare symbols only */
+        errorCode = FSE_count(count, &max, testBuff, TBSIZE);
+        CHECK(FSE_isError(errorCode), "FSE_count() should have worked");
+        errorCode = HUF_buildCTable(ct, count, max, HUF_TABLELOG_DEFAULT);
+        CHECK(HUF_isError(errorCode), "HUF_buildCTable() should have worked");
+        errorCode = HUF_buildPairTable(pairTable, ct, max);
+        CHECK(HUF_isError(errorCode), "HUF_buildPairTable() should have worked");
+        cSize = HUF_compress4X_usingCTable(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, TBSIZE, ct);
+        CHECK(HUF_isError(cSize) || (cSize==0), "HUF_compress4X_usingCTable() should have worked on skewed input");
+        sSize = HUF_compress4X_usingCTable(verifBuff, cSize+16, testBuff, TBSIZE, ct);   /* serial */
+        CHECK((sSize != cSize) || memcmp(verifBuff, cBuff, cSize), "HUF_compress4X_usingCTable() : skewed input, interleaved and serial outputs differ");
+        pSize = HUF_compress4X_usingPairTable(verifBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, TBSIZE, ct, pairTable);
+        CHECK((pSize != cSize) || memcmp(verifBuff, cBuff, cSize), "HUF_compress4X_usingPairTable() : skewed input, output differs");
+        cSize = HUF_compress(cBuff, HUF_COMPRESSBOUND(TBSIZE), testBuff, TBSIZE);
+        CHECK(HUF_isError(cSize) || (cSize<=1), "HUF_compress() should have worked on skewed input");
+        errorCode = HUF_decompress(verifBuff, TBSIZE, cBuff, cSize);
+        CHECK(errorCode != TBSIZE, "HUF_decompress() failed on skewed input : %s", HUF_getErrorName(errorCode));
+        CHECK(memcmp(testBuff, verifBuff, TBSIZE), "HUF skewed input : regenerated data is corrupted");
+        free(pairTable);
+    }
+
     free(testBuff);
     free(cBuff);
     free(verifBuff);